@@ -6,6 +6,8 @@
 #include <cassert>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <cmath>
 #include "Utils.h"
 #include <PANDUVector2.h>
 #include <PANDUQuaternion.h>
@@ -39,8 +41,11 @@ const char* shaderSource = R"(
         invModelMatrix  : mat4x4<f32>,
         normalMatrix    : mat4x4<f32>,
         color           : vec4<f32>,
+        positionScale   : vec4<f32>,
+        positionOffset  : vec4<f32>,
     };
 
+    // Matrices arrive as the transpose of the CPU ones, see Utils::GetWebGPUMatrix, vectors multiply from the left
     @group(0) @binding(0) var<uniform> constUniforms : ConstantUniforms;
     @group(0) @binding(1) var<uniform> dynUniforms   : DynamicUniforms;
 
@@ -52,25 +57,51 @@ const char* shaderSource = R"(
         @location(3) uv: vec2f,
     };
 
+    // Compact vertex format, see VertexLayout::CreateCompact
+    struct CompactVertexInput {
+        @location(0) position: vec4f,   // snorm16x4 within the mesh bounds
+        @location(1) normal: vec2f,     // snorm16x2 octahedral
+        @location(3) uv: vec2f,         // float16x2
+    };
+
     struct VertexOutput {
         @builtin(position) position: vec4f,
         @location(0) normal: vec3f,
         @location(1) color: vec3f,
     };
 
-    @vertex
-    fn vs_main(in: VertexInput) -> VertexOutput {
-        
+    fn transformVertex(position: vec3f, normal: vec3f, color: vec3f) -> VertexOutput {
+
         var out: VertexOutput; // create the output struct
 
-        out.position = constUniforms.projectionMatrix * constUniforms.viewMatrix * dynUniforms.modelMatrix * vec4f(in.position, 1.0);
-        out.color = in.color * dynUniforms.color.rgb;
+        out.position = vec4f(position, 1.0) * dynUniforms.modelMatrix * constUniforms.viewMatrix * constUniforms.projectionMatrix;
+        out.color = color * dynUniforms.color.rgb;
 
-        out.normal = normalize((dynUniforms.normalMatrix * vec4f(in.normal, 0.0)).xyz);
+        // The normal matrix holds the inverse model matrix, arriving transposed is what makes it the normal matrix
+        out.normal = normalize((dynUniforms.normalMatrix * vec4f(normal, 0.0)).xyz);
 
         return out;
     }
 
+    fn decodeOctahedral(e: vec2f) -> vec3f {
+        var n = vec3f(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+        let t = max(-n.z, 0.0);
+        n.x += select(t, -t, n.x >= 0.0);
+        n.y += select(t, -t, n.y >= 0.0);
+        return normalize(n);
+    }
+
+    @vertex
+    fn vs_main(in: VertexInput) -> VertexOutput {
+        return transformVertex(in.position, in.normal, in.color);
+    }
+
+    @vertex
+    fn vs_main_compact(in: CompactVertexInput) -> VertexOutput {
+        let position = in.position.xyz * dynUniforms.positionScale.xyz + dynUniforms.positionOffset.xyz;
+        return transformVertex(position, decodeOctahedral(in.normal), vec3f(1.0));
+    }
+
     @fragment
     fn fs_main(in: VertexOutput) -> @location(0) vec4f {
         
@@ -111,6 +142,8 @@ struct alignas(16) DynamicUniforms
     std::array<float, 16> invModelMatrix;
     std::array<float, 16> normalMatrix;
     std::array<float, 4> color;
+    std::array<float, 4> positionScale;
+    std::array<float, 4> positionOffset;
 };
 
 
@@ -143,7 +176,7 @@ std::vector<float> vertexData = {
 +0.0f, +0.0f, +0.5f, -0.848f, 0.0f, 0.53f,    1.0f, 1.0f, 1.0f,    1.0f, 1.0f
 };
 
-std::vector<uint32_t> indexData = {
+std::vector<uint16_t> indexData = {
  0,  1,  2,
  0,  2,  3,
 
@@ -160,15 +193,54 @@ const uint32_t maxDrawCallsPerFrameSupported = 1024;
 
 namespace
 {
+    WGPUVertexFormat GetWebGPUVertexFormat(VertexLayout::Format Format)
+    {
+        switch (Format)
+        {
+        case VertexLayout::Format::Float32x2: return WGPUVertexFormat_Float32x2;
+        case VertexLayout::Format::Float32x3: return WGPUVertexFormat_Float32x3;
+        case VertexLayout::Format::Float32x4: return WGPUVertexFormat_Float32x4;
+        case VertexLayout::Format::Snorm16x2: return WGPUVertexFormat_Snorm16x2;
+        case VertexLayout::Format::Snorm16x4: return WGPUVertexFormat_Snorm16x4;
+        case VertexLayout::Format::Float16x2: return WGPUVertexFormat_Float16x2;
+        case VertexLayout::Format::Float16x4: return WGPUVertexFormat_Float16x4;
+        }
+        return WGPUVertexFormat_Float32x3;
+    }
+
+    void GetWebGPUVertexAttributes(const VertexLayout& Layout, std::vector<WGPUVertexAttribute>& OutAttributes)
+    {
+        OutAttributes.resize(Layout.GetAttributeCount());
+        for (uint32_t i = 0; i < Layout.GetAttributeCount(); i++)
+        {
+            const VertexLayout::Attribute& Attribute = Layout.GetAttribute(i);
+            OutAttributes[i] = {};
+            OutAttributes[i].format = GetWebGPUVertexFormat(Attribute.AttributeFormat);
+            OutAttributes[i].offset = Attribute.Offset;
+            OutAttributes[i].shaderLocation = Attribute.ShaderLocation;
+        }
+    }
+
+    // Object and camera transforms are rigid or affine nearly always, both invert without the general 4x4 inverse
+    Pandu::Matrix44 GetTransformInverse(const Pandu::Matrix44& Transform)
+    {
+        if (Transform.IsRigid())
+            return Transform.GetRigidInverse();
+
+        if (Transform.IsAffine())
+            return Transform.GetAffineInverse();
+
+        return Transform.GetInverse();
+    }
+
     void FillConstantUniform(ConstantUniforms& OutUniform, const Pandu::Matrix44& Projection, const Pandu::Matrix44& View
         , const Pandu::Vector4& ambientLightColor, const Pandu::Vector3& light1Direction, const Pandu::Vector4& light1Color
         , float TotalTime, float DeltaTime)
     {
-        Pandu::Matrix44 InvProjection = Projection.GetInverse(), InvView = View.GetInverse();
+        Pandu::Matrix44 InvProjection = Projection.GetInverse(), InvView = GetTransformInverse(View);
 
-        // WGSL expects matrices to be column - major by default.
-        // Pandu::Matrix44 is stored row - major(most C++ math libs are), we need to transpose before uploading.
-        // Otherwise, the matrix math will be wrong even if the order is fixed.
+        // Pandu::Matrix44 is row major and WGSL column major, the matrices go up untransposed and the shader
+        // multiplies from the left instead, see Utils::GetWebGPUMatrix
 
         Utils::GetWebGPUMatrix(OutUniform.projectionMatrix, Projection);
         Utils::GetWebGPUMatrix(OutUniform.viewMatrix, View);
@@ -185,21 +257,24 @@ namespace
         OutUniform.deltaTime = DeltaTime;
     }
 
-    void FillDynamicUniform(DynamicUniforms& OutUniform, const Pandu::Matrix44& Model, const Pandu::Vector4& Color)
+    void FillDynamicUniform(DynamicUniforms& OutUniform, const Pandu::Matrix44& Model, const Pandu::Matrix44& InvModel, const Pandu::Vector4& Color
+        , const Pandu::Vector4& PositionScale, const Pandu::Vector4& PositionOffset)
     {
-        const Pandu::Matrix44 InvModel = Model.GetInverse();
-        Pandu::Matrix44 NormalMatrix = InvModel.GetTranspose();
-        
-                                                                                                                    NormalMatrix[0][3] = 0.0f;
-                                                                                                                    NormalMatrix[1][3] = 0.0f;
-                                                                                                                    NormalMatrix[2][3] = 0.0f;
-        NormalMatrix[3][0] = 0.0f;			NormalMatrix[3][1] = 0.0f;			NormalMatrix[3][2] = 0.0f;			NormalMatrix[3][3] = 1.0f;
-
         Utils::GetWebGPUMatrix(OutUniform.modelMatrix, Model);
         Utils::GetWebGPUMatrix(OutUniform.invModelMatrix, InvModel);
-        Utils::GetWebGPUMatrix(OutUniform.normalMatrix, NormalMatrix);
+
+        // The shader computes normalMatrix * normal and reads the inverse as its transpose, which is the normal matrix.
+        // Only the 3x3 part is kept.
+        Utils::GetWebGPUMatrix(OutUniform.normalMatrix, InvModel);
+        std::array<float, 16>& NormalMatrix = OutUniform.normalMatrix;
+                                                                                NormalMatrix[3] = 0.0f;
+                                                                                NormalMatrix[7] = 0.0f;
+                                                                                NormalMatrix[11] = 0.0f;
+        NormalMatrix[12] = 0.0f;        NormalMatrix[13] = 0.0f;        NormalMatrix[14] = 0.0f;        NormalMatrix[15] = 1.0f;
 
         std::copy(&Color.Data()[0], (&Color.Data()[0]) + 4, OutUniform.color.begin());
+        std::copy(&PositionScale.Data()[0], (&PositionScale.Data()[0]) + 4, OutUniform.positionScale.begin());
+        std::copy(&PositionOffset.Data()[0], (&PositionOffset.Data()[0]) + 4, OutUniform.positionOffset.begin());
     }
 
     uint32_t ceilToNextMultiple(uint32_t value, uint32_t step) 
@@ -400,7 +475,13 @@ Application::Application()
     , m_PipelineLayout(nullptr)
     , m_BindGroup(nullptr)
     , m_Pipeline(nullptr)
+    , m_CompactPipeline(nullptr)
     , m_ShaderModule(nullptr)
+    , m_VertexLayout(VertexLayout::CreateDefault())
+    , m_CompactVertexLayout(VertexLayout::CreateCompact())
+    , m_UseCompactVertices(true)
+    , m_FieldOfViewY(Utils::Radians(20.0f))
+    , m_LodPixelError(1.0f)
     , m_ConstantUniformBufferSize(0)
     , m_ConstantUniformBufferStride(0)
     , m_DynamicsUniformBufferSize(0)
@@ -408,6 +489,7 @@ Application::Application()
     , m_UniformBuffer(nullptr)
     , m_DepthTexture(nullptr)
     , m_DepthTextureView(nullptr)
+    , m_NextObjectId(0)
 {
 
 }
@@ -492,37 +574,35 @@ bool Application::Initialize()
         return false;
     }
 
-    uint32_t VertexBufferSize = 0;
-    WGPUBuffer Buffer1 = nullptr;
-    uint32_t IndexBufferSize = 0;
-    uint32_t IndicesCount = 0;
-    WGPUBuffer IndexBuffer = nullptr;
+    // Both pyramids draw the same buffers, the mesh releases them once the last one is gone
+    std::shared_ptr<RenderMesh> Pyramid = std::make_shared<RenderMesh>();
 
-    if (!CreateVertexBuffer(VertexBufferSize, Buffer1, vertexData))
+    if (!CreateVertexBuffer(Pyramid->VertexBufferSize, Pyramid->VertexBuffer, vertexData.data(), static_cast<uint32_t>(vertexData.size() * sizeof(float))))
     {
-        DestroyBuffer(Buffer1);
         return false;
     }
 
-    if (!CreateIndexBuffer(IndexBufferSize, IndicesCount, IndexBuffer, indexData))
+    if (!CreateIndexBuffer(Pyramid->IndexBufferSize, Pyramid->IndicesCount, Pyramid->IndexBuffer, indexData.data(), static_cast<uint32_t>(indexData.size()), WGPUIndexFormat_Uint16))
     {
-        DestroyBuffer(Buffer1);
-        DestroyBuffer(IndexBuffer);
         return false;
     }
 
+    ObjModelLoader::ModelData::Submesh PyramidSubmesh;
+    PyramidSubmesh.indexCount = static_cast<uint32_t>(indexData.size());
+    PyramidSubmesh.bounds = MeshBounds::Compute(vertexData.data(), VertexFloatComponentCount, vertexCount);
+
+    Pyramid->IndexFormat = WGPUIndexFormat_Uint16;
+    Pyramid->Bounds = PyramidSubmesh.bounds;
+    Pyramid->Submeshes.push_back(PyramidSubmesh);
+
     Pandu::Matrix44 Translate0 = Pandu::Matrix44::IDENTITY;
     Translate0.SetTranslate(Pandu::Vector3(-0.5f, -0.5f, -2.25f));
 
     Pandu::Matrix44 Translate1 = Pandu::Matrix44::IDENTITY;
     Translate1.SetTranslate(Pandu::Vector3(0.5f, 0.5f, -2.25f));
 
-    m_RenderObjects.push_back({ VertexBufferSize, Buffer1, IndexBufferSize, IndicesCount, IndexBuffer, Translate0});
-    m_RenderObjects.push_back({ VertexBufferSize, Buffer1, IndexBufferSize, IndicesCount, IndexBuffer, Translate1 });
-
-    ObjModelLoader Loader("assets/smooth_vase.obj");
-    std::future<std::unique_ptr<const ObjModelLoader::ModelData>> FutureModel = Loader.Load();
-    m_LoadingModels.push_back(std::move(FutureModel));
+    m_RenderObjects.push_back({ Pyramid, Translate0, m_NextObjectId++ });
+    m_RenderObjects.push_back({ Pyramid, Translate1, m_NextObjectId++ });
 
     m_CameraMatrix = Pandu::Matrix44::IDENTITY;
     //m_CameraMatrix.SetTranslate(Pandu::Vector3(0.0f, 40.0f, 800.5f));
@@ -534,6 +614,7 @@ bool Application::Initialize()
     m_ObjModelTransform = Pandu::Matrix44::IDENTITY;
     Quat.ToRotationMatrix(m_ObjModelTransform);
 
+    RequestModel("assets/smooth_vase.obj", m_ObjModelTransform);
 
     m_IsFullyInitialized = true;
     
@@ -544,11 +625,13 @@ void Application::Terminate()
 {
     m_IsFullyInitialized = false;
 
-    for (auto BuffData : m_RenderObjects)
+    // Loads nobody waits for are cancelled, shared meshes release their buffers with the last object using them
+    while (!m_PendingObjects.empty())
     {
-        DestroyBuffer(BuffData.VertexBuffer);
-        DestroyBuffer(BuffData.IndexBuffer);
+        RemoveModel(m_PendingObjects.begin()->second.Id);
     }
+    m_RenderObjects.clear();
+    m_MeshRegistry.Prune();
 
     DestroyBuffer(m_UniformBuffer);
 
@@ -580,6 +663,12 @@ void Application::Terminate()
         m_Pipeline = nullptr;
     }
 
+    if (m_CompactPipeline)
+    {
+        wgpuRenderPipelineRelease(m_CompactPipeline);
+        m_CompactPipeline = nullptr;
+    }
+
     if (m_Queue)
     {
 #ifdef __EMSCRIPTEN__
@@ -689,8 +778,9 @@ void Application::MainLoop()
 
     if (!targetView) return;
 
-    const Pandu::Matrix44 ProjectionMatrix = Utils::GetProjectionMatrix(Utils::Radians(20.0f), (float)m_ScreenWidth / (float)m_ScreenHeight, 0.01f, 100.0f);
-    const Pandu::Matrix44 ViewMatrix = m_CameraMatrix.GetInverse();
+    const Pandu::Matrix44 ProjectionMatrix = Utils::GetProjectionMatrix(m_FieldOfViewY, (float)m_ScreenWidth / (float)m_ScreenHeight, 0.01f, 100.0f);
+    // The camera only ever rotates and moves
+    const Pandu::Matrix44 ViewMatrix = m_CameraMatrix.GetRigidInverse();
     
 
 #ifndef WEBGPU_BACKEND_WGPU
@@ -763,9 +853,7 @@ void Application::MainLoop()
 
     WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
 
-    // Select which render pipeline to use
-    wgpuRenderPassEncoderSetPipeline(renderPass, m_Pipeline);
-
+    // Render pipelines are selected per object, see RenderRenderObject
     uint32_t ObjectIndex = 0;
     RenderRenderObject(ObjectIndex, renderPass);
  
@@ -1383,26 +1471,14 @@ bool Application::CreatePipeline()
     m_PipelineLayout = wgpuDeviceCreatePipelineLayout(m_Device, &layoutDesc);
 
 
-    // Vertex fetch
-    std::vector<WGPUVertexAttribute> vertexAttribs(4);
-    vertexAttribs[0].format = WGPUVertexFormat::WGPUVertexFormat_Float32x3;
-    vertexAttribs[0].offset = 0;
-    vertexAttribs[0].shaderLocation = 0;
-
-    vertexAttribs[1].format = WGPUVertexFormat::WGPUVertexFormat_Float32x3;
-    vertexAttribs[1].offset = 3 * sizeof(float); // starts after x, y, z position
-    vertexAttribs[1].shaderLocation = 1;
+    // Vertex fetch, described by the same layout the loader packs vertices with
+    std::vector<WGPUVertexAttribute> vertexAttribs;
+    GetWebGPUVertexAttributes(m_VertexLayout, vertexAttribs);
 
-    vertexAttribs[2].format = WGPUVertexFormat::WGPUVertexFormat_Float32x3;
-    vertexAttribs[2].offset = 6 * sizeof(float); // starts after x, y, z position and x, y, z normal
-    vertexAttribs[2].shaderLocation = 2;
+    // The built-in meshes are written by hand in this layout
+    assert(m_VertexLayout.GetStride() == VertexFloatComponentCount * sizeof(float));
 
-    vertexAttribs[3].format = WGPUVertexFormat::WGPUVertexFormat_Float32x2;
-    vertexAttribs[3].offset = 9 * sizeof(float); // starts after x, y, z position and x, y uv
-    vertexAttribs[3].shaderLocation = 3;
-
-    const uint32_t StrideSize = VertexFloatComponentCount * sizeof(float);
-    m_VertexBufferLayout.arrayStride = StrideSize;
+    m_VertexBufferLayout.arrayStride = m_VertexLayout.GetStride();
     m_VertexBufferLayout.stepMode = WGPUVertexStepMode::WGPUVertexStepMode_Vertex;
     m_VertexBufferLayout.attributeCount = static_cast<uint32_t>(vertexAttribs.size());
     m_VertexBufferLayout.attributes = vertexAttribs.data();
@@ -1489,13 +1565,38 @@ bool Application::CreatePipeline()
 
     m_Pipeline = wgpuDeviceCreateRenderPipeline(m_Device, &pipelineDesc);
 
+    // Same pipeline fetching the compact vertex format, vs_main_compact dequantizes it
+    {
+        std::vector<WGPUVertexAttribute> compactVertexAttribs;
+        GetWebGPUVertexAttributes(m_CompactVertexLayout, compactVertexAttribs);
+
+        m_CompactVertexBufferLayout.arrayStride = m_CompactVertexLayout.GetStride();
+        m_CompactVertexBufferLayout.stepMode = WGPUVertexStepMode::WGPUVertexStepMode_Vertex;
+        m_CompactVertexBufferLayout.attributeCount = static_cast<uint32_t>(compactVertexAttribs.size());
+        m_CompactVertexBufferLayout.attributes = compactVertexAttribs.data();
+
+#ifdef __EMSCRIPTEN__
+        WGPUStringView entryvsCompact{};
+        entryvsCompact.data = "vs_main_compact";
+        entryvsCompact.length = strlen(entryvsCompact.data);
+
+        pipelineDesc.vertex.entryPoint = entryvsCompact;
+#else
+        pipelineDesc.vertex.entryPoint = "vs_main_compact";
+#endif
+        pipelineDesc.vertex.buffers = &m_CompactVertexBufferLayout;
+
+        SET_WGPU_LABEL(pipelineDesc, "Compact Pipeline");
+
+        m_CompactPipeline = wgpuDeviceCreateRenderPipeline(m_Device, &pipelineDesc);
+    }
 
-    return m_Pipeline != nullptr;
+    return m_Pipeline != nullptr && m_CompactPipeline != nullptr;
 }
 
-bool Application::CreateVertexBuffer(uint32_t& OutBufferSize, WGPUBuffer& OutVertexBuffer, const std::vector<float>& VertexBufferData) const
+bool Application::CreateVertexBuffer(uint32_t& OutBufferSize, WGPUBuffer& OutVertexBuffer, const void* VertexData, uint32_t VertexDataSize) const
 {
-    OutBufferSize = (uint32_t)VertexBufferData.size() * sizeof(float);
+    OutBufferSize = VertexDataSize;
     //BufferSize = (BufferSize + 3) & ~3; //No need since buffer is already align by 4 bytes
 
     WGPUBufferDescriptor vertexBufferDesc{};
@@ -1521,7 +1622,7 @@ bool Application::CreateVertexBuffer(uint32_t& OutBufferSize, WGPUBuffer& OutVer
     }
 
     void* mapped = wgpuBufferGetMappedRange(stagingBuffer, 0, stagingDesc.size);
-    memcpy(mapped, VertexBufferData.data(), stagingDesc.size);
+    memcpy(mapped, VertexData, stagingDesc.size);
     wgpuBufferUnmap(stagingBuffer);
 
     WGPUCommandEncoderDescriptor encoderDesc{};
@@ -1548,12 +1649,12 @@ bool Application::CreateVertexBuffer(uint32_t& OutBufferSize, WGPUBuffer& OutVer
     return true;
 }
 
-bool Application::CreateIndexBuffer(uint32_t& OutIndexBufferSize, uint32_t& OutIndicesCount, WGPUBuffer& OutIndexBuffer, const std::vector<uint32_t>& Indices) const
+bool Application::CreateIndexBuffer(uint32_t& OutIndexBufferSize, uint32_t& OutIndicesCount, WGPUBuffer& OutIndexBuffer, const void* IndexData, uint32_t IndexCount, WGPUIndexFormat IndexFormat) const
 {
-    OutIndicesCount = (uint32_t)Indices.size();
+    OutIndicesCount = IndexCount;
 
-    OutIndexBufferSize = OutIndicesCount * sizeof(uint32_t);
-    OutIndexBufferSize = (OutIndexBufferSize + 3) & ~3; //No need since buffer is already align by 4 bytes, since uint32_t is 4 bytes, if we use uint16_t or lower then we might have to uncomment this
+    const uint32_t IndexDataSize = IndexCount * static_cast<uint32_t>(IndexFormat == WGPUIndexFormat_Uint16 ? sizeof(uint16_t) : sizeof(uint32_t));
+    OutIndexBufferSize = (IndexDataSize + 3) & ~3; // Buffer copies work in multiples of 4 bytes, an odd count of 16 bit indices needs padding
 
     WGPUBufferDescriptor vertexBufferDesc{};
     vertexBufferDesc.nextInChain = nullptr;
@@ -1576,7 +1677,8 @@ bool Application::CreateIndexBuffer(uint32_t& OutIndexBufferSize, uint32_t& OutI
         return false;
 
     void* mapped = wgpuBufferGetMappedRange(stagingBuffer, 0, stagingDesc.size);
-    memcpy(mapped, Indices.data(), stagingDesc.size);
+    memcpy(mapped, IndexData, IndexDataSize);
+    memset(static_cast<uint8_t*>(mapped) + IndexDataSize, 0, OutIndexBufferSize - IndexDataSize);
     wgpuBufferUnmap(stagingBuffer);
 
     WGPUCommandEncoderDescriptor encoderDesc{};
@@ -1621,7 +1723,7 @@ bool Application::CreateUniformBuffer()
     wgpuQueueWriteBuffer(m_Queue, m_UniformBuffer, 0, &ConstData, sizeof(ConstantUniforms));
 
     DynamicUniforms DynData;
-    FillDynamicUniform(DynData, Pandu::Matrix44::IDENTITY, Pandu::Vector4::UNIT);
+    FillDynamicUniform(DynData, Pandu::Matrix44::IDENTITY, Pandu::Matrix44::IDENTITY, Pandu::Vector4::UNIT, Pandu::Vector4::UNIT, Pandu::Vector4::ZERO);
     wgpuQueueWriteBuffer(m_Queue, m_UniformBuffer, m_ConstantUniformBufferStride, &DynData, sizeof(DynamicUniforms));
 
     // Create a binding
@@ -1655,98 +1757,248 @@ bool Application::CreateUniformBuffer()
     return true;
 }
 
-void Application::CheckLoadingObjects()
+Application::RenderMesh::~RenderMesh()
 {
-    for (auto itr = m_LoadingModels.begin(); itr != m_LoadingModels.end(); )
+    if (VertexBuffer)
     {
-        auto& futureModel = *itr;
-
-        if (futureModel.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
-        {
-            auto modelPtr = futureModel.get(); // move out unique_ptr
-            if (modelPtr)
-            {
-                LoadRenderModel(modelPtr.get());
-            }
+        wgpuBufferRelease(VertexBuffer);
+    }
 
-            // erase returns the next iterator
-            itr = m_LoadingModels.erase(itr);
-        }
-        else
-        {
-            ++itr;
-        }
+    if (IndexBuffer)
+    {
+        wgpuBufferRelease(IndexBuffer);
     }
 }
 
-void Application::LoadRenderModel(const ObjModelLoader::ModelData* Data)
+Application::ObjectId Application::RequestModel(const std::string& FilePath, const Pandu::Matrix44& Transform)
 {
-    if (Data == nullptr || Data->positions.size() < 3 || Data->indices.size() < 3)
-        return;
+    ObjModelLoader::LoadSettings LoadSettings;
+    LoadSettings.Layout = m_UseCompactVertices ? m_CompactVertexLayout : m_VertexLayout;
 
-    const int VertexCount = (int)Data->positions.size() / 3;
+    // Nearer models load first
+    const float ModelDistance = (Transform.GetTranslate() - m_CameraMatrix.GetTranslate()).Length();
 
-    std::vector<float> Vertices;
-    Vertices.reserve(VertexCount * VertexFloatComponentCount);
+    const ObjectId Object = m_NextObjectId++;
 
-    const int NormalCount = (int)Data->normals.size() / 3;
-    const int UVCount = (int)Data->texcoords.size() / 2;
-    for (int i = 0; i < VertexCount; i++)
+    std::shared_ptr<RenderMesh> Mesh;
+    const ModelLoadQueue::RequestId Id = m_MeshRegistry.Request(m_ModelLoadQueue, FilePath, LoadSettings, -ModelDistance, Mesh);
+    if (Id == ModelLoadQueue::INVALID_REQUEST)
     {
-        const Pandu::Vector3 Position(Data->positions[i * 3 + 0], Data->positions[i * 3 + 1], Data->positions[i * 3 + 2]);
-        const Pandu::Vector3 Normal = i * 3 >= NormalCount ? Pandu::Vector3::UNIT_Z : Pandu::Vector3(Data->normals[i * 3 + 0], Data->normals[i * 3 + 1], Data->normals[i * 3 + 2]);
-        const Pandu::Vector3 Color = Pandu::Vector3::UNIT;
-        const Pandu::Vector2 UV = i * 2 >= UVCount ? Pandu::Vector2::UNIT_X : Pandu::Vector2(Data->normals[i * 2 + 0], Data->normals[i * 2 + 1]);
-
-        Vertices.push_back(Position.x);     Vertices.push_back(Position.y);     Vertices.push_back(Position.z);
-        Vertices.push_back(Normal.x);       Vertices.push_back(Normal.y);       Vertices.push_back(Normal.z);
-        Vertices.push_back(Color.x);        Vertices.push_back(Color.y);        Vertices.push_back(Color.z);
-        Vertices.push_back(UV.x);           Vertices.push_back(UV.y);
+        m_RenderObjects.push_back({ Mesh, Transform, Object });
+        return Object;
     }
 
-    uint32_t VertexBufferSize = 0;
-    WGPUBuffer NewVertexBuffer = nullptr;
-    uint32_t IndexBufferSize = 0;
-    uint32_t IndicesCount = 0;
-    WGPUBuffer NewIndexBuffer = nullptr;
+    m_PendingObjects.insert(std::make_pair(Id, PendingObject{ Object, Transform }));
+    return Object;
+}
+
+void Application::CheckLoadingObjects()
+{
+    // Collecting hands the memory of the finished models back to the queue, the next loads can start
+    std::vector<ModelLoadQueue::Result> Finished;
+    m_ModelLoadQueue.CollectFinished(Finished);
 
-    if (!CreateVertexBuffer(VertexBufferSize, NewVertexBuffer, Vertices))
+    for (const ModelLoadQueue::Result& Loaded : Finished)
     {
-        DestroyBuffer(NewVertexBuffer);
+        const std::shared_ptr<RenderMesh> Mesh = m_MeshRegistry.Resolve(Loaded, [this](const ObjModelLoader::ModelData& Data) { return CreateRenderMesh(Data); });
 
+        auto Range = m_PendingObjects.equal_range(Loaded.Id);
+        for (auto it = Range.first; Mesh && it != Range.second; ++it)
+        {
+            m_RenderObjects.push_back({ Mesh, it->second.ObjectTransform, it->second.Id });
+        }
+        m_PendingObjects.erase(Range.first, Range.second);
+    }
+}
+
+void Application::RemoveModel(ObjectId Id)
+{
+    // The mesh goes with the last object drawing it
+    auto Placed = std::find_if(m_RenderObjects.begin(), m_RenderObjects.end(), [Id](const RenderObject& Object) { return Object.Id == Id; });
+    if (Placed != m_RenderObjects.end())
+    {
+        m_RenderObjects.erase(Placed);
         return;
     }
 
-    if (!CreateIndexBuffer(IndexBufferSize, IndicesCount, NewIndexBuffer, Data->indices))
+    // The registry cancels the load once no other object waits for it
+    for (auto it = m_PendingObjects.begin(); it != m_PendingObjects.end(); ++it)
     {
-        DestroyBuffer(NewVertexBuffer);
-        DestroyBuffer(NewIndexBuffer);
+        if (it->second.Id == Id)
+        {
+            m_MeshRegistry.Cancel(m_ModelLoadQueue, it->first);
+            m_PendingObjects.erase(it);
+            return;
+        }
+    }
+}
 
-        return;
+std::shared_ptr<Application::RenderMesh> Application::CreateRenderMesh(const ObjModelLoader::ModelData& Data) const
+{
+    if (Data.vertexCount == 0 || Data.indexCount < 3)
+        return nullptr;
+
+    // Packed by the loader for one of the pipelines, anything else can't be drawn
+    const bool CompactVertices = Data.layout == m_CompactVertexLayout;
+    if (!CompactVertices && Data.layout != m_VertexLayout)
+        return nullptr;
+
+    // Whatever was created is released with the mesh when a step fails
+    std::shared_ptr<RenderMesh> Mesh = std::make_shared<RenderMesh>();
+
+    if (!CreateVertexBuffer(Mesh->VertexBufferSize, Mesh->VertexBuffer, Data.vertices.data(), static_cast<uint32_t>(Data.vertices.size())))
+        return nullptr;
+
+    Mesh->IndexFormat = Data.indexFormat == ObjModelLoader::ModelData::IndexFormat::Uint16 ? WGPUIndexFormat_Uint16 : WGPUIndexFormat_Uint32;
+    if (!CreateIndexBuffer(Mesh->IndexBufferSize, Mesh->IndicesCount, Mesh->IndexBuffer, Data.indexData.data(), Data.indexCount, Mesh->IndexFormat))
+        return nullptr;
+
+    const VertexPacker::Quantization& Quantization = Data.quantization;
+    Mesh->CompactVertices = CompactVertices;
+    Mesh->PositionScale = Pandu::Vector4(Quantization.PositionScale[0], Quantization.PositionScale[1], Quantization.PositionScale[2], 1.0f);
+    Mesh->PositionOffset = Pandu::Vector4(Quantization.PositionOffset[0], Quantization.PositionOffset[1], Quantization.PositionOffset[2], 0.0f);
+    Mesh->Bounds = Data.bounds;
+    Mesh->Submeshes = Data.submeshes;
+
+    // One vertex and index buffer for the whole model, the material only changes the per draw uniforms
+    for (const ObjModelLoader::ModelData::Submesh& Submesh : Data.submeshes)
+    {
+        if (Submesh.materialIndex < 0)
+        {
+            Mesh->SubmeshColors.push_back(Pandu::Vector4::UNIT);
+            continue;
+        }
+
+        const ObjModelLoader::ModelData::Material& Material = Data.materials[Submesh.materialIndex];
+        Mesh->SubmeshColors.push_back(Pandu::Vector4(Material.diffuse[0], Material.diffuse[1], Material.diffuse[2], Material.opacity));
     }
 
-    m_RenderObjects.push_back({ VertexBufferSize , NewVertexBuffer, IndexBufferSize, IndicesCount, NewIndexBuffer, m_ObjModelTransform });
+    return Mesh;
 }
 
 void Application::RenderRenderObject(uint32_t& InOutBufferOffsetIndex, WGPURenderPassEncoder renderPass)
 {
+    WGPURenderPipeline BoundPipeline = nullptr;
+
     const int Count = (int)m_RenderObjects.size();
     for (int i = 0; i < Count; i++)
     {
-        const RenderBuffer& RenderBuff = m_RenderObjects[i];
+        // Every object takes at least one dynamic uniform slot, objects past the last slot are not drawn this frame
+        if (InOutBufferOffsetIndex >= maxDrawCallsPerFrameSupported)
+            break;
+
+        const RenderObject& Object = m_RenderObjects[i];
+        const RenderMesh& Mesh = *Object.Mesh;
+
+        const WGPURenderPipeline Pipeline = Mesh.CompactVertices ? m_CompactPipeline : m_Pipeline;
+        if (Pipeline != BoundPipeline)
+        {
+            wgpuRenderPassEncoderSetPipeline(renderPass, Pipeline);
+            BoundPipeline = Pipeline;
+        }
+
+        wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, Mesh.VertexBuffer, 0, Mesh.VertexBufferSize);
+        wgpuRenderPassEncoderSetIndexBuffer(renderPass, Mesh.IndexBuffer, Mesh.IndexFormat, 0, Mesh.IndexBufferSize);
 
-        wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, RenderBuff.VertexBuffer, 0, RenderBuff.VertexBufferSize);
-        wgpuRenderPassEncoderSetIndexBuffer(renderPass, RenderBuff.IndexBuffer, WGPUIndexFormat_Uint32, 0, RenderBuff.IndexBufferSize);
+        const Pandu::Matrix44 InverseTransform = GetTransformInverse(Object.ObjectTransform);
 
-        DynamicUniforms DynData;
-        FillDynamicUniform(DynData, RenderBuff.ObjectTransform, Pandu::Vector4::UNIT);
-        wgpuQueueWriteBuffer(m_Queue, m_UniformBuffer, m_ConstantUniformBufferStride + m_DynamicsUniformBufferStride * InOutBufferOffsetIndex, &DynData, sizeof(DynamicUniforms));
+        // Meshlet cones are in model space, the camera goes there instead
+        const Pandu::Vector3 ModelSpaceCamera = InverseTransform * m_CameraMatrix.GetTranslate();
 
-          
-        const uint32_t dynamicOffset = InOutBufferOffsetIndex * m_DynamicsUniformBufferStride;
-        wgpuRenderPassEncoderSetBindGroup(renderPass, 0, m_BindGroup, 1, &dynamicOffset);
-        wgpuRenderPassEncoderDrawIndexed(renderPass, RenderBuff.IndicesCount, 1, 0, 0, 0);
+        // Every color change takes the next dynamic uniform slot, submeshes sharing a color share the slot.
+        // Once the slots run out the remaining submeshes keep the last color.
+        bool HasUniforms = false;
+        Pandu::Vector4 BoundColor;
+
+        for (size_t s = 0; s < Mesh.Submeshes.size(); s++)
+        {
+            const ObjModelLoader::ModelData::Submesh& Submesh = Mesh.Submeshes[s];
+            const Pandu::Vector4& Color = s < Mesh.SubmeshColors.size() ? Mesh.SubmeshColors[s] : Pandu::Vector4::UNIT;
 
-        InOutBufferOffsetIndex++;
+            if (!HasUniforms || (Color != BoundColor && InOutBufferOffsetIndex < maxDrawCallsPerFrameSupported))
+            {
+                DynamicUniforms DynData;
+                FillDynamicUniform(DynData, Object.ObjectTransform, InverseTransform, Color, Mesh.PositionScale, Mesh.PositionOffset);
+                wgpuQueueWriteBuffer(m_Queue, m_UniformBuffer, m_ConstantUniformBufferStride + m_DynamicsUniformBufferStride * InOutBufferOffsetIndex, &DynData, sizeof(DynamicUniforms));
+
+                const uint32_t dynamicOffset = InOutBufferOffsetIndex * m_DynamicsUniformBufferStride;
+                wgpuRenderPassEncoderSetBindGroup(renderPass, 0, m_BindGroup, 1, &dynamicOffset);
+
+                InOutBufferOffsetIndex++;
+                HasUniforms = true;
+                BoundColor = Color;
+            }
+
+            uint32_t FirstIndex = 0;
+            uint32_t IndexCount = 0;
+            SelectLodRange(Object.ObjectTransform, Submesh, FirstIndex, IndexCount);
+
+            if (FirstIndex != Submesh.firstIndex || Submesh.meshlets.empty())
+            {
+                wgpuRenderPassEncoderDrawIndexed(renderPass, IndexCount, 1, FirstIndex, 0, 0);
+                continue;
+            }
+
+            // Full detail skips the meshlets facing away from the camera, neighbouring visible meshlets share a draw
+            uint32_t RunFirstIndex = 0;
+            uint32_t RunIndexCount = 0;
+            for (const Meshlet& Cluster : Submesh.meshlets)
+            {
+                if (Cluster.IsBackFacing(ModelSpaceCamera))
+                    continue;
+
+                if (RunIndexCount > 0 && RunFirstIndex + RunIndexCount == Cluster.FirstIndex)
+                {
+                    RunIndexCount += Cluster.IndexCount;
+                    continue;
+                }
+
+                if (RunIndexCount > 0)
+                {
+                    wgpuRenderPassEncoderDrawIndexed(renderPass, RunIndexCount, 1, RunFirstIndex, 0, 0);
+                }
+                RunFirstIndex = Cluster.FirstIndex;
+                RunIndexCount = Cluster.IndexCount;
+            }
+
+            if (RunIndexCount > 0)
+            {
+                wgpuRenderPassEncoderDrawIndexed(renderPass, RunIndexCount, 1, RunFirstIndex, 0, 0);
+            }
+        }
+    }
+}
+
+void Application::SelectLodRange(const Pandu::Matrix44& Transform, const ObjModelLoader::ModelData::Submesh& Submesh, uint32_t& OutFirstIndex, uint32_t& OutIndexCount) const
+{
+    OutFirstIndex = Submesh.firstIndex;
+    OutIndexCount = Submesh.indexCount;
+
+    if (Submesh.lods.empty())
+    {
+        return;
+    }
+
+    // Model space errors grow with the largest axis scale of the object transform
+    float Scale = 0.0f;
+    for (int Column = 0; Column < 3; Column++)
+    {
+        const Pandu::Vector3 Axis(Transform.m[0][Column], Transform.m[1][Column], Transform.m[2][Column]);
+        Scale = std::max(Scale, Axis.Length());
+    }
+
+    // Distance to the nearest point of the bounding sphere, the whole range is drawn with one level
+    const Pandu::Vector3 Center = Transform * Submesh.bounds.Sphere.GetCenter();
+    const float Distance = std::max((Center - m_CameraMatrix.GetTranslate()).Length() - Submesh.bounds.Sphere.GetRadius() * Scale, 0.01f);
+
+    const float PixelsPerUnit = (float)m_ScreenHeight / (2.0f * std::tan(m_FieldOfViewY * 0.5f) * Distance);
+
+    for (const ObjModelLoader::ModelData::Lod& Lod : Submesh.lods)
+    {
+        if (Lod.error * Scale * PixelsPerUnit > m_LodPixelError)
+            break;
+
+        OutFirstIndex = Lod.firstIndex;
+        OutIndexCount = Lod.indexCount;
     }
-}
\ No newline at end of file
+}
@@ -15,10 +15,14 @@
 #include <webgpu/webgpu.h>
 #endif
 
-#include <list>
+#include <map>
+#include <memory>
+#include <string>
 #include <utility>
 #include <PANDUMatrix44.h>
 #include <PANDUVector4.h>
+#include "MeshRegistry.h"
+#include "ModelLoadQueue.h"
 #include "ObjModelLoader.h"
 
 #ifndef SET_WGPU_LABEL
@@ -61,15 +65,63 @@ public:
 
 private:
 
-    struct RenderBuffer
+    // GPU copy of a model, shared by every object that draws the same content
+    struct RenderMesh
     {
+        RenderMesh()
+            : VertexBufferSize(0)
+            , VertexBuffer(nullptr)
+            , IndexBufferSize(0)
+            , IndicesCount(0)
+            , IndexBuffer(nullptr)
+            , IndexFormat(WGPUIndexFormat_Uint16)
+            , CompactVertices(false)
+            , PositionScale(Pandu::Vector4::UNIT)
+            , PositionOffset(Pandu::Vector4::ZERO)
+        {
+        }
+
+        // Releases the buffers, runs once the last object drawing the mesh is gone
+        ~RenderMesh();
+
+        RenderMesh(const RenderMesh&) = delete;
+        RenderMesh& operator = (const RenderMesh&) = delete;
+
         uint32_t VertexBufferSize;
         WGPUBuffer VertexBuffer;
 
         uint32_t IndexBufferSize;
         uint32_t IndicesCount;
         WGPUBuffer IndexBuffer;
+        WGPUIndexFormat IndexFormat;
+
+        // Drawn with the compact pipeline, the position dequantization goes to the shader with the per draw uniforms
+        bool CompactVertices;
+        Pandu::Vector4 PositionScale;
+        Pandu::Vector4 PositionOffset;
+
+        // Model space bounds of the whole buffer and of each index range in it, each range drawn at the LOD level the view allows
+        MeshBounds Bounds;
+        std::vector<ObjModelLoader::ModelData::Submesh> Submeshes;
+
+        // Material color of every submesh, multiplied into the vertex color. Empty draws everything white.
+        std::vector<Pandu::Vector4> SubmeshColors;
+    };
+
+    // Identifies one object placed with RequestModel, loading or drawn
+    typedef uint32_t ObjectId;
+
+    struct RenderObject
+    {
+        std::shared_ptr<const RenderMesh> Mesh;
+        Pandu::Matrix44 ObjectTransform;
+        ObjectId Id;
+    };
 
+    // Object whose mesh is still loading
+    struct PendingObject
+    {
+        ObjectId Id;
         Pandu::Matrix44 ObjectTransform;
     };
 
@@ -82,16 +134,26 @@ private:
     bool LoadShaders();
     bool CreatePipeline();
     bool CreateUniformBuffer();
-    bool CreateVertexBuffer(uint32_t& OutBufferSize, WGPUBuffer& OutVertexBuffer, const std::vector<float>& VertexBufferData) const;
-    bool CreateIndexBuffer(uint32_t& OutIndexBufferSize, uint32_t& OutIndicesCount, WGPUBuffer& OutIndexBuffer, const std::vector<uint32_t>& Indices) const;
+    bool CreateVertexBuffer(uint32_t& OutBufferSize, WGPUBuffer& OutVertexBuffer, const void* VertexData, uint32_t VertexDataSize) const;
+    bool CreateIndexBuffer(uint32_t& OutIndexBufferSize, uint32_t& OutIndicesCount, WGPUBuffer& OutIndexBuffer, const void* IndexData, uint32_t IndexCount, WGPUIndexFormat IndexFormat) const;
     void DestroyBuffer(WGPUBuffer& Buffer);
 
     void GetNextSurfaceViewData(std::pair<WGPUSurfaceTexture, WGPUTextureView>& SurfaceViewData);
 
+    // Places a model at Transform once it is loaded, copies of a file that is loaded or loading share its mesh
+    ObjectId RequestModel(const std::string& FilePath, const Pandu::Matrix44& Transform);
     void CheckLoadingObjects();
-    void LoadRenderModel(const ObjModelLoader::ModelData* Data);
+
+    // Takes the object out of the scene. A load no other object waits for is cancelled.
+    void RemoveModel(ObjectId Id);
+
+    // nullptr when the model can't be drawn or its buffers can't be created
+    std::shared_ptr<RenderMesh> CreateRenderMesh(const ObjModelLoader::ModelData& Data) const;
     void RenderRenderObject(uint32_t& InOutBufferOffsetIndex, WGPURenderPassEncoder renderPass);
 
+    // Index range of the coarsest LOD level of Submesh whose error stays under m_LodPixelError on screen, full detail when none does
+    void SelectLodRange(const Pandu::Matrix44& Transform, const ObjModelLoader::ModelData::Submesh& Submesh, uint32_t& OutFirstIndex, uint32_t& OutIndexCount) const;
+
     bool m_IsFullyInitialized;
 
     uint32_t m_ScreenWidth;
@@ -118,13 +180,29 @@ private:
     WGPUBindGroup m_BindGroup;
 
     WGPURenderPipeline m_Pipeline;
+    WGPURenderPipeline m_CompactPipeline;
 
     WGPUTextureFormat m_SurfaceFormat = WGPUTextureFormat_Undefined;
 
     WGPUShaderModule m_ShaderModule;
 
+    // Vertex format of the pipeline, loaded models are packed into it on the loader thread
+    VertexLayout m_VertexLayout;
     WGPUVertexBufferLayout m_VertexBufferLayout;
 
+    // Quantized vertex format of the compact pipeline, about a third of the memory of m_VertexLayout
+    VertexLayout m_CompactVertexLayout;
+    WGPUVertexBufferLayout m_CompactVertexBufferLayout;
+
+    // Load models into the compact vertex format
+    bool m_UseCompactVertices;
+
+    // Vertical field of view of the camera, in radians
+    float m_FieldOfViewY;
+
+    // LOD levels are drawn while their simplification error projects to at most this many pixels
+    float m_LodPixelError;
+
     uint32_t m_ConstantUniformBufferSize;
     uint32_t m_ConstantUniformBufferStride;
     uint32_t m_DynamicsUniformBufferSize;
@@ -134,9 +212,17 @@ private:
     WGPUTexture m_DepthTexture;
     WGPUTextureView m_DepthTextureView;
 
-    std::list<std::future<std::unique_ptr<const ObjModelLoader::ModelData>>> m_LoadingModels;
+    // Loads models on a fixed set of workers, nearest first and within a memory budget
+    ModelLoadQueue m_ModelLoadQueue;
+
+    // Requests of the same file join one load, loads with the same content share one mesh
+    MeshRegistry<RenderMesh> m_MeshRegistry;
+
+    // Objects waiting for each request
+    std::multimap<ModelLoadQueue::RequestId, PendingObject> m_PendingObjects;
 
-    std::vector<RenderBuffer> m_RenderObjects;
+    std::vector<RenderObject> m_RenderObjects;
+    ObjectId m_NextObjectId;
 
     Pandu::Matrix44 m_CameraMatrix;
     Pandu::Matrix44 m_ObjModelTransform;
@@ -0,0 +1,199 @@
+#include "ObjModelLoader.h"
+#include "MeshCache.h"
+
+#include <ParallelUtils.h>
+#include <VertexLayout.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// AssetCooker <asset directory> [--threads N] [--layout default|compact|all] [--force]
+// Cooks every .obj under the directory into one cooked file per vertex layout next to it, the files the App loads
+// instead of parsing. Sources whose hash matches the one their cooked file was built from are skipped.
+namespace
+{
+    struct CookJob
+    {
+        std::string SourcePath;
+        ObjModelLoader::LoadSettings Settings;
+    };
+
+    enum class CookResult
+    {
+        Cooked,
+        UpToDate,
+        Failed,
+    };
+
+    bool IsObjFile(const std::filesystem::path& Path)
+    {
+        std::string Extension = Path.extension().string();
+        std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return Extension == ".obj";
+    }
+
+    // The App draws with one of these two layouts and otherwise the default settings, see Application::RequestModel
+    std::vector<VertexLayout> GetLayouts(const std::string& Name)
+    {
+        std::vector<VertexLayout> Layouts;
+        if (Name == "default" || Name == "all")
+        {
+            Layouts.push_back(VertexLayout::CreateDefault());
+        }
+        if (Name == "compact" || Name == "all")
+        {
+            Layouts.push_back(VertexLayout::CreateCompact());
+        }
+        return Layouts;
+    }
+
+    CookResult Cook(const CookJob& Job, uint64_t SourceHash, bool Force)
+    {
+        const uint64_t SettingsKey = Job.Settings.GetCacheKey();
+
+        uint64_t CookedHash = 0;
+        // A touched but unchanged source keeps its cooked file, whose stamp is brought up to date for the runtime check
+        if (!Force && MeshCache::GetCookedSourceHash(Job.SourcePath, SettingsKey, CookedHash) && CookedHash == SourceHash)
+        {
+            MeshCache::RefreshCookedStamp(Job.SourcePath, SettingsKey);
+            return CookResult::UpToDate;
+        }
+
+        std::unique_ptr<const ObjModelLoader::ModelData> Model = ObjModelLoader(Job.SourcePath, Job.Settings).LoadNow();
+        if (!Model || !MeshCache::WriteCooked(Job.SourcePath, SourceHash, SettingsKey, *Model))
+            return CookResult::Failed;
+
+        return CookResult::Cooked;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string AssetDirectory;
+    uint32_t ThreadCount = 0;
+    std::string LayoutName = "all";
+    bool Force = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string Arg = argv[i];
+        if (Arg == "--threads" && i + 1 < argc)
+        {
+            ThreadCount = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (Arg == "--layout" && i + 1 < argc)
+        {
+            LayoutName = argv[++i];
+        }
+        else if (Arg == "--force")
+        {
+            Force = true;
+        }
+        else
+        {
+            AssetDirectory = Arg;
+        }
+    }
+
+    const std::vector<VertexLayout> Layouts = GetLayouts(LayoutName);
+    if (AssetDirectory.empty() || Layouts.empty())
+    {
+        std::cerr << "usage: AssetCooker <asset directory> [--threads N] [--layout default|compact|all] [--force]" << std::endl;
+        return 1;
+    }
+
+    std::error_code Error;
+    std::vector<std::string> Sources;
+    for (std::filesystem::recursive_directory_iterator it(AssetDirectory, Error), end; !Error && it != end; it.increment(Error))
+    {
+        if (it->is_regular_file(Error) && IsObjFile(it->path()))
+        {
+            Sources.push_back(it->path().generic_string());
+        }
+    }
+
+    if (Error)
+    {
+        std::cerr << "Could not walk " << AssetDirectory << " : " << Error.message() << std::endl;
+        return 1;
+    }
+
+    std::sort(Sources.begin(), Sources.end());
+
+    const auto Start = std::chrono::steady_clock::now();
+
+    // Hashed once per source however many layouts it is cooked for, the files are spread over the threads instead of
+    // every load spreading its own stages
+    std::vector<uint64_t> SourceHashes(Sources.size(), 0);
+    std::vector<char> Hashed(Sources.size(), 0);
+    ParallelUtils::For(Sources.size(), ThreadCount, [&](size_t i)
+    {
+        Hashed[i] = MeshCache::HashSource(Sources[i], SourceHashes[i]) ? 1 : 0;
+    });
+
+    std::vector<CookJob> Jobs;
+    std::vector<size_t> JobSources;
+    for (size_t i = 0; i < Sources.size(); i++)
+    {
+        if (!Hashed[i])
+        {
+            std::cerr << "Could not read " << Sources[i] << std::endl;
+            continue;
+        }
+
+        for (const VertexLayout& Layout : Layouts)
+        {
+            CookJob Job;
+            Job.SourcePath = Sources[i];
+            Job.Settings.Layout = Layout;
+            Job.Settings.PreferCooked = false;
+            Job.Settings.UseMeshCache = false;
+            Job.Settings.ParseThreadCount = 1;
+            Jobs.push_back(Job);
+            JobSources.push_back(i);
+        }
+    }
+
+    std::mutex OutputMutex;
+    std::atomic<size_t> CookedCount(0);
+    std::atomic<size_t> UpToDateCount(0);
+    std::atomic<size_t> FailedCount(0);
+
+    ParallelUtils::For(Jobs.size(), ThreadCount, [&](size_t i)
+    {
+        const CookJob& Job = Jobs[i];
+        const CookResult Result = Cook(Job, SourceHashes[JobSources[i]], Force);
+
+        std::lock_guard<std::mutex> Lock(OutputMutex);
+        const std::string CookedPath = MeshCache::GetCookedPath(Job.SourcePath, Job.Settings.GetCacheKey());
+        switch (Result)
+        {
+        case CookResult::Cooked:
+            CookedCount++;
+            std::cout << "cooked     " << CookedPath << std::endl;
+            break;
+        case CookResult::UpToDate:
+            UpToDateCount++;
+            std::cout << "up to date " << CookedPath << std::endl;
+            break;
+        case CookResult::Failed:
+            FailedCount++;
+            std::cerr << "FAILED     " << Job.SourcePath << std::endl;
+            break;
+        }
+    });
+
+    const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::cout << Sources.size() << " sources, " << CookedCount << " cooked, " << UpToDateCount << " up to date, " << FailedCount << " failed in "
+        << Seconds << " s" << std::endl;
+
+    return FailedCount == 0 && Jobs.size() == Sources.size() * Layouts.size() ? 0 : 1;
+}
@@ -0,0 +1,1174 @@
+#include "ObjModelLoader.h"
+#include "MappedFile.h"
+#include "ModelLoadQueue.h"
+#include "MeshCache.h"
+#include "MeshRegistry.h"
+#include "Paths.h"
+#include "tiny_obj_loader.h"
+
+#include <MeshOptimizer.h>
+#include <MeshWelder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double ElapsedMs(const Clock::time_point& Start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+    }
+
+    void FetchCorner(const tinyobj::attrib_t& attrib, const tinyobj::index_t& idx, float (&Position)[3], float (&Normal)[3], float (&Uv)[2])
+    {
+        Position[0] = 0.0f; Position[1] = 0.0f; Position[2] = 0.0f;
+        Normal[0] = 0.0f;   Normal[1] = 0.0f;   Normal[2] = 1.0f;
+        Uv[0] = 0.0f;       Uv[1] = 0.0f;
+
+        if (idx.vertex_index >= 0) std::copy(&attrib.vertices[3 * idx.vertex_index], &attrib.vertices[3 * idx.vertex_index] + 3, Position);
+        if (idx.normal_index >= 0) std::copy(&attrib.normals[3 * idx.normal_index], &attrib.normals[3 * idx.normal_index] + 3, Normal);
+        if (idx.texcoord_index >= 0) std::copy(&attrib.texcoords[2 * idx.texcoord_index], &attrib.texcoords[2 * idx.texcoord_index] + 2, Uv);
+    }
+
+    // The std::map based welding ReadObjFile used before MeshWelder, kept as the baseline
+    size_t WeldWithMap(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<uint32_t>& OutIndices)
+    {
+        struct VertexKey
+        {
+            float v[8];
+
+            static bool nearlyEqual(float a, float b) { return std::fabs(a - b) < 1e-8f; }
+
+            bool operator < (const VertexKey& o) const
+            {
+                for (int i = 0; i < 7; i++)
+                {
+                    if (!nearlyEqual(v[i], o.v[i]))
+                        return v[i] < o.v[i];
+                }
+                return v[7] < o.v[7];
+            }
+        };
+
+        std::map<VertexKey, uint32_t> uniqueVerts;
+        std::vector<float> vertices;
+        OutIndices.clear();
+
+        for (const auto& shape : shapes)
+        {
+            for (const auto& idx : shape.mesh.indices)
+            {
+                float position[3], normal[3], uv[2];
+                FetchCorner(attrib, idx, position, normal, uv);
+
+                const VertexKey key{ { position[0], position[1], position[2], normal[0], normal[1], normal[2], uv[0], uv[1] } };
+
+                auto it = uniqueVerts.find(key);
+                if (it == uniqueVerts.end())
+                {
+                    const uint32_t newIndex = static_cast<uint32_t>(uniqueVerts.size());
+                    uniqueVerts[key] = newIndex;
+                    vertices.insert(vertices.end(), key.v, key.v + 8);
+                    OutIndices.push_back(newIndex);
+                }
+                else
+                {
+                    OutIndices.push_back(it->second);
+                }
+            }
+        }
+
+        return uniqueVerts.size();
+    }
+
+    size_t WeldWithHash(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<uint32_t>& OutIndices)
+    {
+        MeshWelder welder(MeshWelder::Settings(), attrib.vertices.size() / 3);
+        OutIndices.clear();
+
+        for (const auto& shape : shapes)
+        {
+            for (const auto& idx : shape.mesh.indices)
+            {
+                float position[3], normal[3], uv[2];
+                FetchCorner(attrib, idx, position, normal, uv);
+
+                OutIndices.push_back(welder.AddVertex(position, normal, uv));
+            }
+        }
+
+        return welder.GetVertexCount();
+    }
+
+    // Peak resident set size of the process so far in KB, 0 where it isn't available
+    long PeakRssKb()
+    {
+#ifndef _WIN32
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+#ifdef __APPLE__
+            return usage.ru_maxrss / 1024;
+#else
+            return usage.ru_maxrss;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+    template <typename T>
+    bool SameData(const ArrayView<T>& A, const ArrayView<T>& B)
+    {
+        return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+    }
+
+    bool SameBounds(const MeshBounds& A, const MeshBounds& B)
+    {
+        return A.Box.GetMin() == B.Box.GetMin() && A.Box.GetMax() == B.Box.GetMax()
+            && A.Sphere.GetCenter() == B.Sphere.GetCenter() && A.Sphere.GetRadius() == B.Sphere.GetRadius();
+    }
+
+    bool SameSubmeshes(const std::vector<ObjModelLoader::ModelData::Submesh>& A, const std::vector<ObjModelLoader::ModelData::Submesh>& B)
+    {
+        if (A.size() != B.size())
+            return false;
+
+        for (size_t i = 0; i < A.size(); i++)
+        {
+            if (A[i].firstIndex != B[i].firstIndex || A[i].indexCount != B[i].indexCount || !SameBounds(A[i].bounds, B[i].bounds)
+                || A[i].materialIndex != B[i].materialIndex || A[i].lods.size() != B[i].lods.size())
+                return false;
+
+            for (size_t l = 0; l < A[i].lods.size(); l++)
+            {
+                const ObjModelLoader::ModelData::Lod& LodA = A[i].lods[l];
+                const ObjModelLoader::ModelData::Lod& LodB = B[i].lods[l];
+                if (LodA.firstIndex != LodB.firstIndex || LodA.indexCount != LodB.indexCount || LodA.error != LodB.error)
+                    return false;
+            }
+
+            if (A[i].meshlets.size() != B[i].meshlets.size())
+                return false;
+
+            for (size_t m = 0; m < A[i].meshlets.size(); m++)
+            {
+                const Meshlet& MeshletA = A[i].meshlets[m];
+                const Meshlet& MeshletB = B[i].meshlets[m];
+                if (MeshletA.FirstIndex != MeshletB.FirstIndex || MeshletA.IndexCount != MeshletB.IndexCount
+                    || MeshletA.Bounds.GetCenter() != MeshletB.Bounds.GetCenter() || MeshletA.Bounds.GetRadius() != MeshletB.Bounds.GetRadius()
+                    || MeshletA.ConeApex != MeshletB.ConeApex || MeshletA.ConeAxis != MeshletB.ConeAxis || MeshletA.ConeCutoff != MeshletB.ConeCutoff)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool SameMaterials(const std::vector<ObjModelLoader::ModelData::Material>& A, const std::vector<ObjModelLoader::ModelData::Material>& B)
+    {
+        if (A.size() != B.size())
+            return false;
+
+        for (size_t i = 0; i < A.size(); i++)
+        {
+            if (A[i].name != B[i].name || !std::equal(A[i].diffuse, A[i].diffuse + 3, B[i].diffuse) || A[i].opacity != B[i].opacity
+                || A[i].diffuseTexture != B[i].diffuseTexture)
+                return false;
+        }
+        return true;
+    }
+
+    bool SameModel(const ObjModelLoader::ModelData* A, const ObjModelLoader::ModelData* B)
+    {
+        return A && B
+            && A->layout == B->layout
+            && A->vertexCount == B->vertexCount
+            && SameData(A->vertices, B->vertices)
+            && A->indexFormat == B->indexFormat
+            && A->indexCount == B->indexCount
+            && SameData(A->indexData, B->indexData)
+            && SameBounds(A->bounds, B->bounds)
+            && SameSubmeshes(A->submeshes, B->submeshes)
+            && SameMaterials(A->materials, B->materials)
+            && A->contentHash == B->contentHash;
+    }
+
+    // LOD 0 only, the coarser levels stored after the full detail submeshes would mix decimated meshes into the cache statistics
+    std::vector<uint32_t> ExpandFullDetailIndices(const ObjModelLoader::ModelData& Model)
+    {
+        uint32_t FullDetailCount = 0;
+        for (const ObjModelLoader::ModelData::Submesh& Submesh : Model.submeshes)
+        {
+            FullDetailCount = std::max(FullDetailCount, Submesh.firstIndex + Submesh.indexCount);
+        }
+
+        std::vector<uint32_t> Indices(FullDetailCount);
+        for (uint32_t i = 0; i < FullDetailCount; i++)
+        {
+            Indices[i] = Model.GetIndex(i);
+        }
+        return Indices;
+    }
+
+    // Largest distance between the float positions of Reference and the dequantized snorm positions of Compact, same vertex order
+    float MaxPositionError(const ObjModelLoader::ModelData& Reference, const ObjModelLoader::ModelData& Compact)
+    {
+        const VertexLayout::Attribute& ReferencePosition = Reference.layout.GetAttribute(static_cast<uint32_t>(Reference.layout.FindAttribute(VertexLayout::Semantic::Position)));
+        const VertexLayout::Attribute& CompactPosition = Compact.layout.GetAttribute(static_cast<uint32_t>(Compact.layout.FindAttribute(VertexLayout::Semantic::Position)));
+
+        float MaxError = 0.0f;
+        for (uint32_t v = 0; v < Reference.vertexCount && v < Compact.vertexCount; v++)
+        {
+            float Expected[3];
+            int16_t Stored[4];
+            memcpy(Expected, Reference.vertices.data() + v * Reference.layout.GetStride() + ReferencePosition.Offset, sizeof(Expected));
+            memcpy(Stored, Compact.vertices.data() + v * Compact.layout.GetStride() + CompactPosition.Offset, sizeof(Stored));
+
+            float DistanceSquared = 0.0f;
+            for (int c = 0; c < 3; c++)
+            {
+                const float Normalized = std::max(static_cast<float>(Stored[c]) / 32767.0f, -1.0f);
+                const float Delta = Normalized * Compact.quantization.PositionScale[c] + Compact.quantization.PositionOffset[c] - Expected[c];
+                DistanceSquared += Delta * Delta;
+            }
+            MaxError = std::max(MaxError, std::sqrt(DistanceSquared));
+        }
+        return MaxError;
+    }
+
+    // Share of the meshlets with a usable normal cone, and of the triangles a camera on each bounding box axis culls through the cones
+    void PrintMeshletStatistics(const ObjModelLoader::ModelData& Model)
+    {
+        size_t MeshletCount = 0, ConeCount = 0, TriangleCount = 0, MaxVertices = 0;
+        for (const ObjModelLoader::ModelData::Submesh& Submesh : Model.submeshes)
+        {
+            for (const Meshlet& Cluster : Submesh.meshlets)
+            {
+                std::vector<uint32_t> Vertices;
+                for (uint32_t i = 0; i < Cluster.IndexCount; i++)
+                {
+                    Vertices.push_back(Model.GetIndex(Cluster.FirstIndex + i));
+                }
+                std::sort(Vertices.begin(), Vertices.end());
+                MaxVertices = std::max<size_t>(MaxVertices, std::unique(Vertices.begin(), Vertices.end()) - Vertices.begin());
+
+                MeshletCount++;
+                ConeCount += Cluster.ConeCutoff < 1.0f ? 1 : 0;
+                TriangleCount += Cluster.IndexCount / 3;
+            }
+        }
+
+        const Pandu::Vector3 Center = Model.bounds.Sphere.GetCenter();
+        const float Distance = Model.bounds.Sphere.GetRadius() * 3.0f;
+        const Pandu::Vector3 Cameras[] = { Center + Pandu::Vector3::UNIT_X * Distance, Center - Pandu::Vector3::UNIT_X * Distance, Center + Pandu::Vector3::UNIT_Y * Distance,
+            Center - Pandu::Vector3::UNIT_Y * Distance, Center + Pandu::Vector3::UNIT_Z * Distance, Center - Pandu::Vector3::UNIT_Z * Distance };
+
+        size_t CulledTriangles = 0;
+        for (const Pandu::Vector3& Camera : Cameras)
+        {
+            for (const ObjModelLoader::ModelData::Submesh& Submesh : Model.submeshes)
+            {
+                for (const Meshlet& Cluster : Submesh.meshlets)
+                {
+                    CulledTriangles += Cluster.IsBackFacing(Camera) ? Cluster.IndexCount / 3 : 0;
+                }
+            }
+        }
+
+        std::cout << "  meshlets       : " << MeshletCount << ", " << (MeshletCount ? TriangleCount / MeshletCount : 0) << " triangles average, " << MaxVertices << " vertices max, "
+            << ConeCount << " with a normal cone, " << 100.0 * CulledTriangles / (6.0 * std::max<size_t>(TriangleCount, 1)) << "% triangles cone culled (axis views)" << std::endl;
+    }
+
+    // Number of v/vn/vt components tinyobj parsed differently from a correctly rounded strtof of the same text
+    size_t CountMisroundedValues(const std::string& FilePath, const tinyobj::attrib_t& attrib, size_t& OutValueCount)
+    {
+        std::ifstream File(FilePath);
+        std::string Line;
+        size_t Vertex = 0, Normal = 0, Texcoord = 0, Misrounded = 0;
+        OutValueCount = 0;
+
+        auto Compare = [&](std::istringstream& Tokens, const std::vector<float>& Parsed, size_t& Offset, int Count)
+        {
+            std::string Token;
+            for (int i = 0; i < Count && Tokens >> Token && Offset < Parsed.size(); i++, Offset++)
+            {
+                const float Expected = std::strtof(Token.c_str(), nullptr);
+                Misrounded += memcmp(&Expected, &Parsed[Offset], sizeof(float)) != 0 ? 1 : 0;
+                OutValueCount++;
+            }
+        };
+
+        while (std::getline(File, Line))
+        {
+            std::istringstream Tokens(Line);
+            std::string Type;
+            Tokens >> Type;
+
+            if (Type == "v") Compare(Tokens, attrib.vertices, Vertex, 3);
+            else if (Type == "vn") Compare(Tokens, attrib.normals, Normal, 3);
+            else if (Type == "vt") Compare(Tokens, attrib.texcoords, Texcoord, 2);
+        }
+        return Misrounded;
+    }
+
+    struct LoadMemory
+    {
+        // Peak resident set growth of one load in KB, 0 where it can't be measured
+        long Serial = 0;
+        long Parallel = 0;
+        long Streaming = 0;
+
+        // Vertex and index bytes of the loaded model, what has to stay resident in the end
+        size_t ModelBytes = 0;
+    };
+
+    // Runs Work in a forked child so it starts from the same small heap and gets its own peak. Returns the peak resident
+    // set growth in KB, the value Work returns goes to OutValue.
+    template <typename WorkType>
+    long MeasureChildPeakKb(WorkType&& Work, long* OutValue)
+    {
+#ifndef _WIN32
+        int Pipe[2];
+        if (pipe(Pipe) != 0)
+            return 0;
+
+        const pid_t Child = fork();
+        if (Child == 0)
+        {
+            close(Pipe[0]);
+            const long Before = PeakRssKb();
+            const long Value = Work();
+            const long Result[2] = { PeakRssKb() - Before, Value };
+            const ssize_t Written = write(Pipe[1], Result, sizeof(Result));
+            _exit(Written == static_cast<ssize_t>(sizeof(Result)) ? 0 : 1);
+        }
+
+        close(Pipe[1]);
+        long Result[2] = { 0, 0 };
+        if (Child > 0)
+        {
+            if (read(Pipe[0], Result, sizeof(Result)) != static_cast<ssize_t>(sizeof(Result)))
+            {
+                Result[0] = Result[1] = 0;
+            }
+            waitpid(Child, nullptr, 0);
+        }
+        close(Pipe[0]);
+
+        if (OutValue)
+        {
+            *OutValue = Result[1];
+        }
+        return Result[0];
+#else
+        (void)Work;
+        if (OutValue)
+        {
+            *OutValue = 0;
+        }
+        return 0;
+#endif
+    }
+
+    long MeasureLoadPeakKb(const std::string& FilePath, const ObjModelLoader::LoadSettings& Settings, size_t* OutModelBytes)
+    {
+        long ModelBytes = 0;
+        const long PeakKb = MeasureChildPeakKb([&]()
+        {
+            std::unique_ptr<const ObjModelLoader::ModelData> Model = ObjModelLoader(FilePath, Settings).Load().get();
+            return Model ? static_cast<long>(Model->vertices.size() + Model->indexData.size()) : 0L;
+        }, &ModelBytes);
+
+        if (OutModelBytes)
+        {
+            *OutModelBytes = static_cast<size_t>(ModelBytes);
+        }
+        return PeakKb;
+    }
+
+    LoadMemory MeasureLoadMemory(const std::string& FilePath)
+    {
+        ObjModelLoader::LoadSettings ParallelSettings;
+        ParallelSettings.UseMeshCache = false;
+        ParallelSettings.PreferCooked = false;
+        ParallelSettings.StreamingParse = false;
+
+        ObjModelLoader::LoadSettings SerialSettings = ParallelSettings;
+        SerialSettings.ParallelParse = false;
+
+        ObjModelLoader::LoadSettings StreamingSettings = ParallelSettings;
+        StreamingSettings.StreamingParse = true;
+
+        LoadMemory Memory;
+        Memory.Serial = MeasureLoadPeakKb(FilePath, SerialSettings, nullptr);
+        Memory.Parallel = MeasureLoadPeakKb(FilePath, ParallelSettings, nullptr);
+        Memory.Streaming = MeasureLoadPeakKb(FilePath, StreamingSettings, &Memory.ModelBytes);
+        return Memory;
+    }
+
+    template <typename FunctionType>
+    double BestOf(int Iterations, FunctionType&& Function)
+    {
+        double Best = 1e30;
+        for (int i = 0; i < Iterations; i++)
+        {
+            const Clock::time_point Start = Clock::now();
+            Function();
+            Best = std::min(Best, ElapsedMs(Start));
+        }
+        return Best;
+    }
+
+    bool RunWeldBenchmark(const std::string& FilePath, int Iterations, const LoadMemory& Memory)
+    {
+        std::ifstream ifs(FilePath);
+        if (!ifs)
+        {
+            std::cerr << "Could not open " << FilePath << std::endl;
+            return false;
+        }
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+
+        const Clock::time_point ParseStart = Clock::now();
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &ifs))
+        {
+            std::cerr << "Parse failed " << FilePath << " : " << err << std::endl;
+            return false;
+        }
+        const double ParseMs = ElapsedMs(ParseStart);
+
+        size_t ParsedValueCount = 0;
+        const size_t MisroundedCount = CountMisroundedValues(FilePath, attrib, ParsedValueCount);
+
+        const double StreamParseMs = BestOf(Iterations, [&]()
+        {
+            std::ifstream Stream(FilePath);
+            tinyobj::attrib_t StreamAttrib;
+            std::vector<tinyobj::shape_t> StreamShapes;
+            tinyobj::LoadObj(&StreamAttrib, &StreamShapes, &materials, &warn, &err, &Stream);
+        });
+
+        const double MappedParseMs = BestOf(Iterations, [&]()
+        {
+            MappedFile File;
+            File.Open(FilePath);
+            tinyobj::attrib_t MappedAttrib;
+            std::vector<tinyobj::shape_t> MappedShapes;
+            tinyobj::LoadObjFromMemory(&MappedAttrib, &MappedShapes, &materials, &warn, &err, File.GetView());
+        });
+
+        std::vector<uint32_t> MapIndices, HashIndices;
+        size_t MapVertexCount = 0, HashVertexCount = 0;
+
+        const double MapMs = BestOf(Iterations, [&]() { MapVertexCount = WeldWithMap(attrib, shapes, MapIndices); });
+        const double HashMs = BestOf(Iterations, [&]() { HashVertexCount = WeldWithHash(attrib, shapes, HashIndices); });
+
+        ObjModelLoader::LoadSettings ParallelSettings;
+        ParallelSettings.UseMeshCache = false;
+        ParallelSettings.PreferCooked = false;
+        ParallelSettings.StreamingParse = false;
+
+        ObjModelLoader::LoadSettings UnoptimizedSettings = ParallelSettings;
+        UnoptimizedSettings.OptimizeVertexOrder = false;
+
+        ObjModelLoader::LoadSettings SerialSettings = ParallelSettings;
+        SerialSettings.ParallelParse = false;
+
+        ObjModelLoader::LoadSettings StreamingSettings = ParallelSettings;
+        StreamingSettings.StreamingParse = true;
+
+        ObjModelLoader::LoadSettings CompactSettings = ParallelSettings;
+        CompactSettings.Layout = VertexLayout::CreateCompact();
+
+        ObjModelLoader::LoadSettings NoLodSettings = ParallelSettings;
+        NoLodSettings.LodTriangleRatios.clear();
+
+        std::unique_ptr<const ObjModelLoader::ModelData> SerialModel, ParallelModel, StreamingModel, CachedModel, UnoptimizedModel, CompactModel, NoLodModel;
+        const double SerialLoadMs = BestOf(Iterations, [&]() { SerialModel = ObjModelLoader(FilePath, SerialSettings).Load().get(); });
+        const double ParallelLoadMs = BestOf(Iterations, [&]() { ParallelModel = ObjModelLoader(FilePath, ParallelSettings).Load().get(); });
+        const double StreamingLoadMs = BestOf(Iterations, [&]() { StreamingModel = ObjModelLoader(FilePath, StreamingSettings).Load().get(); });
+
+        const double UnoptimizedLoadMs = BestOf(Iterations, [&]() { UnoptimizedModel = ObjModelLoader(FilePath, UnoptimizedSettings).Load().get(); });
+        const double CompactLoadMs = BestOf(Iterations, [&]() { CompactModel = ObjModelLoader(FilePath, CompactSettings).Load().get(); });
+        const double NoLodLoadMs = BestOf(Iterations, [&]() { NoLodModel = ObjModelLoader(FilePath, NoLodSettings).Load().get(); });
+
+        const std::vector<uint32_t> IndicesBefore = ExpandFullDetailIndices(*UnoptimizedModel);
+        const std::vector<uint32_t> IndicesAfter = ExpandFullDetailIndices(*ParallelModel);
+        const MeshOptimizer::CacheStatistics CacheBefore = MeshOptimizer::AnalyzeVertexCache(IndicesBefore.data(), IndicesBefore.size(), UnoptimizedModel->vertexCount);
+        const MeshOptimizer::CacheStatistics CacheAfter = MeshOptimizer::AnalyzeVertexCache(IndicesAfter.data(), IndicesAfter.size(), ParallelModel->vertexCount);
+
+        // The first load cooks the file, the timed ones map it
+        ObjModelLoader::LoadSettings CachedSettings;
+        ObjModelLoader(FilePath, CachedSettings).Load().get();
+        const double CachedLoadMs = BestOf(Iterations, [&]() { CachedModel = ObjModelLoader(FilePath, CachedSettings).Load().get(); });
+
+        std::cout << FilePath << std::endl;
+        std::cout << "  corners        : " << HashIndices.size() << std::endl;
+        std::cout << "  tinyobj parse  : " << ParseMs << " ms (first run)" << std::endl;
+        std::cout << "  float parse    : " << MisroundedCount << " of " << ParsedValueCount << " values differ from strtof" << std::endl;
+        std::cout << "  parse ifstream : " << StreamParseMs << " ms" << std::endl;
+        std::cout << "  parse mmap     : " << MappedParseMs << " ms" << std::endl;
+        std::cout << "  weld std::map  : " << MapMs << " ms (" << MapVertexCount << " vertices)" << std::endl;
+        std::cout << "  weld hash      : " << HashMs << " ms (" << HashVertexCount << " vertices)" << std::endl;
+        std::cout << "  weld speedup   : " << MapMs / HashMs << "x" << std::endl;
+        std::cout << "  load serial    : " << SerialLoadMs << " ms" << std::endl;
+        std::cout << "  load parallel  : " << ParallelLoadMs << " ms (" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+        std::cout << "  load streaming : " << StreamingLoadMs << " ms" << std::endl;
+        std::cout << "  peak memory    : serial " << Memory.Serial << " KB, parallel " << Memory.Parallel << " KB, streaming " << Memory.Streaming
+            << " KB (model " << Memory.ModelBytes / 1024 << " KB)" << std::endl;
+        std::cout << "  load cached    : " << CachedLoadMs << " ms" << std::endl;
+        std::cout << "  optimize cost  : " << ParallelLoadMs - UnoptimizedLoadMs << " ms" << std::endl;
+        std::cout << "  ACMR           : " << CacheBefore.Acmr << " -> " << CacheAfter.Acmr << " (LOD 0, FIFO 16)" << std::endl;
+        std::cout << "  ATVR           : " << CacheBefore.Atvr << " -> " << CacheAfter.Atvr << " (LOD 0)" << std::endl;
+        std::cout << "  load compact   : " << CompactLoadMs << " ms" << std::endl;
+        std::cout << "  vertex buffer  : " << ParallelModel->vertices.size() << " bytes, compact " << CompactModel->vertices.size() << " bytes ("
+            << 100.0 * CompactModel->vertices.size() / ParallelModel->vertices.size() << "%)" << std::endl;
+        std::cout << "  position error : " << MaxPositionError(*ParallelModel, *CompactModel) << " (compact, max)" << std::endl;
+        const MeshBounds& Bounds = ParallelModel->bounds;
+        const Pandu::Vector3 HalfExtents = Bounds.Box.GetHalfExtents();
+        std::cout << "  bounds         : box half extents " << HalfExtents.x << " " << HalfExtents.y << " " << HalfExtents.z
+            << ", sphere radius " << Bounds.Sphere.GetRadius() << " (box corner " << HalfExtents.Length() << "), "
+            << ParallelModel->submeshes.size() << " submeshes, " << ParallelModel->materials.size() << " materials" << std::endl;
+        std::cout << "  index buffer   : " << ParallelModel->indexData.size() << " bytes (" << ObjModelLoader::ModelData::GetIndexSize(ParallelModel->indexFormat) * 8 << " bit)"
+            << ", without LODs " << NoLodModel->indexData.size() << " bytes" << std::endl;
+        PrintMeshletStatistics(*ParallelModel);
+        std::cout << "  LOD cost       : " << ParallelLoadMs - NoLodLoadMs << " ms" << std::endl;
+        for (const ObjModelLoader::ModelData::Submesh& Submesh : ParallelModel->submeshes)
+        {
+            std::cout << "  LOD 0          : " << Submesh.indexCount / 3 << " triangles" << std::endl;
+            for (size_t l = 0; l < Submesh.lods.size(); l++)
+            {
+                std::cout << "  LOD " << l + 1 << "          : " << Submesh.lods[l].indexCount / 3 << " triangles, error " << Submesh.lods[l].error
+                    << " (" << 100.0f * Submesh.lods[l].error / ParallelModel->bounds.Sphere.GetRadius() << "% of radius)" << std::endl;
+            }
+        }
+
+#ifdef TINYOBJLOADER_USE_FAST_PARSE
+        if (MisroundedCount != 0)
+        {
+            std::cerr << "  MISMATCH between the fast number parser and strtof" << std::endl;
+            return false;
+        }
+#endif
+
+        if (MapVertexCount != HashVertexCount || MapIndices != HashIndices)
+        {
+            std::cerr << "  MISMATCH between std::map and hash welding" << std::endl;
+            return false;
+        }
+
+        if (!SameModel(SerialModel.get(), ParallelModel.get()))
+        {
+            std::cerr << "  MISMATCH between serial and parallel parse" << std::endl;
+            return false;
+        }
+
+        if (!SameModel(ParallelModel.get(), StreamingModel.get()))
+        {
+            std::cerr << "  MISMATCH between parallel and streaming parse" << std::endl;
+            return false;
+        }
+
+        if (!SameModel(ParallelModel.get(), CachedModel.get()))
+        {
+            std::cerr << "  MISMATCH between parsed and cached model" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string WriteObjText(const std::string& Name, const std::string& Text)
+    {
+        const std::filesystem::path Directory = std::filesystem::temp_directory_path() / "LoaderBenchmark";
+        std::error_code Error;
+        std::filesystem::create_directories(Directory, Error);
+
+        const std::string FilePath = (Directory / Name).string();
+        std::ofstream ofs(FilePath);
+        ofs << Text;
+        return FilePath;
+    }
+
+    std::unique_ptr<const ObjModelLoader::ModelData> LoadObjText(const std::string& Name, const std::string& Text, ObjModelLoader::LoadSettings Settings = ObjModelLoader::LoadSettings())
+    {
+        const std::string FilePath = WriteObjText(Name, Text);
+
+        Settings.UseMeshCache = false;
+        Settings.PreferCooked = false;
+        std::unique_ptr<const ObjModelLoader::ModelData> Model = ObjModelLoader(FilePath, Settings).LoadNow();
+
+        std::error_code Error;
+        std::filesystem::remove(FilePath, Error);
+        return Model;
+    }
+
+    // Small files that once went wrong in the loader, checked on every run
+    bool RunEdgeCaseChecks()
+    {
+        bool Success = true;
+
+        // Too small to simplify, must not get LODs that repeat the full detail triangles
+        const std::string QuadText = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n";
+        std::unique_ptr<const ObjModelLoader::ModelData> Quad = LoadObjText("quad.obj", QuadText);
+        if (!Quad || Quad->indexCount != 6 || Quad->submeshes.size() != 1 || !Quad->submeshes[0].lods.empty())
+        {
+            std::cerr << "  MISMATCH tiny submesh got LODs that did not shrink" << std::endl;
+            Success = false;
+        }
+
+        // A face past the last position and no vn records, the generated normals must not read past the positions
+        if (LoadObjText("face_out_of_range.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 9\nf 1 2 3\n"))
+        {
+            std::cerr << "  MISMATCH face past the last position loaded" << std::endl;
+            Success = false;
+        }
+
+        // Meshlets change the draws, the mesh registry must not hand a load without them the mesh of a load with them
+        ObjModelLoader::LoadSettings NoMeshletSettings;
+        NoMeshletSettings.BuildMeshlets = false;
+        std::unique_ptr<const ObjModelLoader::ModelData> WithMeshlets = LoadObjText("meshlets.obj", QuadText);
+        std::unique_ptr<const ObjModelLoader::ModelData> WithoutMeshlets = LoadObjText("meshlets.obj", QuadText, NoMeshletSettings);
+        if (!WithMeshlets || !WithoutMeshlets || WithMeshlets->submeshes[0].meshlets.empty() || WithMeshlets->contentHash == WithoutMeshlets->contentHash)
+        {
+            std::cerr << "  MISMATCH loads with and without meshlets hash equal" << std::endl;
+            Success = false;
+        }
+
+        std::cout << "edge cases : " << (Success ? "ok" : "FAILED") << std::endl;
+        return Success;
+    }
+
+    // Polls Done for up to ten seconds
+    template <typename DoneType>
+    bool WaitFor(DoneType&& Done)
+    {
+        const Clock::time_point Start = Clock::now();
+        while (!Done())
+        {
+            if (ElapsedMs(Start) > 10000.0)
+                return false;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // Cancels in every state a request goes through. A cancelled result must never come out of the queue and its memory
+    // has to leave the budget. LargeFile loads long enough to be cancelled while it runs.
+    bool RunQueueChecks(const std::string& LargeFile)
+    {
+        bool Success = true;
+        auto Check = [&Success](bool Condition, const char* Message)
+        {
+            if (!Condition)
+            {
+                std::cerr << "  MISMATCH " << Message << std::endl;
+                Success = false;
+            }
+        };
+
+        const std::string FilePath = WriteObjText("queue.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\n");
+        ObjModelLoader::LoadSettings Settings;
+        Settings.UseMeshCache = false;
+        Settings.PreferCooked = false;
+
+        // With a budget of one byte the uncollected model of the first request keeps the second one waiting
+        ModelLoadQueue::Settings QueueSettings;
+        QueueSettings.WorkerCount = 1;
+        QueueSettings.MemoryBudget = 1;
+        ModelLoadQueue Queue(QueueSettings);
+
+        std::vector<ModelLoadQueue::RequestId> Collected;
+        auto Collect = [&]()
+        {
+            std::vector<ModelLoadQueue::Result> Finished;
+            Queue.CollectFinished(Finished);
+            for (const ModelLoadQueue::Result& Loaded : Finished)
+            {
+                Collected.push_back(Loaded.Id);
+            }
+        };
+
+        const ModelLoadQueue::RequestId Finished = Queue.Request(FilePath, Settings);
+        const ModelLoadQueue::RequestId Waiting = Queue.Request(FilePath, Settings);
+        Check(WaitFor([&]() { return Queue.GetState(Finished) == ModelLoadQueue::RequestState::Finished; }), "first queue request never finished");
+
+        Check(Queue.GetState(Waiting) == ModelLoadQueue::RequestState::Waiting, "second queue request started over budget");
+        Check(Queue.Cancel(Waiting) && Queue.GetState(Waiting) == ModelLoadQueue::RequestState::Unknown, "waiting queue request was not cancelled");
+
+        Check(Queue.Cancel(Finished) && Queue.GetState(Finished) == ModelLoadQueue::RequestState::Unknown, "finished queue request was not cancelled");
+        Check(Queue.GetMemoryInUse() == 0 && Queue.GetRequestCount() == 0, "cancelled finished request kept its memory");
+
+        const ModelLoadQueue::RequestId Running = Queue.Request(LargeFile, Settings);
+        Check(WaitFor([&]() { return Queue.GetState(Running) != ModelLoadQueue::RequestState::Waiting; }), "large queue request never started");
+        Check(Queue.Cancel(Running), "running queue request was not cancelled");
+        Check(WaitFor([&]() { return Queue.GetRequestCount() == 0; }), "cancelled running request never completed");
+        Check(Queue.GetMemoryInUse() == 0, "cancelled running request kept its memory");
+
+        Collect();
+        Check(Collected.empty(), "cancelled request came out of the queue");
+        Check(!Queue.Cancel(Running), "cancelled request could be cancelled again");
+
+        std::error_code Error;
+        std::filesystem::remove(FilePath, Error);
+
+        std::cout << "load queue : " << (Success ? "ok" : "FAILED") << std::endl;
+        return Success;
+    }
+
+    // Requests, cancels and resolves of the mesh registry against a real load queue
+    bool RunRegistryChecks()
+    {
+        bool Success = true;
+
+        const std::string FilePath = WriteObjText("registry.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\n");
+        ObjModelLoader::LoadSettings Settings;
+        Settings.UseMeshCache = false;
+        Settings.PreferCooked = false;
+
+        ModelLoadQueue Queue;
+        MeshRegistry<int> Registry;
+        std::shared_ptr<int> Mesh;
+
+        // The load stays until its last waiter leaves, a cancelled key has to start a new load on the next request
+        const ModelLoadQueue::RequestId First = Registry.Request(Queue, FilePath, Settings, 0.0f, Mesh);
+        const ModelLoadQueue::RequestId Joined = Registry.Request(Queue, FilePath, Settings, 0.0f, Mesh);
+        if (First == ModelLoadQueue::INVALID_REQUEST || Joined != First || !Registry.Cancel(Queue, First) || !Registry.Cancel(Queue, First)
+            || Registry.Cancel(Queue, First))
+        {
+            std::cerr << "  MISMATCH registry did not count the waiters of a load" << std::endl;
+            Success = false;
+        }
+
+        const ModelLoadQueue::RequestId Second = Registry.Request(Queue, FilePath, Settings, 0.0f, Mesh);
+        if (Second == ModelLoadQueue::INVALID_REQUEST || Second == First)
+        {
+            std::cerr << "  MISMATCH registry joined a cancelled load" << std::endl;
+            Success = false;
+        }
+
+        bool Resolved = false;
+        WaitFor([&]()
+        {
+            std::vector<ModelLoadQueue::Result> Finished;
+            Queue.CollectFinished(Finished);
+            for (const ModelLoadQueue::Result& Loaded : Finished)
+            {
+                if (Loaded.Id == First)
+                {
+                    std::cerr << "  MISMATCH cancelled load came out of the queue" << std::endl;
+                    Success = false;
+                }
+
+                Mesh = Registry.Resolve(Loaded, [](const ObjModelLoader::ModelData&) { return std::make_shared<int>(1); });
+                Resolved = Resolved || (Loaded.Id == Second && Mesh);
+            }
+            return Resolved;
+        });
+
+        if (!Resolved)
+        {
+            std::cerr << "  MISMATCH request after a cancel never resolved" << std::endl;
+            Success = false;
+        }
+
+        std::error_code Error;
+        std::filesystem::remove(FilePath, Error);
+
+        std::cout << "registry   : " << (Success ? "ok" : "FAILED") << std::endl;
+        return Success;
+    }
+
+    // Loads every file Copies times the way a scene full of assets would, each model is dropped as soon as it arrives
+    // like it would be after its upload. One Load per model at once, against the load queue.
+    void RunSceneBenchmark(const std::vector<std::string>& Files, int Copies)
+    {
+        ObjModelLoader::LoadSettings Settings;
+        Settings.UseMeshCache = false;
+        Settings.PreferCooked = false;
+
+        ModelLoadQueue::Settings QueueSettings;
+        QueueSettings.MemoryBudget = 64ull * 1024 * 1024;
+
+        const size_t ModelCount = Files.size() * static_cast<size_t>(Copies);
+
+        long AsyncMs = 0;
+        const long AsyncPeakKb = MeasureChildPeakKb([&]()
+        {
+            const auto Start = std::chrono::high_resolution_clock::now();
+
+            std::vector<std::future<std::unique_ptr<const ObjModelLoader::ModelData>>> Futures;
+            for (int c = 0; c < Copies; c++)
+            {
+                for (const std::string& File : Files)
+                {
+                    Futures.push_back(ObjModelLoader(File, Settings).Load());
+                }
+            }
+            for (auto& Future : Futures)
+            {
+                Future.get();
+            }
+
+            return static_cast<long>(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count());
+        }, &AsyncMs);
+
+        long QueueMs = 0;
+        const long QueuePeakKb = MeasureChildPeakKb([&]()
+        {
+            const auto Start = std::chrono::high_resolution_clock::now();
+
+            ModelLoadQueue Queue(QueueSettings);
+            for (int c = 0; c < Copies; c++)
+            {
+                for (const std::string& File : Files)
+                {
+                    Queue.Request(File, Settings);
+                }
+            }
+
+            std::vector<ModelLoadQueue::Result> Finished;
+            while (Queue.GetRequestCount() > 0)
+            {
+                Queue.CollectFinished(Finished);
+                Finished.clear();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            return static_cast<long>(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count());
+        }, &QueueMs);
+
+        std::cout << "scene of " << ModelCount << " models" << std::endl;
+        std::cout << "  async per load : " << AsyncMs << " ms, peak memory " << AsyncPeakKb << " KB" << std::endl;
+        std::cout << "  load queue     : " << QueueMs << " ms, peak memory " << QueuePeakKb << " KB (" << QueueSettings.WorkerCount << " workers, "
+            << QueueSettings.MemoryBudget / (1024 * 1024) << " MB budget)" << std::endl;
+    }
+
+    // Writes Copies copies of the mesh in FilePath side by side into OutPath, each moved past the previous one along x so
+    // nothing welds across copies. Materials are left out.
+    bool WriteSyntheticObj(const std::string& FilePath, int Copies, const std::string& OutPath)
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::string warn, err;
+        if (!tinyobj::LoadObj(&attrib, &shapes, nullptr, &warn, &err, FilePath.c_str()))
+        {
+            std::cerr << "Parse failed " << FilePath << " : " << err << std::endl;
+            return false;
+        }
+
+        float MinX = 0.0f, MaxX = 0.0f;
+        for (size_t i = 0; i < attrib.vertices.size(); i += 3)
+        {
+            MinX = i == 0 ? attrib.vertices[i] : std::min(MinX, attrib.vertices[i]);
+            MaxX = i == 0 ? attrib.vertices[i] : std::max(MaxX, attrib.vertices[i]);
+        }
+        const float Step = MaxX > MinX ? (MaxX - MinX) * 1.1f : 1.0f;
+
+        std::ofstream ofs(OutPath);
+        if (!ofs)
+        {
+            std::cerr << "Could not write " << OutPath << std::endl;
+            return false;
+        }
+        ofs << std::setprecision(7);
+
+        const size_t VertexCount = attrib.vertices.size() / 3;
+        const size_t NormalCount = attrib.normals.size() / 3;
+        const size_t TexcoordCount = attrib.texcoords.size() / 2;
+
+        for (int c = 0; c < Copies; c++)
+        {
+            for (size_t i = 0; i < VertexCount; i++)
+            {
+                ofs << "v " << attrib.vertices[3 * i] + Step * c << ' ' << attrib.vertices[3 * i + 1] << ' ' << attrib.vertices[3 * i + 2] << '\n';
+            }
+            for (size_t i = 0; i < NormalCount; i++)
+            {
+                ofs << "vn " << attrib.normals[3 * i] << ' ' << attrib.normals[3 * i + 1] << ' ' << attrib.normals[3 * i + 2] << '\n';
+            }
+            for (size_t i = 0; i < TexcoordCount; i++)
+            {
+                ofs << "vt " << attrib.texcoords[2 * i] << ' ' << attrib.texcoords[2 * i + 1] << '\n';
+            }
+
+            for (const tinyobj::shape_t& shape : shapes)
+            {
+                size_t Corner = 0;
+                for (unsigned char FaceCorners : shape.mesh.num_face_vertices)
+                {
+                    ofs << 'f';
+                    for (unsigned char f = 0; f < FaceCorners; f++, Corner++)
+                    {
+                        const tinyobj::index_t& idx = shape.mesh.indices[Corner];
+                        ofs << ' ' << idx.vertex_index + 1 + VertexCount * c;
+                        if (idx.texcoord_index >= 0 || idx.normal_index >= 0)
+                        {
+                            ofs << '/';
+                            if (idx.texcoord_index >= 0)
+                                ofs << idx.texcoord_index + 1 + TexcoordCount * c;
+                        }
+                        if (idx.normal_index >= 0)
+                        {
+                            ofs << '/' << idx.normal_index + 1 + NormalCount * c;
+                        }
+                    }
+                    ofs << '\n';
+                }
+            }
+        }
+
+        return static_cast<bool>(ofs);
+    }
+
+    std::string JsonString(const std::string& Value)
+    {
+        std::string Quoted = "\"";
+        for (char c : Value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                Quoted += '\\';
+            }
+            Quoted += c;
+        }
+        return Quoted + "\"";
+    }
+
+    struct SuiteFile
+    {
+        std::string Name;
+        std::string FilePath;
+        int Copies = 1;
+        long PeakKb = 0;
+    };
+
+    // Times every stage of the full loader on every file plus synthetic copies scaled up by each of Scales, and writes
+    // throughput and peak memory as JSON to Out. The mesh cache stays out of it, every load parses.
+    bool RunSuite(const std::vector<std::string>& Files, const std::vector<int>& Scales, int Iterations, std::ostream& Out)
+    {
+        ObjModelLoader::LoadSettings Settings;
+        Settings.UseMeshCache = false;
+        Settings.PreferCooked = false;
+
+        const std::filesystem::path SyntheticDirectory = std::filesystem::temp_directory_path() / "LoaderBenchmark";
+        std::error_code Error;
+        std::filesystem::create_directories(SyntheticDirectory, Error);
+
+        // Written in children too, so this process' heap stays small for the peak memory measurements
+        std::vector<SuiteFile> SuiteFiles;
+        for (const std::string& File : Files)
+        {
+            const std::string Name = std::filesystem::path(File).filename().string();
+            SuiteFiles.push_back({ Name, File });
+
+            for (int Scale : Scales)
+            {
+                SuiteFile Synthetic;
+                Synthetic.Name = std::filesystem::path(File).stem().string() + "_x" + std::to_string(Scale) + ".obj";
+                Synthetic.FilePath = (SyntheticDirectory / Synthetic.Name).string();
+                Synthetic.Copies = Scale;
+
+                long Written = 0;
+                MeasureChildPeakKb([&]() { return WriteSyntheticObj(File, Scale, Synthetic.FilePath) ? 1L : 0L; }, &Written);
+                if (Written == 0)
+                {
+                    std::cerr << "Could not write synthetic copies of " << File << std::endl;
+                    return false;
+                }
+                SuiteFiles.push_back(Synthetic);
+            }
+        }
+
+        for (SuiteFile& File : SuiteFiles)
+        {
+            File.PeakKb = MeasureChildPeakKb([&]()
+            {
+                return ObjModelLoader(File.FilePath, Settings).LoadNow() ? 1L : 0L;
+            }, nullptr);
+        }
+
+        bool Success = true;
+
+        Out << "{\n";
+        Out << "  \"threads\": " << std::thread::hardware_concurrency() << ",\n";
+        Out << "  \"iterations\": " << Iterations << ",\n";
+        Out << "  \"files\": [\n";
+
+        for (size_t f = 0; f < SuiteFiles.size(); f++)
+        {
+            const SuiteFile& File = SuiteFiles[f];
+            std::cerr << "timing " << File.Name << std::endl;
+
+            // The stages of the fastest load, the others only add noise from the rest of the machine
+            ObjModelLoader::StageTimings Best;
+            double BestTotalMs = 1e30;
+            uint32_t VertexCount = 0;
+            size_t TriangleCount = 0;
+
+            for (int i = 0; i < Iterations; i++)
+            {
+                ObjModelLoader::StageTimings Timings;
+                std::unique_ptr<const ObjModelLoader::ModelData> Model = ObjModelLoader(File.FilePath, Settings).LoadNow(&Timings);
+                if (!Model)
+                {
+                    std::cerr << "Load failed " << File.FilePath << std::endl;
+                    Success = false;
+                    break;
+                }
+
+                const double TotalMs = Timings.ReadMs + Timings.ParseMs + Timings.WeldMs + Timings.PostProcessMs + Timings.PackMs;
+                if (TotalMs < BestTotalMs)
+                {
+                    Best = Timings;
+                    BestTotalMs = TotalMs;
+                }
+
+                VertexCount = Model->vertexCount;
+                TriangleCount = 0;
+                for (const ObjModelLoader::ModelData::Submesh& Submesh : Model->submeshes)
+                {
+                    TriangleCount += Submesh.indexCount / 3;
+                }
+            }
+
+            if (BestTotalMs == 1e30)
+            {
+                BestTotalMs = 0.0;
+            }
+
+            const uintmax_t SourceBytes = std::filesystem::file_size(File.FilePath, Error);
+            const double Seconds = BestTotalMs / 1000.0;
+
+            Out << "    {\n";
+            Out << "      \"name\": " << JsonString(File.Name) << ",\n";
+            Out << "      \"synthetic_copies\": " << (File.Copies > 1 ? File.Copies : 0) << ",\n";
+            Out << "      \"source_bytes\": " << (Error ? 0 : SourceBytes) << ",\n";
+            Out << "      \"vertices\": " << VertexCount << ",\n";
+            Out << "      \"triangles\": " << TriangleCount << ",\n";
+            Out << "      \"stages_ms\": { \"read\": " << Best.ReadMs << ", \"parse\": " << Best.ParseMs << ", \"weld\": " << Best.WeldMs
+                << ", \"post_process\": " << Best.PostProcessMs << ", \"pack\": " << Best.PackMs << " },\n";
+            Out << "      \"total_ms\": " << BestTotalMs << ",\n";
+            Out << "      \"mb_per_s\": " << (Seconds > 0.0 && !Error ? SourceBytes / (1024.0 * 1024.0) / Seconds : 0.0) << ",\n";
+            Out << "      \"triangles_per_s\": " << (Seconds > 0.0 ? TriangleCount / Seconds : 0.0) << ",\n";
+            Out << "      \"peak_memory_kb\": " << File.PeakKb << "\n";
+            Out << "    }" << (f + 1 < SuiteFiles.size() ? "," : "") << "\n";
+
+            if (File.Copies > 1)
+            {
+                std::filesystem::remove(File.FilePath, Error);
+            }
+        }
+
+        Out << "  ]\n";
+        Out << "}" << std::endl;
+
+        return Success;
+    }
+}
+
+// LoaderBenchmark [--suite [--scale N]... [--out report.json]] [file.obj...]
+// --suite only times the loader stages and reports them as JSON, to stdout without --out. Every --scale adds synthetic
+// files with N copies of each mesh, 8 without any.
+int main(int argc, char** argv)
+{
+    std::vector<std::string> Files;
+    bool Suite = false;
+    std::vector<int> Scales;
+    std::string OutPath;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string Arg = argv[i];
+        if (Arg == "--suite")
+        {
+            Suite = true;
+        }
+        else if (Arg == "--scale" && i + 1 < argc)
+        {
+            Scales.push_back(std::max(2, std::atoi(argv[++i])));
+        }
+        else if (Arg == "--out" && i + 1 < argc)
+        {
+            OutPath = argv[++i];
+        }
+        else
+        {
+            Files.push_back(Arg);
+        }
+    }
+
+    if (Files.empty())
+    {
+        Files.push_back(Paths::GetActualFilePath("assets/smooth_vase.obj"));
+        Files.push_back(Paths::GetActualFilePath("assets/FinalBaseMesh.obj"));
+    }
+
+    if (Suite)
+    {
+        if (Scales.empty())
+        {
+            Scales.push_back(8);
+        }
+
+        if (OutPath.empty())
+        {
+            return RunSuite(Files, Scales, 5, std::cout) ? 0 : 1;
+        }
+
+        std::ofstream Out(OutPath);
+        if (!Out)
+        {
+            std::cerr << "Could not write " << OutPath << std::endl;
+            return 1;
+        }
+        return RunSuite(Files, Scales, 5, Out) ? 0 : 1;
+    }
+
+    // Measured before the benchmarks grow this process' heap
+    std::vector<LoadMemory> Memory;
+    for (const std::string& File : Files)
+    {
+        Memory.push_back(MeasureLoadMemory(File));
+    }
+
+    bool Success = true;
+    for (size_t i = 0; i < Files.size(); i++)
+    {
+        Success = RunWeldBenchmark(Files[i], 5, Memory[i]) && Success;
+    }
+
+    Success = RunEdgeCaseChecks() && Success;
+    Success = RunQueueChecks(Files.front()) && Success;
+    Success = RunRegistryChecks() && Success;
+
+    RunSceneBenchmark(Files, 16);
+
+    std::cout << "peak RSS : " << PeakRssKb() << " KB" << std::endl;
+
+    return Success ? 0 : 1;
+}
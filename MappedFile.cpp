@@ -0,0 +1,199 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__EMSCRIPTEN__)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_Data(nullptr)
+    , m_Size(0)
+    , m_IsOpen(false)
+#if defined(_WIN32)
+    , m_FileHandle(nullptr)
+    , m_MappingHandle(nullptr)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::string& FilePath)
+{
+    Close();
+
+    HANDLE file = CreateFileA(FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_FileHandle = file;
+    m_IsOpen = true;
+
+    // Zero sized files can't be mapped, an empty view is all there is to read
+    if (fileSize.QuadPart == 0)
+    {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+    m_MappingHandle = mapping;
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_Data = static_cast<const char*>(view);
+    m_Size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+    {
+        UnmapViewOfFile(m_Data);
+    }
+    if (m_MappingHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+    }
+    if (m_FileHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(m_FileHandle));
+    }
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_IsOpen = false;
+    m_FileHandle = nullptr;
+    m_MappingHandle = nullptr;
+}
+
+#elif defined(__EMSCRIPTEN__)
+
+bool MappedFile::Open(const std::string& FilePath)
+{
+    Close();
+
+    std::ifstream ifs(FilePath, std::ios::binary | std::ios::ate);
+    if (!ifs)
+    {
+        return false;
+    }
+
+    const std::streamoff fileSize = ifs.tellg();
+    ifs.seekg(0, std::ios::beg);
+
+    m_Buffer.resize(static_cast<size_t>(fileSize > 0 ? fileSize : 0));
+    if (!m_Buffer.empty() && !ifs.read(&m_Buffer[0], m_Buffer.size()))
+    {
+        Close();
+        return false;
+    }
+
+    m_Data = m_Buffer.data();
+    m_Size = m_Buffer.size();
+    m_IsOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    std::string().swap(m_Buffer);
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_IsOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& FilePath)
+{
+    Close();
+
+    const int fd = open(FilePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    const size_t fileSize = static_cast<size_t>(fileStat.st_size);
+    void* view = nullptr;
+    if (fileSize > 0)
+    {
+        view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if (view)
+    {
+        // Parsers walk the file front to back, let the kernel read ahead aggressively
+        madvise(view, fileSize, MADV_SEQUENTIAL);
+    }
+
+    m_Data = static_cast<const char*>(view);
+    m_Size = view ? fileSize : 0;
+    m_IsOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+    {
+        munmap(const_cast<char*>(m_Data), m_Size);
+    }
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_IsOpen = false;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef __MappedFile_h__
+#define __MappedFile_h__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file.
+// Native builds map the file into memory so parsers read the page cache directly, no stream or string copies.
+// Builds without mmap (web) read the file into an owned buffer instead.
+class MappedFile
+{
+public:
+
+	MappedFile();
+	virtual ~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator = (const MappedFile&) = delete;
+
+	// Returns false if the file can't be opened or mapped. An empty file opens with an empty view.
+	bool Open(const std::string& FilePath);
+	void Close();
+
+	bool IsOpen() const { return m_IsOpen; }
+
+	const char* GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Size; }
+	std::string_view GetView() const { return std::string_view(m_Data, m_Size); }
+
+private:
+
+	const char* m_Data;
+	size_t m_Size;
+	bool m_IsOpen;
+
+#if defined(_WIN32)
+	void* m_FileHandle;
+	void* m_MappingHandle;
+#elif defined(__EMSCRIPTEN__)
+	std::string m_Buffer;
+#endif
+};
+
+#endif //__MappedFile_h__
@@ -0,0 +1,798 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr char CACHE_MAGIC[8] = { 'P', 'M', 'E', 'S', 'H', '\0', '\r', '\n' };
+    constexpr char COOKED_MAGIC[8] = { 'P', 'C', 'O', 'O', 'K', '\0', '\r', '\n' };
+
+    enum SectionType : uint32_t
+    {
+        SECTION_VERTEX_LAYOUT = 1,
+        SECTION_VERTICES = 2,
+        SECTION_INDICES = 3,
+        SECTION_QUANTIZATION = 4,
+        SECTION_BOUNDS = 5,
+        SECTION_SUBMESHES = 6,
+        SECTION_LODS = 7,
+        SECTION_MESHLETS = 8,
+        SECTION_MATERIALS = 9,
+        SECTION_STRINGS = 10,
+    };
+
+    // One entry of the vertex layout section, offsets are recomputed on read so a damaged file can't produce a bad layout
+    struct LayoutEntry
+    {
+        uint8_t Semantic;
+        uint8_t Format;
+        uint16_t Offset;
+        uint32_t ShaderLocation;
+    };
+
+    struct BoundsEntry
+    {
+        float BoxMin[3];
+        float BoxMax[3];
+        float SphereCenter[3];
+        float SphereRadius;
+    };
+
+    struct SubmeshEntry
+    {
+        uint32_t FirstIndex;
+        uint32_t IndexCount;
+        BoundsEntry Bounds;
+        int32_t MaterialIndex;
+        uint32_t Reserved;
+    };
+
+    // Names point into the strings section
+    struct MaterialEntry
+    {
+        float Diffuse[3];
+        float Opacity;
+        uint32_t NameOffset;
+        uint32_t NameLength;
+        uint32_t TextureOffset;
+        uint32_t TextureLength;
+    };
+
+    // LOD levels of every submesh, grouped by submesh and ordered fine to coarse
+    struct LodEntry
+    {
+        uint32_t Submesh;
+        uint32_t FirstIndex;
+        uint32_t IndexCount;
+        float Error;
+    };
+
+    // Meshlets of every submesh, grouped by submesh in index buffer order
+    struct MeshletEntry
+    {
+        uint32_t Submesh;
+        uint32_t FirstIndex;
+        uint32_t IndexCount;
+        float SphereCenter[3];
+        float SphereRadius;
+        float ConeApex[3];
+        float ConeAxis[3];
+        float ConeCutoff;
+    };
+
+    struct FileHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t SectionCount;
+        uint64_t SourceSize;
+
+        // Modification time of the source and the .mtl files it names, from GetSourceStamp
+        uint64_t SourceStamp;
+
+        // Cooked files only, hash of the source and its .mtl files for when the stamp no longer matches
+        uint64_t SourceHash;
+        uint64_t SettingsKey;
+
+        // ModelData::contentHash, stored so reading a file never has to hash the model again
+        uint64_t ContentHash;
+        uint32_t SourcePathLength;
+
+        // '\n' separated mtllib names stored after the source path, relative to the source so the files stay valid
+        // whatever directory they are read or cooked from
+        uint32_t MaterialNamesLength;
+    };
+
+    struct SectionEntry
+    {
+        uint32_t Type;
+        uint32_t ElementSize;
+        uint64_t Offset;
+        uint64_t Count;
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "FileHeader layout is part of the file format");
+    static_assert(sizeof(SectionEntry) == 24, "SectionEntry layout is part of the file format");
+    static_assert(sizeof(VertexPacker::Quantization) == 6 * sizeof(float), "Quantization is written to the file as is");
+    static_assert(sizeof(LayoutEntry) == 8, "LayoutEntry layout is part of the file format");
+    static_assert(sizeof(BoundsEntry) == 40, "BoundsEntry layout is part of the file format");
+    static_assert(sizeof(SubmeshEntry) == 56, "SubmeshEntry layout is part of the file format");
+    static_assert(sizeof(MaterialEntry) == 32, "MaterialEntry layout is part of the file format");
+    static_assert(sizeof(LodEntry) == 16, "LodEntry layout is part of the file format");
+    static_assert(sizeof(MeshletEntry) == 56, "MeshletEntry layout is part of the file format");
+
+    uint64_t AlignUp(uint64_t Value)
+    {
+        return (Value + MeshCache::SECTION_ALIGNMENT - 1) & ~(MeshCache::SECTION_ALIGNMENT - 1);
+    }
+
+    BoundsEntry ToBoundsEntry(const MeshBounds& Bounds)
+    {
+        const Pandu::Vector3& boxMin = Bounds.Box.GetMin();
+        const Pandu::Vector3& boxMax = Bounds.Box.GetMax();
+        const Pandu::Vector3& center = Bounds.Sphere.GetCenter();
+        return { { boxMin.x, boxMin.y, boxMin.z }, { boxMax.x, boxMax.y, boxMax.z }, { center.x, center.y, center.z }, Bounds.Sphere.GetRadius() };
+    }
+
+    MeshBounds FromBoundsEntry(const BoundsEntry& Entry)
+    {
+        MeshBounds bounds;
+        bounds.Box = Pandu::AxisAlignedBox3(Pandu::Vector3(Entry.BoxMin[0], Entry.BoxMin[1], Entry.BoxMin[2]), Pandu::Vector3(Entry.BoxMax[0], Entry.BoxMax[1], Entry.BoxMax[2]));
+        bounds.Sphere = Pandu::Sphere(Pandu::Vector3(Entry.SphereCenter[0], Entry.SphereCenter[1], Entry.SphereCenter[2]), Entry.SphereRadius);
+        return bounds;
+    }
+
+    // Calls Callback with every name on the mtllib lines of an .obj, in order
+    template <typename CallbackType>
+    void ForEachMaterialLib(std::string_view Text, CallbackType&& Callback)
+    {
+        for (size_t lineStart = 0; lineStart < Text.size(); )
+        {
+            size_t lineEnd = Text.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos)
+            {
+                lineEnd = Text.size();
+            }
+
+            std::string_view line = Text.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+
+            line.remove_prefix(std::min(line.size(), line.find_first_not_of(" \t")));
+            if (line.size() < 7 || line.compare(0, 6, "mtllib") != 0 || (line[6] != ' ' && line[6] != '\t'))
+                continue;
+
+            line.remove_prefix(6);
+            while (!line.empty())
+            {
+                const size_t nameStart = line.find_first_not_of(" \t\r");
+                if (nameStart == std::string_view::npos)
+                    break;
+
+                line.remove_prefix(nameStart);
+                const size_t nameLength = std::min(line.size(), line.find_first_of(" \t\r"));
+                Callback(std::string(line.substr(0, nameLength)));
+                line.remove_prefix(nameLength);
+            }
+        }
+    }
+
+    // mtllib names are relative to the .obj, like tinyobj::MaterialFileReader reads them
+    std::string GetSourceDirectory(const std::string& SourcePath)
+    {
+        const size_t separator = SourcePath.find_last_of("/\\");
+        return separator != std::string::npos ? SourcePath.substr(0, separator + 1) : std::string();
+    }
+
+    // '\n' separated names of the .mtl files the source's mtllib lines name, empty when it can't be read
+    std::string GetMaterialNames(const std::string& SourcePath)
+    {
+        MappedFile source;
+        if (!source.Open(SourcePath))
+        {
+            return std::string();
+        }
+
+        std::string names;
+        ForEachMaterialLib(source.GetView(), [&](const std::string& Name)
+        {
+            if (!names.empty())
+            {
+                names += '\n';
+            }
+            names += Name;
+        });
+        return names;
+    }
+
+    // Size of the source, and its modification time folded together with the size and modification time of every .mtl file
+    // in MaterialNames, so an edit to either invalidates the cache. The names are relative to the source.
+    bool GetSourceStamp(const std::string& SourcePath, std::string_view MaterialNames, uint64_t& OutSize, uint64_t& OutTime)
+    {
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(SourcePath, error);
+        if (error)
+        {
+            return false;
+        }
+
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(SourcePath, error);
+        if (error)
+        {
+            return false;
+        }
+
+        uint64_t stamp = 0xcbf29ce484222325ull;
+        auto HashValue = [&stamp](uint64_t Value)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                stamp = (stamp ^ ((Value >> (i * 8)) & 0xff)) * 0x100000001b3ull;
+            }
+        };
+        HashValue(static_cast<uint64_t>(time.time_since_epoch().count()));
+
+        const std::string directory = GetSourceDirectory(SourcePath);
+        while (!MaterialNames.empty())
+        {
+            const size_t nameLength = std::min(MaterialNames.size(), MaterialNames.find('\n'));
+            const std::string path = directory + std::string(MaterialNames.substr(0, nameLength));
+            MaterialNames.remove_prefix(std::min(MaterialNames.size(), nameLength + 1));
+
+            // A missing .mtl folds in as zero, creating it later changes the stamp
+            const std::uintmax_t materialSize = std::filesystem::file_size(path, error);
+            HashValue(error ? 0 : static_cast<uint64_t>(materialSize));
+            const std::filesystem::file_time_type materialTime = std::filesystem::last_write_time(path, error);
+            HashValue(error ? 0 : static_cast<uint64_t>(materialTime.time_since_epoch().count()));
+        }
+
+        OutSize = static_cast<uint64_t>(size);
+        OutTime = stamp;
+        return true;
+    }
+
+    bool GetSectionBytes(const char* Data, size_t Size, const SectionEntry* Sections, uint32_t SectionCount, uint32_t Type, uint32_t& OutElementSize, ArrayView<uint8_t>& OutView)
+    {
+        for (uint32_t i = 0; i < SectionCount; i++)
+        {
+            const SectionEntry& section = Sections[i];
+            if (section.Type != Type)
+                continue;
+
+            if (section.ElementSize == 0 || section.Offset % MeshCache::SECTION_ALIGNMENT != 0)
+                return false;
+
+            if (section.Offset > Size || section.Count > (Size - section.Offset) / section.ElementSize)
+                return false;
+
+            OutElementSize = section.ElementSize;
+            OutView = ArrayView<uint8_t>(reinterpret_cast<const uint8_t*>(Data + section.Offset), static_cast<size_t>(section.Count * section.ElementSize));
+            return true;
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    bool GetSection(const char* Data, size_t Size, const SectionEntry* Sections, uint32_t SectionCount, uint32_t Type, ArrayView<T>& OutView)
+    {
+        uint32_t elementSize = 0;
+        ArrayView<uint8_t> bytes;
+        if (!GetSectionBytes(Data, Size, Sections, SectionCount, Type, elementSize, bytes) || elementSize != sizeof(T))
+            return false;
+
+        OutView = ArrayView<T>(reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T));
+        return true;
+    }
+
+    // Magic, version and that the section table, the source path and the material names fit into Size
+    bool ReadHeader(const char* Data, size_t Size, const char (&Magic)[8], FileHeader& OutHeader)
+    {
+        if (Size < sizeof(FileHeader))
+            return false;
+
+        memcpy(&OutHeader, Data, sizeof(FileHeader));
+        if (memcmp(OutHeader.Magic, Magic, sizeof(Magic)) != 0 || OutHeader.Version != MeshCache::FORMAT_VERSION)
+            return false;
+
+        const uint64_t tableSize = static_cast<uint64_t>(OutHeader.SectionCount) * sizeof(SectionEntry);
+        return sizeof(FileHeader) + tableSize + static_cast<uint64_t>(OutHeader.SourcePathLength) + OutHeader.MaterialNamesLength <= Size;
+    }
+
+    // Model over the sections of a file ReadHeader accepted, its views point into Data and the caller sets the storage
+    std::unique_ptr<ObjModelLoader::ModelData> ReadSections(const char* Data, size_t Size, const FileHeader& Header)
+    {
+        std::vector<SectionEntry> sections(Header.SectionCount);
+        if (!sections.empty())
+        {
+            memcpy(sections.data(), Data + sizeof(FileHeader), sections.size() * sizeof(SectionEntry));
+        }
+
+        auto model = std::make_unique<ObjModelLoader::ModelData>();
+        model->contentHash = Header.ContentHash;
+        ArrayView<LayoutEntry> layoutEntries;
+        ArrayView<VertexPacker::Quantization> quantization;
+        ArrayView<BoundsEntry> bounds;
+        ArrayView<SubmeshEntry> submeshes;
+        ArrayView<LodEntry> lods;
+        ArrayView<MeshletEntry> meshlets;
+        ArrayView<MaterialEntry> materials;
+        ArrayView<char> strings;
+        uint32_t indexSize = 0;
+        if (!GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_VERTEX_LAYOUT, layoutEntries)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_QUANTIZATION, quantization)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_BOUNDS, bounds)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_SUBMESHES, submeshes)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_LODS, lods)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_MESHLETS, meshlets)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_MATERIALS, materials)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_STRINGS, strings)
+            || !GetSection(Data, Size, sections.data(), Header.SectionCount, SECTION_VERTICES, model->vertices)
+            || !GetSectionBytes(Data, Size, sections.data(), Header.SectionCount, SECTION_INDICES, indexSize, model->indexData))
+        {
+            return nullptr;
+        }
+
+        if ((indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) || quantization.size() != 1 || bounds.size() != 1)
+        {
+            return nullptr;
+        }
+
+        model->quantization = quantization[0];
+        model->bounds = FromBoundsEntry(bounds[0]);
+
+        model->indexFormat = indexSize == sizeof(uint16_t) ? ObjModelLoader::ModelData::IndexFormat::Uint16 : ObjModelLoader::ModelData::IndexFormat::Uint32;
+        model->indexCount = static_cast<uint32_t>(model->indexData.size() / indexSize);
+
+        if (layoutEntries.empty() || layoutEntries.size() > VertexLayout::MAX_ATTRIBUTES)
+        {
+            return nullptr;
+        }
+
+        for (const LayoutEntry& entry : layoutEntries)
+        {
+            if (entry.Semantic > static_cast<uint8_t>(VertexLayout::Semantic::Tangent) || entry.Format > static_cast<uint8_t>(VertexLayout::Format::Float16x4))
+                return nullptr;
+
+            model->layout.AddAttribute(static_cast<VertexLayout::Semantic>(entry.Semantic), static_cast<VertexLayout::Format>(entry.Format), entry.ShaderLocation);
+            if (model->layout.GetAttribute(model->layout.GetAttributeCount() - 1).Offset != entry.Offset)
+                return nullptr;
+        }
+
+        const uint32_t stride = model->layout.GetStride();
+        if (model->vertices.size() % stride != 0)
+        {
+            return nullptr;
+        }
+
+        model->vertexCount = static_cast<uint32_t>(model->vertices.size() / stride);
+
+        model->materials.resize(materials.size());
+        for (size_t i = 0; i < materials.size(); i++)
+        {
+            const MaterialEntry& entry = materials[i];
+            if (static_cast<uint64_t>(entry.NameOffset) + entry.NameLength > strings.size()
+                || static_cast<uint64_t>(entry.TextureOffset) + entry.TextureLength > strings.size())
+                return nullptr;
+
+            ObjModelLoader::ModelData::Material& material = model->materials[i];
+            material.name.assign(strings.data() + entry.NameOffset, entry.NameLength);
+            std::copy(entry.Diffuse, entry.Diffuse + 3, material.diffuse);
+            material.opacity = entry.Opacity;
+            material.diffuseTexture.assign(strings.data() + entry.TextureOffset, entry.TextureLength);
+        }
+
+        model->submeshes.resize(submeshes.size());
+        for (size_t i = 0; i < submeshes.size(); i++)
+        {
+            const SubmeshEntry& entry = submeshes[i];
+            if (static_cast<uint64_t>(entry.FirstIndex) + entry.IndexCount > model->indexCount
+                || entry.MaterialIndex < -1 || entry.MaterialIndex >= static_cast<int64_t>(model->materials.size()))
+                return nullptr;
+
+            model->submeshes[i].firstIndex = entry.FirstIndex;
+            model->submeshes[i].indexCount = entry.IndexCount;
+            model->submeshes[i].bounds = FromBoundsEntry(entry.Bounds);
+            model->submeshes[i].materialIndex = entry.MaterialIndex;
+        }
+
+        for (const LodEntry& entry : lods)
+        {
+            if (entry.Submesh >= model->submeshes.size() || static_cast<uint64_t>(entry.FirstIndex) + entry.IndexCount > model->indexCount)
+                return nullptr;
+
+            ObjModelLoader::ModelData::Lod lod;
+            lod.firstIndex = entry.FirstIndex;
+            lod.indexCount = entry.IndexCount;
+            lod.error = entry.Error;
+            model->submeshes[entry.Submesh].lods.push_back(lod);
+        }
+
+        for (const MeshletEntry& entry : meshlets)
+        {
+            if (entry.Submesh >= model->submeshes.size() || static_cast<uint64_t>(entry.FirstIndex) + entry.IndexCount > model->indexCount)
+                return nullptr;
+
+            Meshlet meshlet;
+            meshlet.FirstIndex = entry.FirstIndex;
+            meshlet.IndexCount = entry.IndexCount;
+            meshlet.Bounds = Pandu::Sphere(Pandu::Vector3(entry.SphereCenter[0], entry.SphereCenter[1], entry.SphereCenter[2]), entry.SphereRadius);
+            meshlet.ConeApex = Pandu::Vector3(entry.ConeApex[0], entry.ConeApex[1], entry.ConeApex[2]);
+            meshlet.ConeAxis = Pandu::Vector3(entry.ConeAxis[0], entry.ConeAxis[1], entry.ConeAxis[2]);
+            meshlet.ConeCutoff = entry.ConeCutoff;
+            model->submeshes[entry.Submesh].meshlets.push_back(meshlet);
+        }
+
+        for (uint32_t i = 0; i < model->indexCount; i++)
+        {
+            if (model->GetIndex(i) >= model->vertexCount)
+                return nullptr;
+        }
+
+        return model;
+    }
+
+    // Header gets everything but the magic, the settings key, the source stamp and the source hash filled in
+    bool WriteFile(const std::string& OutPath, FileHeader& Header, const std::string& SourcePath, const std::string& MaterialNames, const ObjModelLoader::ModelData& Model)
+    {
+        Header.Version = MeshCache::FORMAT_VERSION;
+        Header.ContentHash = Model.contentHash;
+        Header.SourcePathLength = static_cast<uint32_t>(SourcePath.size());
+        Header.MaterialNamesLength = static_cast<uint32_t>(MaterialNames.size());
+
+        struct SectionSource
+        {
+            const void* Data;
+            SectionEntry Entry;
+        };
+
+        std::vector<LayoutEntry> layoutEntries(Model.layout.GetAttributeCount());
+        for (uint32_t i = 0; i < Model.layout.GetAttributeCount(); i++)
+        {
+            const VertexLayout::Attribute& attribute = Model.layout.GetAttribute(i);
+            layoutEntries[i] = { static_cast<uint8_t>(attribute.AttributeSemantic), static_cast<uint8_t>(attribute.AttributeFormat), attribute.Offset, attribute.ShaderLocation };
+        }
+
+        const BoundsEntry bounds = ToBoundsEntry(Model.bounds);
+
+        std::vector<SubmeshEntry> submeshes(Model.submeshes.size());
+        for (size_t i = 0; i < Model.submeshes.size(); i++)
+        {
+            const ObjModelLoader::ModelData::Submesh& submesh = Model.submeshes[i];
+            submeshes[i] = { submesh.firstIndex, submesh.indexCount, ToBoundsEntry(submesh.bounds), submesh.materialIndex, 0 };
+        }
+
+        std::vector<MaterialEntry> materials(Model.materials.size());
+        std::string strings;
+        for (size_t i = 0; i < Model.materials.size(); i++)
+        {
+            const ObjModelLoader::ModelData::Material& material = Model.materials[i];
+            MaterialEntry& entry = materials[i];
+            std::copy(material.diffuse, material.diffuse + 3, entry.Diffuse);
+            entry.Opacity = material.opacity;
+
+            entry.NameOffset = static_cast<uint32_t>(strings.size());
+            entry.NameLength = static_cast<uint32_t>(material.name.size());
+            strings += material.name;
+
+            entry.TextureOffset = static_cast<uint32_t>(strings.size());
+            entry.TextureLength = static_cast<uint32_t>(material.diffuseTexture.size());
+            strings += material.diffuseTexture;
+        }
+
+        std::vector<LodEntry> lods;
+        for (size_t i = 0; i < Model.submeshes.size(); i++)
+        {
+            for (const ObjModelLoader::ModelData::Lod& lod : Model.submeshes[i].lods)
+            {
+                lods.push_back({ static_cast<uint32_t>(i), lod.firstIndex, lod.indexCount, lod.error });
+            }
+        }
+
+        std::vector<MeshletEntry> meshlets;
+        for (size_t i = 0; i < Model.submeshes.size(); i++)
+        {
+            for (const Meshlet& meshlet : Model.submeshes[i].meshlets)
+            {
+                const Pandu::Vector3& center = meshlet.Bounds.GetCenter();
+                meshlets.push_back({ static_cast<uint32_t>(i), meshlet.FirstIndex, meshlet.IndexCount, { center.x, center.y, center.z }, meshlet.Bounds.GetRadius(),
+                    { meshlet.ConeApex.x, meshlet.ConeApex.y, meshlet.ConeApex.z }, { meshlet.ConeAxis.x, meshlet.ConeAxis.y, meshlet.ConeAxis.z }, meshlet.ConeCutoff });
+            }
+        }
+
+        SectionSource sources[] =
+        {
+            { layoutEntries.data(), { SECTION_VERTEX_LAYOUT, sizeof(LayoutEntry), 0, layoutEntries.size() } },
+            { Model.vertices.data(), { SECTION_VERTICES, sizeof(uint8_t), 0, Model.vertices.size() } },
+            { Model.indexData.data(), { SECTION_INDICES, ObjModelLoader::ModelData::GetIndexSize(Model.indexFormat), 0, Model.indexCount } },
+            { &Model.quantization, { SECTION_QUANTIZATION, sizeof(VertexPacker::Quantization), 0, 1 } },
+            { &bounds, { SECTION_BOUNDS, sizeof(BoundsEntry), 0, 1 } },
+            { submeshes.data(), { SECTION_SUBMESHES, sizeof(SubmeshEntry), 0, submeshes.size() } },
+            { lods.data(), { SECTION_LODS, sizeof(LodEntry), 0, lods.size() } },
+            { meshlets.data(), { SECTION_MESHLETS, sizeof(MeshletEntry), 0, meshlets.size() } },
+            { materials.data(), { SECTION_MATERIALS, sizeof(MaterialEntry), 0, materials.size() } },
+            { strings.data(), { SECTION_STRINGS, sizeof(char), 0, strings.size() } },
+        };
+        Header.SectionCount = static_cast<uint32_t>(sizeof(sources) / sizeof(SectionSource));
+
+        uint64_t offset = AlignUp(sizeof(FileHeader) + Header.SectionCount * sizeof(SectionEntry) + SourcePath.size() + MaterialNames.size());
+        for (SectionSource& source : sources)
+        {
+            source.Entry.Offset = offset;
+            offset = AlignUp(offset + source.Entry.Count * source.Entry.ElementSize);
+        }
+
+        // Unique per thread so two loads of the same source don't write into each other's temporary file
+        const std::string tempPath = OutPath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+        {
+            std::ofstream ofs(tempPath, std::ios::binary | std::ios::trunc);
+            if (!ofs)
+            {
+                return false;
+            }
+
+            ofs.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+            for (const SectionSource& source : sources)
+            {
+                ofs.write(reinterpret_cast<const char*>(&source.Entry), sizeof(SectionEntry));
+            }
+            ofs.write(SourcePath.data(), SourcePath.size());
+            ofs.write(MaterialNames.data(), MaterialNames.size());
+
+            static const char padding[MeshCache::SECTION_ALIGNMENT] = {};
+            for (const SectionSource& source : sources)
+            {
+                const uint64_t position = static_cast<uint64_t>(ofs.tellp());
+                ofs.write(padding, static_cast<std::streamsize>(source.Entry.Offset - position));
+                ofs.write(static_cast<const char*>(source.Data), static_cast<std::streamsize>(source.Entry.Count * source.Entry.ElementSize));
+            }
+
+            if (!ofs)
+            {
+                ofs.close();
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, OutPath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+std::string MeshCache::GetCachePath(const std::string& SourcePath)
+{
+    return SourcePath + ".meshcache";
+}
+
+std::string MeshCache::GetCookedPath(const std::string& SourcePath, uint64_t SettingsKey)
+{
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(SettingsKey));
+    return SourcePath + "." + key + ".cooked";
+}
+
+std::unique_ptr<const ObjModelLoader::ModelData> MeshCache::Read(const std::string& SourcePath, uint64_t SettingsKey)
+{
+    auto file = std::make_shared<MappedFile>();
+    FileHeader header;
+    if (!file->Open(GetCachePath(SourcePath)) || !ReadHeader(file->GetData(), file->GetSize(), CACHE_MAGIC, header)
+        || header.SettingsKey != SettingsKey)
+    {
+        return nullptr;
+    }
+
+    const char* storedPath = file->GetData() + sizeof(FileHeader) + header.SectionCount * sizeof(SectionEntry);
+    if (SourcePath.size() != header.SourcePathLength || memcmp(storedPath, SourcePath.data(), SourcePath.size()) != 0)
+    {
+        return nullptr;
+    }
+
+    // The stored .mtl names save parsing the source again just to find its mtllib lines
+    const std::string_view materialNames(storedPath + header.SourcePathLength, header.MaterialNamesLength);
+    uint64_t sourceSize = 0;
+    uint64_t sourceTime = 0;
+    if (!GetSourceStamp(SourcePath, materialNames, sourceSize, sourceTime) || header.SourceSize != sourceSize || header.SourceStamp != sourceTime)
+    {
+        return nullptr;
+    }
+
+    auto model = ReadSections(file->GetData(), file->GetSize(), header);
+    if (model)
+    {
+        model->storage = std::move(file);
+    }
+    return model;
+}
+
+bool MeshCache::Write(const std::string& SourcePath, uint64_t SettingsKey, const ObjModelLoader::ModelData& Model)
+{
+    FileHeader header;
+    memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.SourceHash = 0;
+    header.SettingsKey = SettingsKey;
+
+    const std::string materialNames = GetMaterialNames(SourcePath);
+    if (!GetSourceStamp(SourcePath, materialNames, header.SourceSize, header.SourceStamp))
+    {
+        return false;
+    }
+
+    return WriteFile(GetCachePath(SourcePath), header, SourcePath, materialNames, Model);
+}
+
+std::unique_ptr<const ObjModelLoader::ModelData> MeshCache::ReadCooked(const std::string& SourcePath, uint64_t SettingsKey)
+{
+    auto file = std::make_shared<MappedFile>();
+    FileHeader header;
+    if (!file->Open(GetCookedPath(SourcePath, SettingsKey)) || !ReadHeader(file->GetData(), file->GetSize(), COOKED_MAGIC, header)
+        || header.SettingsKey != SettingsKey)
+    {
+        return nullptr;
+    }
+
+    // Shipping builds may leave the sources out, where they are an edit since the last cook makes the cooked file stale
+    std::error_code error;
+    if (std::filesystem::exists(SourcePath, error))
+    {
+        // Untouched sources match the stamp, only a touched or checked out again source pays for the full hash
+        const char* storedPath = file->GetData() + sizeof(FileHeader) + header.SectionCount * sizeof(SectionEntry);
+        const std::string_view materialNames(storedPath + header.SourcePathLength, header.MaterialNamesLength);
+        uint64_t sourceSize = 0;
+        uint64_t sourceTime = 0;
+        const bool stampMatches = GetSourceStamp(SourcePath, materialNames, sourceSize, sourceTime)
+            && header.SourceSize == sourceSize && header.SourceStamp == sourceTime;
+
+        uint64_t sourceHash = 0;
+        if (!stampMatches && (!HashSource(SourcePath, sourceHash) || sourceHash != header.SourceHash))
+        {
+            return nullptr;
+        }
+    }
+
+    auto model = ReadSections(file->GetData(), file->GetSize(), header);
+    if (model)
+    {
+        model->storage = std::move(file);
+    }
+    return model;
+}
+
+std::unique_ptr<const ObjModelLoader::ModelData> MeshCache::ReadCooked(std::shared_ptr<const void> Storage, const char* Data, size_t Size, uint64_t SettingsKey)
+{
+    FileHeader header;
+    if (!ReadHeader(Data, Size, COOKED_MAGIC, header) || header.SettingsKey != SettingsKey)
+    {
+        return nullptr;
+    }
+
+    auto model = ReadSections(Data, Size, header);
+    if (model)
+    {
+        model->storage = std::move(Storage);
+    }
+    return model;
+}
+
+bool MeshCache::GetCookedSourceHash(const std::string& SourcePath, uint64_t SettingsKey, uint64_t& OutSourceHash)
+{
+    MappedFile file;
+    FileHeader header;
+    if (!file.Open(GetCookedPath(SourcePath, SettingsKey)) || !ReadHeader(file.GetData(), file.GetSize(), COOKED_MAGIC, header)
+        || header.SettingsKey != SettingsKey)
+    {
+        return false;
+    }
+
+    OutSourceHash = header.SourceHash;
+    return true;
+}
+
+bool MeshCache::WriteCooked(const std::string& SourcePath, uint64_t SourceHash, uint64_t SettingsKey, const ObjModelLoader::ModelData& Model)
+{
+    FileHeader header;
+    memcpy(header.Magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+    header.SourceHash = SourceHash;
+    header.SettingsKey = SettingsKey;
+
+    // A source that can't be stamped leaves zeros, ReadCooked then always falls back to the hash
+    const std::string materialNames = GetMaterialNames(SourcePath);
+    if (!GetSourceStamp(SourcePath, materialNames, header.SourceSize, header.SourceStamp))
+    {
+        header.SourceSize = 0;
+        header.SourceStamp = 0;
+    }
+
+    return WriteFile(GetCookedPath(SourcePath, SettingsKey), header, SourcePath, materialNames, Model);
+}
+
+bool MeshCache::RefreshCookedStamp(const std::string& SourcePath, uint64_t SettingsKey)
+{
+    const std::string cookedPath = GetCookedPath(SourcePath, SettingsKey);
+
+    FileHeader header;
+    std::string materialNames;
+    {
+        MappedFile file;
+        if (!file.Open(cookedPath) || !ReadHeader(file.GetData(), file.GetSize(), COOKED_MAGIC, header) || header.SettingsKey != SettingsKey)
+        {
+            return false;
+        }
+
+        const char* storedPath = file.GetData() + sizeof(FileHeader) + header.SectionCount * sizeof(SectionEntry);
+        materialNames.assign(storedPath + header.SourcePathLength, header.MaterialNamesLength);
+    }
+
+    uint64_t sourceSize = 0;
+    uint64_t sourceTime = 0;
+    if (!GetSourceStamp(SourcePath, materialNames, sourceSize, sourceTime))
+    {
+        return false;
+    }
+
+    if (header.SourceSize == sourceSize && header.SourceStamp == sourceTime)
+    {
+        return true;
+    }
+
+    // Only the header changes, a reader that sees it half written falls back to the hash once
+    header.SourceSize = sourceSize;
+    header.SourceStamp = sourceTime;
+
+    std::fstream fs(cookedPath, std::ios::binary | std::ios::in | std::ios::out);
+    fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(fs);
+}
+
+bool MeshCache::HashSource(const std::string& SourcePath, uint64_t& OutHash)
+{
+    // FNV-1a over the .obj and every .mtl file it names, in order, a missing .mtl only contributes its name
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto HashBytes = [&hash](const void* Data, size_t Size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(Data);
+        for (size_t i = 0; i < Size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    };
+
+    MappedFile source;
+    if (!source.Open(SourcePath))
+    {
+        return false;
+    }
+    HashBytes(source.GetData(), source.GetSize());
+
+    const std::string directory = GetSourceDirectory(SourcePath);
+    ForEachMaterialLib(source.GetView(), [&](const std::string& Name)
+    {
+        HashBytes(Name.data(), Name.size());
+
+        MappedFile material;
+        if (material.Open(directory + Name))
+        {
+            HashBytes(material.GetData(), material.GetSize());
+        }
+    });
+
+    OutHash = hash;
+    return true;
+}
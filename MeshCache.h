@@ -0,0 +1,53 @@
+#ifndef __MeshCache_h__
+#define __MeshCache_h__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "ObjModelLoader.h"
+
+// Versioned binary copy of a loaded mesh, stored next to its source file.
+// Every stream is aligned so a mapped cooked file can be handed to the GPU upload as is.
+// Cache files are written by the loader itself and only used while the source path, size and modification time and the
+// load settings still match. Cooked files are written by the AssetCooker, one per settings key, and stamped with a hash of
+// the source content instead, so they stay valid when they are copied or checked out and can ship without their sources.
+class MeshCache
+{
+public:
+
+	static std::string GetCachePath(const std::string& SourcePath);
+
+	// Maps the cache file of SourcePath, nullptr when there is none or it is stale
+	static std::unique_ptr<const ObjModelLoader::ModelData> Read(const std::string& SourcePath, uint64_t SettingsKey);
+
+	// Goes through a temporary file and a rename so readers never see a partially written cache file
+	static bool Write(const std::string& SourcePath, uint64_t SettingsKey, const ObjModelLoader::ModelData& Model);
+
+	static std::string GetCookedPath(const std::string& SourcePath, uint64_t SettingsKey);
+
+	// Maps the cooked file of SourcePath. Where the source is present it has to match the size and modification time stamp
+	// the file was cooked with, or failing that hash to the source hash.
+	static std::unique_ptr<const ObjModelLoader::ModelData> ReadCooked(const std::string& SourcePath, uint64_t SettingsKey);
+
+	// Cooked file already in memory, fetched on the web build. The model views point into Data, Storage keeps it alive.
+	static std::unique_ptr<const ObjModelLoader::ModelData> ReadCooked(std::shared_ptr<const void> Storage, const char* Data, size_t Size, uint64_t SettingsKey);
+
+	// Source hash the cooked file of SourcePath was built from, false when there is none for these settings
+	static bool GetCookedSourceHash(const std::string& SourcePath, uint64_t SettingsKey, uint64_t& OutSourceHash);
+
+	static bool WriteCooked(const std::string& SourcePath, uint64_t SourceHash, uint64_t SettingsKey, const ObjModelLoader::ModelData& Model);
+
+	// Takes the size and modification time stamp of the source again, for a cooked file whose source hash still matches
+	// after a touch or a checkout. ReadCooked then accepts it without hashing the source.
+	static bool RefreshCookedStamp(const std::string& SourcePath, uint64_t SettingsKey);
+
+	// Hash of the .obj and the .mtl files it names, whatever can change the loaded model
+	static bool HashSource(const std::string& SourcePath, uint64_t& OutHash);
+
+	// Bump whenever the file layout or the meaning of a section changes
+	static constexpr uint32_t FORMAT_VERSION = 12;
+
+	static constexpr uint64_t SECTION_ALIGNMENT = 16;
+};
+
+#endif //__MeshCache_h__
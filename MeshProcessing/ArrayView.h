@@ -0,0 +1,47 @@
+#ifndef __ArrayView_h__
+#define __ArrayView_h__
+
+#include <cstddef>
+#include <vector>
+
+// Read-only, non-owning view of a contiguous array.
+// Lets mesh data be consumed the same way whether it lives in a std::vector or in a mapped file.
+template <typename T>
+class ArrayView
+{
+public:
+
+	ArrayView()
+		: m_Data(nullptr)
+		, m_Size(0)
+	{
+	}
+
+	ArrayView(const T* Data, size_t Size)
+		: m_Data(Data)
+		, m_Size(Size)
+	{
+	}
+
+	ArrayView(const std::vector<T>& Vector)
+		: m_Data(Vector.data())
+		, m_Size(Vector.size())
+	{
+	}
+
+	const T* data() const { return m_Data; }
+	size_t size() const { return m_Size; }
+	bool empty() const { return m_Size == 0; }
+
+	const T* begin() const { return m_Data; }
+	const T* end() const { return m_Data + m_Size; }
+
+	const T& operator [] (size_t Index) const { return m_Data[Index]; }
+
+private:
+
+	const T* m_Data;
+	size_t m_Size;
+};
+
+#endif //__ArrayView_h__
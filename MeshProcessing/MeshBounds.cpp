@@ -0,0 +1,114 @@
+#include "MeshBounds.h"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Axes and cube diagonals, the extreme points along them give a good first diameter
+    const Pandu::Vector3 EXTREME_DIRECTIONS[] =
+    {
+        Pandu::Vector3(1.0f, 0.0f, 0.0f),
+        Pandu::Vector3(0.0f, 1.0f, 0.0f),
+        Pandu::Vector3(0.0f, 0.0f, 1.0f),
+        Pandu::Vector3(1.0f, 1.0f, 1.0f),
+        Pandu::Vector3(1.0f, 1.0f, -1.0f),
+        Pandu::Vector3(1.0f, -1.0f, 1.0f),
+        Pandu::Vector3(1.0f, -1.0f, -1.0f),
+    };
+
+    constexpr size_t DIRECTION_COUNT = sizeof(EXTREME_DIRECTIONS) / sizeof(EXTREME_DIRECTIONS[0]);
+
+    // GetVertex(i) returns the position of the i-th visited vertex
+    template <typename GetVertexType>
+    MeshBounds ComputeBounds(size_t Count, const GetVertexType& GetVertex)
+    {
+        MeshBounds bounds;
+        if (Count == 0)
+        {
+            return bounds;
+        }
+
+        Pandu::Vector3 minPoints[DIRECTION_COUNT], maxPoints[DIRECTION_COUNT];
+        float minProjections[DIRECTION_COUNT], maxProjections[DIRECTION_COUNT];
+        for (size_t d = 0; d < DIRECTION_COUNT; d++)
+        {
+            minPoints[d] = maxPoints[d] = GetVertex(0);
+            minProjections[d] = maxProjections[d] = EXTREME_DIRECTIONS[d].Dot(minPoints[d]);
+        }
+
+        for (size_t i = 0; i < Count; i++)
+        {
+            const Pandu::Vector3 point = GetVertex(i);
+            bounds.Box.Merge(point);
+
+            for (size_t d = 0; d < DIRECTION_COUNT; d++)
+            {
+                const float projection = EXTREME_DIRECTIONS[d].Dot(point);
+                if (projection < minProjections[d])
+                {
+                    minProjections[d] = projection;
+                    minPoints[d] = point;
+                }
+                if (projection > maxProjections[d])
+                {
+                    maxProjections[d] = projection;
+                    maxPoints[d] = point;
+                }
+            }
+        }
+
+        size_t widest = 0;
+        for (size_t d = 1; d < DIRECTION_COUNT; d++)
+        {
+            if ((maxPoints[d] - minPoints[d]).SqrdLength() > (maxPoints[widest] - minPoints[widest]).SqrdLength())
+                widest = d;
+        }
+
+        Pandu::Sphere sphere((minPoints[widest] + maxPoints[widest]) * 0.5f, (maxPoints[widest] - minPoints[widest]).Length() * 0.5f);
+
+        const Pandu::Vector3 boxCenter = bounds.Box.GetCenter();
+        float boxCenterRadiusSqrd = 0.0f;
+        for (size_t i = 0; i < Count; i++)
+        {
+            const Pandu::Vector3 point = GetVertex(i);
+            sphere.Merge(point);
+
+            const float distanceSqrd = (point - boxCenter).SqrdLength();
+            boxCenterRadiusSqrd = distanceSqrd > boxCenterRadiusSqrd ? distanceSqrd : boxCenterRadiusSqrd;
+        }
+
+        const float boxCenterRadius = std::sqrt(boxCenterRadiusSqrd);
+        const Pandu::Sphere tightest = sphere.GetRadius() < boxCenterRadius ? sphere : Pandu::Sphere(boxCenter, boxCenterRadius);
+
+        // A few ulps of slack so rounding in the growth steps or in a later distance test never leaves a vertex outside
+        const Pandu::Vector3& center = tightest.GetCenter();
+        const float magnitude = std::fabs(center.x) + std::fabs(center.y) + std::fabs(center.z) + tightest.GetRadius();
+        bounds.Sphere = Pandu::Sphere(center, tightest.GetRadius() + magnitude * 4.0f * std::numeric_limits<float>::epsilon());
+        return bounds;
+    }
+}
+
+MeshBounds::MeshBounds()
+    : Sphere(Pandu::Vector3(0.0f, 0.0f, 0.0f), 0.0f)
+{
+    Box.SetEmpty();
+}
+
+MeshBounds MeshBounds::Compute(const float* Positions, size_t PositionStride, const uint32_t* Indices, size_t IndexCount)
+{
+    return ComputeBounds(IndexCount, [&](size_t i)
+    {
+        const float* position = Positions + static_cast<size_t>(Indices[i]) * PositionStride;
+        return Pandu::Vector3(position[0], position[1], position[2]);
+    });
+}
+
+MeshBounds MeshBounds::Compute(const float* Positions, size_t PositionStride, size_t VertexCount)
+{
+    return ComputeBounds(VertexCount, [&](size_t i)
+    {
+        const float* position = Positions + i * PositionStride;
+        return Pandu::Vector3(position[0], position[1], position[2]);
+    });
+}
@@ -0,0 +1,27 @@
+#ifndef __MeshBounds_h__
+#define __MeshBounds_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <PANDUAxisAlignedBox3.h>
+#include <PANDUSphere.h>
+
+// Axis aligned box and bounding sphere of a mesh or part of one, in model space
+struct MeshBounds
+{
+	MeshBounds();
+
+	// Bounds of the vertices the indices reference. Positions holds PositionStride floats per vertex, x y z first.
+	// The sphere starts from the most distant pair of extreme points along 7 directions and grows to hold every vertex,
+	// it is kept when it is smaller than the sphere around the box center.
+	static MeshBounds Compute(const float* Positions, size_t PositionStride, const uint32_t* Indices, size_t IndexCount);
+
+	// Same for every vertex in order, for meshes without an index buffer
+	static MeshBounds Compute(const float* Positions, size_t PositionStride, size_t VertexCount);
+
+	// Empty when nothing was referenced
+	Pandu::AxisAlignedBox3 Box;
+	Pandu::Sphere Sphere;
+};
+
+#endif //__MeshBounds_h__
@@ -0,0 +1,280 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Forsyth's tuning, see "Linear-Speed Vertex Cache Optimisation"
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+    constexpr uint32_t MAX_VALENCE_SCORE = 64;
+
+    struct ScoreTables
+    {
+        ScoreTables()
+        {
+            const uint32_t cacheSize = MeshOptimizer::MAX_CACHE_SIZE;
+            for (uint32_t i = 0; i < cacheSize; i++)
+            {
+                if (i < 3)
+                {
+                    // The triangle just emitted, these vertices are reused "for free" whatever is picked next
+                    Cache[i] = LAST_TRIANGLE_SCORE;
+                }
+                else
+                {
+                    const float scaler = 1.0f / static_cast<float>(cacheSize - 3);
+                    Cache[i] = std::pow(1.0f - static_cast<float>(i - 3) * scaler, CACHE_DECAY_POWER);
+                }
+            }
+
+            Valence[0] = 0.0f;
+            for (uint32_t i = 1; i < MAX_VALENCE_SCORE; i++)
+            {
+                // Favour vertices with few triangles left so they get finished off and leave no lone triangles behind
+                Valence[i] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -VALENCE_BOOST_POWER);
+            }
+        }
+
+        float Cache[MeshOptimizer::MAX_CACHE_SIZE];
+        float Valence[MAX_VALENCE_SCORE];
+    };
+
+    const ScoreTables& GetScoreTables()
+    {
+        static const ScoreTables tables;
+        return tables;
+    }
+
+    float GetVertexScore(const ScoreTables& Tables, int CachePosition, uint32_t RemainingTriangles)
+    {
+        if (RemainingTriangles == 0)
+        {
+            return -1.0f;
+        }
+
+        const float cacheScore = CachePosition >= 0 ? Tables.Cache[CachePosition] : 0.0f;
+        return cacheScore + Tables.Valence[RemainingTriangles < MAX_VALENCE_SCORE ? RemainingTriangles : MAX_VALENCE_SCORE - 1];
+    }
+}
+
+MeshOptimizer::CacheStatistics MeshOptimizer::AnalyzeVertexCache(const uint32_t* Indices, size_t IndexCount, size_t VertexCount, uint32_t CacheSize)
+{
+    CacheStatistics statistics;
+    if (IndexCount < 3 || VertexCount == 0 || CacheSize == 0)
+    {
+        return statistics;
+    }
+
+    // Timestamp of the vertex's last insertion, it is in the FIFO while fewer than CacheSize insertions happened since
+    std::vector<uint32_t> insertedAt(VertexCount, 0);
+    uint32_t insertions = 0;
+
+    for (size_t i = 0; i < IndexCount; i++)
+    {
+        const uint32_t vertex = Indices[i];
+        if (insertedAt[vertex] == 0 || insertions - insertedAt[vertex] >= CacheSize)
+        {
+            insertions++;
+            insertedAt[vertex] = insertions;
+        }
+    }
+
+    statistics.VertexTransformCount = insertions;
+    statistics.Acmr = static_cast<float>(insertions) / static_cast<float>(IndexCount / 3);
+
+    size_t usedVertexCount = 0;
+    for (uint32_t stamp : insertedAt)
+    {
+        usedVertexCount += stamp != 0 ? 1 : 0;
+    }
+    statistics.Atvr = static_cast<float>(insertions) / static_cast<float>(usedVertexCount);
+
+    return statistics;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* Indices, size_t IndexCount, size_t VertexCount)
+{
+    const size_t triangleCount = IndexCount / 3;
+    if (triangleCount < 2 || VertexCount == 0)
+    {
+        return;
+    }
+
+    const ScoreTables& tables = GetScoreTables();
+
+    // Triangles of every vertex, the first RemainingTriangles[v] entries of a vertex are the ones not emitted yet
+    std::vector<uint32_t> remainingTriangles(VertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+        remainingTriangles[Indices[i]]++;
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(VertexCount + 1, 0);
+    for (size_t v = 0; v < VertexCount; v++)
+    {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+    }
+
+    std::vector<uint32_t> adjacency(adjacencyOffsets[VertexCount]);
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                adjacency[fill[Indices[t * 3 + c]]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePositions(VertexCount, -1);
+    std::vector<float> vertexScores(VertexCount);
+    for (size_t v = 0; v < VertexCount; v++)
+    {
+        vertexScores[v] = GetVertexScore(tables, -1, remainingTriangles[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8_t> triangleEmitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangleScores[t] = vertexScores[Indices[t * 3 + 0]] + vertexScores[Indices[t * 3 + 1]] + vertexScores[Indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output(triangleCount * 3);
+
+    // Room for the full cache plus the three vertices of the triangle being added
+    uint32_t cache[MAX_CACHE_SIZE + 3];
+    uint32_t cacheCount = 0;
+
+    size_t bestTriangle = 0;
+    for (size_t t = 1; t < triangleCount; t++)
+    {
+        if (triangleScores[t] > triangleScores[bestTriangle])
+            bestTriangle = t;
+    }
+
+    size_t scanCursor = 0;
+    for (size_t emitted = 0; emitted < triangleCount; emitted++)
+    {
+        if (bestTriangle == SIZE_MAX)
+        {
+            // Nothing left around the cache, carry on with the next triangle in the original order
+            while (triangleEmitted[scanCursor])
+            {
+                scanCursor++;
+            }
+            bestTriangle = scanCursor;
+        }
+
+        const uint32_t* triangle = Indices + bestTriangle * 3;
+        memcpy(&output[emitted * 3], triangle, 3 * sizeof(uint32_t));
+        triangleEmitted[bestTriangle] = 1;
+
+        for (int c = 0; c < 3; c++)
+        {
+            const uint32_t vertex = triangle[c];
+
+            uint32_t* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+            const uint32_t last = --remainingTriangles[vertex];
+            for (uint32_t i = 0; i <= last; i++)
+            {
+                if (vertexTriangles[i] == bestTriangle)
+                {
+                    vertexTriangles[i] = vertexTriangles[last];
+                    break;
+                }
+            }
+        }
+
+        // The emitted triangle moves to the front, everything else shifts back and the tail falls out
+        uint32_t newCache[MAX_CACHE_SIZE + 3];
+        uint32_t newCacheCount = 0;
+        for (int c = 0; c < 3; c++)
+        {
+            newCache[newCacheCount++] = triangle[c];
+        }
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            const uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheCount++] = vertex;
+        }
+
+        for (uint32_t i = 0; i < newCacheCount; i++)
+        {
+            const uint32_t vertex = newCache[i];
+            cachePositions[vertex] = i < MAX_CACHE_SIZE ? static_cast<int>(i) : -1;
+
+            const float score = GetVertexScore(tables, cachePositions[vertex], remainingTriangles[vertex]);
+            const float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            const uint32_t* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+            for (uint32_t j = 0; j < remainingTriangles[vertex]; j++)
+            {
+                triangleScores[vertexTriangles[j]] += delta;
+            }
+        }
+
+        cacheCount = newCacheCount < MAX_CACHE_SIZE ? newCacheCount : MAX_CACHE_SIZE;
+        memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+        // Only triangles touching the cache changed score, the best next one is among them
+        bestTriangle = SIZE_MAX;
+        float bestScore = -1.0f;
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            const uint32_t vertex = cache[i];
+            const uint32_t* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+            for (uint32_t j = 0; j < remainingTriangles[vertex]; j++)
+            {
+                const uint32_t candidate = vertexTriangles[j];
+                if (triangleScores[candidate] > bestScore)
+                {
+                    bestScore = triangleScores[candidate];
+                    bestTriangle = candidate;
+                }
+            }
+        }
+    }
+
+    memcpy(Indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+void MeshOptimizer::OptimizeVertexFetch(uint32_t* Indices, size_t IndexCount, size_t VertexCount, std::vector<uint32_t>& OutRemap)
+{
+    constexpr uint32_t UNASSIGNED = 0xffffffffu;
+
+    OutRemap.assign(VertexCount, UNASSIGNED);
+
+    uint32_t nextVertex = 0;
+    for (size_t i = 0; i < IndexCount; i++)
+    {
+        uint32_t& remapped = OutRemap[Indices[i]];
+        if (remapped == UNASSIGNED)
+        {
+            remapped = nextVertex++;
+        }
+        Indices[i] = remapped;
+    }
+
+    for (uint32_t& remapped : OutRemap)
+    {
+        if (remapped == UNASSIGNED)
+            remapped = nextVertex++;
+    }
+}
+
+void MeshOptimizer::RemapVertices(uint8_t* Vertices, size_t VertexCount, size_t VertexSize, const std::vector<uint32_t>& Remap)
+{
+    std::vector<uint8_t> source(Vertices, Vertices + VertexCount * VertexSize);
+    for (size_t v = 0; v < VertexCount; v++)
+    {
+        memcpy(Vertices + static_cast<size_t>(Remap[v]) * VertexSize, source.data() + v * VertexSize, VertexSize);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef __MeshOptimizer_h__
+#define __MeshOptimizer_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reorders indexed triangle lists for the GPU: triangles for post-transform vertex cache reuse, vertices for fetch locality
+class MeshOptimizer
+{
+public:
+
+	struct CacheStatistics
+	{
+		CacheStatistics()
+			: VertexTransformCount(0)
+			, Acmr(0.0f)
+			, Atvr(0.0f)
+		{
+		}
+
+		uint32_t VertexTransformCount;
+
+		// Average cache miss ratio: transformed vertices per triangle, 0.5 is the best a regular grid can do, 3 is no reuse at all
+		float Acmr;
+
+		// Average transform to vertex ratio: transformed vertices per vertex, 1 is perfect
+		float Atvr;
+	};
+
+	// Simulates a FIFO post-transform cache of CacheSize entries over the triangle list
+	static CacheStatistics AnalyzeVertexCache(const uint32_t* Indices, size_t IndexCount, size_t VertexCount, uint32_t CacheSize = 16);
+
+	// Reorders the triangles in place (Forsyth's linear-speed vertex cache optimization)
+	static void OptimizeVertexCache(uint32_t* Indices, size_t IndexCount, size_t VertexCount);
+
+	// Renumbers vertices in the order the indices first reference them and rewrites the indices.
+	// OutRemap[OldIndex] is the new index. Unreferenced vertices are moved behind the referenced ones.
+	static void OptimizeVertexFetch(uint32_t* Indices, size_t IndexCount, size_t VertexCount, std::vector<uint32_t>& OutRemap);
+
+	// Moves fixed size vertices to their remapped position
+	static void RemapVertices(uint8_t* Vertices, size_t VertexCount, size_t VertexSize, const std::vector<uint32_t>& Remap);
+
+	// Size of the LRU cache Forsyth's scoring models
+	static constexpr uint32_t MAX_CACHE_SIZE = 32;
+};
+
+#endif //__MeshOptimizer_h__
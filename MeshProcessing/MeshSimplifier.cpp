@@ -0,0 +1,504 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t NO_VERTEX = 0xffffffffu;
+    constexpr uint32_t MANY_VERTICES = 0xfffffffeu;
+
+    enum VertexKind : uint8_t
+    {
+        KIND_MANIFOLD,  // Interior, collapses onto any neighbour
+        KIND_BORDER,    // On exactly one open border, slides along it
+        KIND_SEAM,      // One of the two vertices of an attribute seam, slides along the seam together with its twin
+        KIND_LOCKED,    // Border corners, seam ends, non-manifold and 3+ way splits, never moves
+    };
+
+    // Sum of squared distances to weighted planes, x^T A x + 2 B.x + C
+    struct Quadric
+    {
+        double A00, A11, A22, A01, A02, A12;
+        double B0, B1, B2;
+        double C;
+        double Weight;
+    };
+
+    void AddPlane(Quadric& Q, double Nx, double Ny, double Nz, double D, double Weight)
+    {
+        Q.A00 += Weight * Nx * Nx;
+        Q.A11 += Weight * Ny * Ny;
+        Q.A22 += Weight * Nz * Nz;
+        Q.A01 += Weight * Nx * Ny;
+        Q.A02 += Weight * Nx * Nz;
+        Q.A12 += Weight * Ny * Nz;
+        Q.B0 += Weight * Nx * D;
+        Q.B1 += Weight * Ny * D;
+        Q.B2 += Weight * Nz * D;
+        Q.C += Weight * D * D;
+        Q.Weight += Weight;
+    }
+
+    void AddQuadric(Quadric& Q, const Quadric& Other)
+    {
+        Q.A00 += Other.A00; Q.A11 += Other.A11; Q.A22 += Other.A22;
+        Q.A01 += Other.A01; Q.A02 += Other.A02; Q.A12 += Other.A12;
+        Q.B0 += Other.B0; Q.B1 += Other.B1; Q.B2 += Other.B2;
+        Q.C += Other.C;
+        Q.Weight += Other.Weight;
+    }
+
+    // Weighted mean squared distance of P to the planes
+    double EvaluateQuadric(const Quadric& Q, const float* P)
+    {
+        const double x = P[0], y = P[1], z = P[2];
+        const double result = Q.A00 * x * x + Q.A11 * y * y + Q.A22 * z * z
+            + 2.0 * (Q.A01 * x * y + Q.A02 * x * z + Q.A12 * y * z)
+            + 2.0 * (Q.B0 * x + Q.B1 * y + Q.B2 * z)
+            + Q.C;
+        return Q.Weight > 0.0 && result > 0.0 ? result / Q.Weight : 0.0;
+    }
+
+    // Outgoing half-edges of every vertex, each with the triangle it belongs to
+    struct EdgeAdjacency
+    {
+        std::vector<uint32_t> Offsets;
+        std::vector<uint32_t> Targets;
+        std::vector<uint32_t> Triangles;
+
+        void Build(const uint32_t* Indices, size_t IndexCount, size_t VertexCount)
+        {
+            Offsets.assign(VertexCount + 1, 0);
+            for (size_t i = 0; i < IndexCount; i++)
+            {
+                Offsets[Indices[i] + 1]++;
+            }
+            for (size_t v = 0; v < VertexCount; v++)
+            {
+                Offsets[v + 1] += Offsets[v];
+            }
+
+            Targets.resize(IndexCount);
+            Triangles.resize(IndexCount);
+
+            std::vector<uint32_t> fill(Offsets.begin(), Offsets.end() - 1);
+            for (size_t t = 0; t < IndexCount / 3; t++)
+            {
+                for (int e = 0; e < 3; e++)
+                {
+                    const uint32_t from = Indices[t * 3 + e];
+                    const uint32_t to = Indices[t * 3 + (e + 1) % 3];
+                    Targets[fill[from]] = to;
+                    Triangles[fill[from]] = static_cast<uint32_t>(t);
+                    fill[from]++;
+                }
+            }
+        }
+
+        bool HasEdge(uint32_t From, uint32_t To) const
+        {
+            for (uint32_t i = Offsets[From]; i < Offsets[From + 1]; i++)
+            {
+                if (Targets[i] == To)
+                    return true;
+            }
+            return false;
+        }
+    };
+
+    struct PositionKey
+    {
+        uint32_t Bits[3];
+
+        bool operator == (const PositionKey& Other) const
+        {
+            return Bits[0] == Other.Bits[0] && Bits[1] == Other.Bits[1] && Bits[2] == Other.Bits[2];
+        }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator () (const PositionKey& Key) const
+        {
+            return (Key.Bits[0] * 73856093u) ^ (Key.Bits[1] * 19349663u) ^ (Key.Bits[2] * 83492791u);
+        }
+    };
+
+    // OutRemap[v] is the first vertex at v's exact position, OutWedge links the vertices of one position into a ring
+    void BuildPositionRemap(const float* Positions, size_t VertexCount, size_t Stride, std::vector<uint32_t>& OutRemap, std::vector<uint32_t>& OutWedge)
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstVertex;
+        firstVertex.reserve(VertexCount);
+
+        OutRemap.resize(VertexCount);
+        OutWedge.resize(VertexCount);
+        for (size_t v = 0; v < VertexCount; v++)
+        {
+            PositionKey key;
+            memcpy(key.Bits, Positions + v * Stride, sizeof(key.Bits));
+
+            const uint32_t vertex = static_cast<uint32_t>(v);
+            const uint32_t first = firstVertex.emplace(key, vertex).first->second;
+            OutRemap[v] = first;
+
+            if (first == vertex)
+            {
+                OutWedge[v] = vertex;
+            }
+            else
+            {
+                OutWedge[v] = OutWedge[first];
+                OutWedge[first] = vertex;
+            }
+        }
+    }
+
+    // An edge open in vertex space is still closed in position space when some other vertex of each end closes it
+    bool IsPositionOpen(const EdgeAdjacency& Adjacency, const std::vector<uint32_t>& Wedge, uint32_t From, uint32_t To)
+    {
+        uint32_t to = To;
+        do
+        {
+            uint32_t from = From;
+            do
+            {
+                if (Adjacency.HasEdge(to, from))
+                    return false;
+                from = Wedge[from];
+            } while (from != From);
+
+            to = Wedge[to];
+        } while (to != To);
+
+        return true;
+    }
+
+    void ClassifyVertices(const EdgeAdjacency& Adjacency, const std::vector<uint32_t>& Remap, const std::vector<uint32_t>& Wedge, size_t VertexCount,
+        std::vector<uint8_t>& OutKinds, std::vector<uint32_t>& OutOpenOut, std::vector<uint32_t>& OutOpenIn)
+    {
+        OutOpenOut.assign(VertexCount, NO_VERTEX);
+        OutOpenIn.assign(VertexCount, NO_VERTEX);
+
+        // Borders reach positions only through open edges that no other vertex at the same positions closes
+        std::vector<uint8_t> positionOpenOut(VertexCount, 0);
+
+        for (uint32_t from = 0; from < VertexCount; from++)
+        {
+            for (uint32_t i = Adjacency.Offsets[from]; i < Adjacency.Offsets[from + 1]; i++)
+            {
+                const uint32_t to = Adjacency.Targets[i];
+                if (Adjacency.HasEdge(to, from))
+                    continue;
+
+                OutOpenOut[from] = OutOpenOut[from] == NO_VERTEX ? to : MANY_VERTICES;
+                OutOpenIn[to] = OutOpenIn[to] == NO_VERTEX ? from : MANY_VERTICES;
+                positionOpenOut[from] = IsPositionOpen(Adjacency, Wedge, from, to) ? 1 : 0;
+            }
+        }
+
+        OutKinds.resize(VertexCount);
+        for (uint32_t v = 0; v < VertexCount; v++)
+        {
+            const uint32_t openOut = OutOpenOut[v];
+            const uint32_t openIn = OutOpenIn[v];
+            const bool singleBorder = openOut < MANY_VERTICES && openIn < MANY_VERTICES;
+
+            uint8_t kind = KIND_LOCKED;
+            if (Wedge[v] == v)
+            {
+                if (openOut == NO_VERTEX && openIn == NO_VERTEX)
+                {
+                    kind = KIND_MANIFOLD;
+                }
+                else if (singleBorder && positionOpenOut[v] && positionOpenOut[openIn])
+                {
+                    kind = KIND_BORDER;
+                }
+            }
+            else if (Wedge[Wedge[v]] == v)
+            {
+                // Both sides of the seam run along the same positions in opposite directions
+                const uint32_t twin = Wedge[v];
+                const uint32_t twinOut = OutOpenOut[twin];
+                const uint32_t twinIn = OutOpenIn[twin];
+                if (singleBorder && twinOut < MANY_VERTICES && twinIn < MANY_VERTICES
+                    && Remap[openOut] == Remap[twinIn] && Remap[openIn] == Remap[twinOut]
+                    && !positionOpenOut[v] && !positionOpenOut[openIn])
+                {
+                    kind = KIND_SEAM;
+                }
+            }
+
+            OutKinds[v] = kind;
+        }
+    }
+
+    void Cross(const double* A, const double* B, double* Out)
+    {
+        Out[0] = A[1] * B[2] - A[2] * B[1];
+        Out[1] = A[2] * B[0] - A[0] * B[2];
+        Out[2] = A[0] * B[1] - A[1] * B[0];
+    }
+
+    void TriangleNormal(const float* P0, const float* P1, const float* P2, double* Out)
+    {
+        const double e1[3] = { double(P1[0]) - P0[0], double(P1[1]) - P0[1], double(P1[2]) - P0[2] };
+        const double e2[3] = { double(P2[0]) - P0[0], double(P2[1]) - P0[1], double(P2[2]) - P0[2] };
+        Cross(e1, e2, Out);
+    }
+
+    // Moving From onto To turns a triangle around From by more than ~75 degrees
+    bool HasTriangleFlips(const EdgeAdjacency& Adjacency, const uint32_t* Indices, const float* Positions, size_t Stride, uint32_t From, uint32_t To)
+    {
+        const float* target = Positions + static_cast<size_t>(To) * Stride;
+
+        for (uint32_t i = Adjacency.Offsets[From]; i < Adjacency.Offsets[From + 1]; i++)
+        {
+            const uint32_t* triangle = Indices + static_cast<size_t>(Adjacency.Triangles[i]) * 3;
+            if (triangle[0] == To || triangle[1] == To || triangle[2] == To)
+                continue;
+
+            const float* corners[3];
+            const float* moved[3];
+            for (int c = 0; c < 3; c++)
+            {
+                corners[c] = Positions + static_cast<size_t>(triangle[c]) * Stride;
+                moved[c] = triangle[c] == From ? target : corners[c];
+            }
+
+            double before[3], after[3];
+            TriangleNormal(corners[0], corners[1], corners[2], before);
+            TriangleNormal(moved[0], moved[1], moved[2], after);
+
+            const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+            const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+                * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+            if (dot <= 0.25 * lengths)
+                return true;
+        }
+
+        return false;
+    }
+
+    struct Collapse
+    {
+        uint32_t From;
+        uint32_t To;
+        double Error;
+    };
+}
+
+size_t MeshSimplifier::Simplify(uint32_t* OutIndices, const uint32_t* Indices, size_t IndexCount, const float* Positions, size_t VertexCount, size_t PositionStride,
+    size_t TargetIndexCount, float TargetError, float* OutError)
+{
+    if (OutIndices != Indices)
+    {
+        memmove(OutIndices, Indices, IndexCount * sizeof(uint32_t));
+    }
+
+    if (OutError)
+    {
+        *OutError = 0.0f;
+    }
+
+    IndexCount -= IndexCount % 3;
+    if (IndexCount <= TargetIndexCount || VertexCount == 0)
+    {
+        return IndexCount;
+    }
+
+    std::vector<uint32_t> remap, wedge;
+    BuildPositionRemap(Positions, VertexCount, PositionStride, remap, wedge);
+
+    EdgeAdjacency adjacency;
+    adjacency.Build(OutIndices, IndexCount, VertexCount);
+
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> openOut, openIn;
+    ClassifyVertices(adjacency, remap, wedge, VertexCount, kinds, openOut, openIn);
+
+    // One quadric per position, every vertex at a position moves with it
+    std::vector<Quadric> quadrics(VertexCount, Quadric());
+    for (size_t t = 0; t < IndexCount / 3; t++)
+    {
+        const uint32_t* triangle = OutIndices + t * 3;
+        const float* p[3] = { Positions + triangle[0] * PositionStride, Positions + triangle[1] * PositionStride, Positions + triangle[2] * PositionStride };
+
+        double normal[3];
+        TriangleNormal(p[0], p[1], p[2], normal);
+        const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length == 0.0)
+            continue;
+
+        normal[0] /= length; normal[1] /= length; normal[2] /= length;
+        const double distance = -(normal[0] * p[0][0] + normal[1] * p[0][1] + normal[2] * p[0][2]);
+        for (int c = 0; c < 3; c++)
+        {
+            AddPlane(quadrics[remap[triangle[c]]], normal[0], normal[1], normal[2], distance, length * 0.5);
+        }
+
+        // Open edges also get the plane through them perpendicular to the surface
+        for (int e = 0; e < 3; e++)
+        {
+            const uint32_t from = triangle[e];
+            const uint32_t to = triangle[(e + 1) % 3];
+            if (adjacency.HasEdge(to, from))
+                continue;
+
+            const double edge[3] = { double(p[(e + 1) % 3][0]) - p[e][0], double(p[(e + 1) % 3][1]) - p[e][1], double(p[(e + 1) % 3][2]) - p[e][2] };
+            double edgeNormal[3];
+            Cross(edge, normal, edgeNormal);
+            const double edgeNormalLength = std::sqrt(edgeNormal[0] * edgeNormal[0] + edgeNormal[1] * edgeNormal[1] + edgeNormal[2] * edgeNormal[2]);
+            if (edgeNormalLength == 0.0)
+                continue;
+
+            edgeNormal[0] /= edgeNormalLength; edgeNormal[1] /= edgeNormalLength; edgeNormal[2] /= edgeNormalLength;
+            const double edgeDistance = -(edgeNormal[0] * p[e][0] + edgeNormal[1] * p[e][1] + edgeNormal[2] * p[e][2]);
+            const double weight = (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]) * BORDER_WEIGHT;
+            AddPlane(quadrics[remap[from]], edgeNormal[0], edgeNormal[1], edgeNormal[2], edgeDistance, weight);
+            AddPlane(quadrics[remap[to]], edgeNormal[0], edgeNormal[1], edgeNormal[2], edgeDistance, weight);
+        }
+    }
+
+    const double errorLimit = static_cast<double>(TargetError) * static_cast<double>(TargetError);
+    double resultError = 0.0;
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseRemap(VertexCount);
+    std::vector<uint8_t> collapseLocked(VertexCount);
+
+    // Twin of a seam vertex and the vertex it has to follow onto, NO_VERTEX when the seam can't collapse that way
+    auto GetSeamTwinTarget = [&](uint32_t From, uint32_t To)
+    {
+        const uint32_t twin = wedge[From];
+        const uint32_t twinTarget = openOut[From] == To ? openIn[twin] : openOut[twin];
+        return twinTarget < MANY_VERTICES && remap[twinTarget] == remap[To] && kinds[twinTarget] == KIND_SEAM ? twinTarget : NO_VERTEX;
+    };
+
+    auto CanCollapse = [&](uint32_t From, uint32_t To)
+    {
+        switch (kinds[From])
+        {
+        case KIND_MANIFOLD:
+            return true;
+        case KIND_BORDER:
+            return kinds[To] == KIND_BORDER && (openOut[From] == To || openIn[From] == To);
+        case KIND_SEAM:
+            return kinds[To] == KIND_SEAM && (openOut[From] == To || openIn[From] == To) && GetSeamTwinTarget(From, To) != NO_VERTEX;
+        default:
+            return false;
+        }
+    };
+
+    while (IndexCount > TargetIndexCount)
+    {
+        // Cheapest direction of every collapsible edge
+        collapses.clear();
+        for (size_t t = 0; t < IndexCount / 3; t++)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                const uint32_t a = OutIndices[t * 3 + e];
+                const uint32_t b = OutIndices[t * 3 + (e + 1) % 3];
+
+                // Closed edges show up in both of their triangles, take one
+                if (a > b && adjacency.HasEdge(b, a))
+                    continue;
+
+                const bool canCollapseA = CanCollapse(a, b);
+                const bool canCollapseB = CanCollapse(b, a);
+                if (!canCollapseA && !canCollapseB)
+                    continue;
+
+                const double errorA = canCollapseA ? EvaluateQuadric(quadrics[remap[a]], Positions + b * PositionStride) : 0.0;
+                const double errorB = canCollapseB ? EvaluateQuadric(quadrics[remap[b]], Positions + a * PositionStride) : 0.0;
+
+                if (canCollapseA && (!canCollapseB || errorA <= errorB))
+                    collapses.push_back({ a, b, errorA });
+                else
+                    collapses.push_back({ b, a, errorB });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& A, const Collapse& B) { return A.Error < B.Error; });
+
+        for (uint32_t v = 0; v < VertexCount; v++)
+        {
+            collapseRemap[v] = v;
+        }
+        std::fill(collapseLocked.begin(), collapseLocked.end(), uint8_t(0));
+
+        // Stop a pass once it likely reached the target, the next pass works on the new triangles
+        const size_t trianglesToRemove = (IndexCount - TargetIndexCount) / 3;
+        size_t trianglesRemoved = 0;
+        size_t collapseCount = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.Error > errorLimit || trianglesRemoved >= trianglesToRemove)
+                break;
+
+            const uint32_t from = collapse.From;
+            const uint32_t to = collapse.To;
+            if (collapseLocked[remap[from]] || collapseLocked[remap[to]])
+                continue;
+
+            const uint32_t twin = kinds[from] == KIND_SEAM ? wedge[from] : NO_VERTEX;
+            const uint32_t twinTarget = kinds[from] == KIND_SEAM ? GetSeamTwinTarget(from, to) : NO_VERTEX;
+
+            if (HasTriangleFlips(adjacency, OutIndices, Positions, PositionStride, from, to)
+                || (twin != NO_VERTEX && HasTriangleFlips(adjacency, OutIndices, Positions, PositionStride, twin, twinTarget)))
+            {
+                continue;
+            }
+
+            collapseRemap[from] = to;
+            if (twin != NO_VERTEX)
+            {
+                collapseRemap[twin] = twinTarget;
+            }
+
+            AddQuadric(quadrics[remap[to]], quadrics[remap[from]]);
+            collapseLocked[remap[from]] = 1;
+            collapseLocked[remap[to]] = 1;
+
+            // An interior or seam collapse closes the two triangles along the edge, a border collapse only one
+            trianglesRemoved += kinds[from] == KIND_BORDER ? 1 : 2;
+            resultError = std::max(resultError, collapse.Error);
+            collapseCount++;
+        }
+
+        if (collapseCount == 0)
+            break;
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < IndexCount; i += 3)
+        {
+            const uint32_t a = collapseRemap[OutIndices[i + 0]];
+            const uint32_t b = collapseRemap[OutIndices[i + 1]];
+            const uint32_t c = collapseRemap[OutIndices[i + 2]];
+
+            if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c])
+                continue;
+
+            OutIndices[writeIndex + 0] = a;
+            OutIndices[writeIndex + 1] = b;
+            OutIndices[writeIndex + 2] = c;
+            writeIndex += 3;
+        }
+        IndexCount = writeIndex;
+
+        adjacency.Build(OutIndices, IndexCount, VertexCount);
+    }
+
+    if (OutError)
+    {
+        *OutError = static_cast<float>(std::sqrt(resultError));
+    }
+
+    return IndexCount;
+}
@@ -0,0 +1,25 @@
+#ifndef __MeshSimplifier_h__
+#define __MeshSimplifier_h__
+
+#include <cstddef>
+#include <cstdint>
+
+// Quadric error metric edge collapse on indexed triangle lists (Garland and Heckbert).
+// Vertices are only ever collapsed onto other existing vertices, so a simplified index list draws with the original vertex buffer.
+class MeshSimplifier
+{
+public:
+
+	// Collapses edges until at most TargetIndexCount indices remain or the next collapse would move the surface further than TargetError.
+	// Positions holds PositionStride floats per vertex, x y z first. OutIndices needs room for IndexCount indices and may alias Indices.
+	// Vertices on open borders and on attribute seams (several vertices sharing one position, split by uv or normal) only slide
+	// along their border or seam, the seam vertices on both sides move together so uv seams and normal creases keep their shape.
+	// Returns the new index count, OutError receives the largest distance a collapse moved the surface, in position units.
+	static size_t Simplify(uint32_t* OutIndices, const uint32_t* Indices, size_t IndexCount, const float* Positions, size_t VertexCount, size_t PositionStride,
+		size_t TargetIndexCount, float TargetError, float* OutError = nullptr);
+
+	// Edge quadrics of borders and seams weigh this much more than the surface so the outline stays put
+	static constexpr float BORDER_WEIGHT = 10.0f;
+};
+
+#endif //__MeshSimplifier_h__
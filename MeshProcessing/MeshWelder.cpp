@@ -0,0 +1,183 @@
+#include "MeshWelder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    inline int64_t QuantizeComponent(float Value, float InvTolerance)
+    {
+        if (InvTolerance <= 0.0f)
+        {
+            // Exact welding, compare bit patterns. Adding +0 folds -0 into +0
+            Value += 0.0f;
+
+            uint32_t Bits;
+            memcpy(&Bits, &Value, sizeof(Bits));
+            return static_cast<int64_t>(Bits);
+        }
+
+        return static_cast<int64_t>(std::floor(static_cast<double>(Value) * InvTolerance + 0.5));
+    }
+
+    inline uint64_t MixBits(uint64_t Value)
+    {
+        // splitmix64 finalizer
+        Value ^= Value >> 30;
+        Value *= 0xbf58476d1ce4e5b9ull;
+        Value ^= Value >> 27;
+        Value *= 0x94d049bb133111ebull;
+        Value ^= Value >> 31;
+        return Value;
+    }
+
+    inline float GetInverseTolerance(float Tolerance)
+    {
+        return Tolerance > 0.0f ? 1.0f / Tolerance : 0.0f;
+    }
+}
+
+MeshWelder::MeshWelder(const Settings& InSettings, size_t ExpectedVertexCount)
+    : m_InvPositionTolerance(GetInverseTolerance(InSettings.PositionTolerance))
+    , m_InvNormalTolerance(GetInverseTolerance(InSettings.NormalTolerance))
+    , m_InvTexcoordTolerance(GetInverseTolerance(InSettings.TexcoordTolerance))
+    , m_SlotMask(0)
+{
+    // Keep the load factor at or below 0.5
+    size_t Capacity = 64;
+    while (Capacity < ExpectedVertexCount * 2)
+    {
+        Capacity <<= 1;
+    }
+
+    m_Slots.assign(Capacity, Slot{ 0, EMPTY_SLOT });
+    m_SlotMask = static_cast<uint32_t>(Capacity - 1);
+
+    m_Vertices.reserve(ExpectedVertexCount * KEY_COMPONENT_COUNT);
+}
+
+MeshWelder::~MeshWelder()
+{
+
+}
+
+uint32_t MeshWelder::AddVertex(const float* Position, const float* Normal, const float* Texcoord)
+{
+    int64_t Key[KEY_COMPONENT_COUNT];
+    MakeKey(Key, Position, Normal, Texcoord);
+
+    const uint32_t Hash = HashKey(Key);
+
+    uint32_t SlotIndex = Hash & m_SlotMask;
+    for (;;)
+    {
+        const Slot& Current = m_Slots[SlotIndex];
+        if (Current.VertexIndex == EMPTY_SLOT)
+            break;
+
+        if (Current.Hash == Hash)
+        {
+            int64_t ExistingKey[KEY_COMPONENT_COUNT];
+            MakeKey(ExistingKey, Current.VertexIndex);
+
+            if (memcmp(Key, ExistingKey, sizeof(Key)) == 0)
+                return Current.VertexIndex;
+        }
+
+        SlotIndex = (SlotIndex + 1) & m_SlotMask;
+    }
+
+    const uint32_t NewIndex = static_cast<uint32_t>(GetVertexCount());
+    m_Slots[SlotIndex] = Slot{ Hash, NewIndex };
+
+    m_Vertices.insert(m_Vertices.end(), Position, Position + 3);
+    m_Vertices.insert(m_Vertices.end(), Normal, Normal + 3);
+    m_Vertices.insert(m_Vertices.end(), Texcoord, Texcoord + 2);
+
+    if (static_cast<size_t>(NewIndex + 1) * 2 > m_Slots.size())
+    {
+        Grow();
+    }
+
+    return NewIndex;
+}
+
+void MeshWelder::Release(std::vector<float>& OutPositions, std::vector<float>& OutNormals, std::vector<float>& OutTexcoords)
+{
+    const size_t VertexCount = GetVertexCount();
+
+    OutPositions.resize(VertexCount * 3);
+    OutNormals.resize(VertexCount * 3);
+    OutTexcoords.resize(VertexCount * 2);
+
+    for (size_t i = 0; i < VertexCount; i++)
+    {
+        const float* Vertex = &m_Vertices[i * KEY_COMPONENT_COUNT];
+
+        std::copy(Vertex + 0, Vertex + 3, &OutPositions[i * 3]);
+        std::copy(Vertex + 3, Vertex + 6, &OutNormals[i * 3]);
+        std::copy(Vertex + 6, Vertex + 8, &OutTexcoords[i * 2]);
+    }
+
+    m_Vertices.clear();
+    m_Vertices.shrink_to_fit();
+
+    std::fill(m_Slots.begin(), m_Slots.end(), Slot{ 0, EMPTY_SLOT });
+}
+
+void MeshWelder::MakeKey(int64_t (&OutKey)[KEY_COMPONENT_COUNT], const float* Position, const float* Normal, const float* Texcoord) const
+{
+    OutKey[0] = QuantizeComponent(Position[0], m_InvPositionTolerance);
+    OutKey[1] = QuantizeComponent(Position[1], m_InvPositionTolerance);
+    OutKey[2] = QuantizeComponent(Position[2], m_InvPositionTolerance);
+    OutKey[3] = QuantizeComponent(Normal[0], m_InvNormalTolerance);
+    OutKey[4] = QuantizeComponent(Normal[1], m_InvNormalTolerance);
+    OutKey[5] = QuantizeComponent(Normal[2], m_InvNormalTolerance);
+    OutKey[6] = QuantizeComponent(Texcoord[0], m_InvTexcoordTolerance);
+    OutKey[7] = QuantizeComponent(Texcoord[1], m_InvTexcoordTolerance);
+}
+
+void MeshWelder::MakeKey(int64_t (&OutKey)[KEY_COMPONENT_COUNT], uint32_t VertexIndex) const
+{
+    const float* Vertex = &m_Vertices[static_cast<size_t>(VertexIndex) * KEY_COMPONENT_COUNT];
+    MakeKey(OutKey, Vertex + 0, Vertex + 3, Vertex + 6);
+}
+
+uint32_t MeshWelder::HashKey(const int64_t (&Key)[KEY_COMPONENT_COUNT])
+{
+    // Two independent multiply chains keep the latency low, one full mix at the end spreads the bits
+    uint64_t HashA = 0x9e3779b97f4a7c15ull;
+    uint64_t HashB = 0xc2b2ae3d27d4eb4full;
+    for (int i = 0; i < KEY_COMPONENT_COUNT; i += 2)
+    {
+        HashA = (HashA ^ static_cast<uint64_t>(Key[i + 0])) * 0xff51afd7ed558ccdull;
+        HashB = (HashB ^ static_cast<uint64_t>(Key[i + 1])) * 0xc4ceb9fe1a85ec53ull;
+    }
+
+    const uint64_t Hash = MixBits(HashA ^ (HashB << 29 | HashB >> 35));
+    return static_cast<uint32_t>(Hash ^ (Hash >> 32));
+}
+
+void MeshWelder::Grow()
+{
+    std::vector<Slot> OldSlots;
+    OldSlots.swap(m_Slots);
+
+    m_Slots.assign(OldSlots.size() * 2, Slot{ 0, EMPTY_SLOT });
+    m_SlotMask = static_cast<uint32_t>(m_Slots.size() - 1);
+
+    for (const Slot& OldSlot : OldSlots)
+    {
+        if (OldSlot.VertexIndex == EMPTY_SLOT)
+            continue;
+
+        uint32_t SlotIndex = OldSlot.Hash & m_SlotMask;
+        while (m_Slots[SlotIndex].VertexIndex != EMPTY_SLOT)
+        {
+            SlotIndex = (SlotIndex + 1) & m_SlotMask;
+        }
+
+        m_Slots[SlotIndex] = OldSlot;
+    }
+}
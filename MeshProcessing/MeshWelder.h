@@ -0,0 +1,74 @@
+#ifndef __MeshWelder_h__
+#define __MeshWelder_h__
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Merges identical face corners into shared vertices.
+// Attributes are quantized to the configured tolerance and looked up in an open-addressing hash table,
+// so every corner costs one hash and (usually) one probe instead of a tree walk.
+class MeshWelder
+{
+	static constexpr uint32_t EMPTY_SLOT = 0xffffffffu;
+	static constexpr int KEY_COMPONENT_COUNT = 8;
+
+public:
+
+	struct Settings
+	{
+		Settings()
+			: PositionTolerance(0.0f)
+			, NormalTolerance(0.0f)
+			, TexcoordTolerance(0.0f)
+		{
+		}
+
+		// Size of the quantization cell for each attribute. Values falling in the same cell are welded.
+		// 0 only welds bit-identical values (+0 and -0 are treated as equal).
+		float PositionTolerance;
+		float NormalTolerance;
+		float TexcoordTolerance;
+	};
+
+	explicit MeshWelder(const Settings& InSettings = Settings(), size_t ExpectedVertexCount = 0);
+	virtual ~MeshWelder();
+
+	MeshWelder(const MeshWelder&) = delete;
+	MeshWelder& operator = (const MeshWelder&) = delete;
+
+	// Returns the index of the welded vertex, appending a new one if no match exists.
+	// Position and Normal point to 3 floats, Texcoord to 2 floats.
+	uint32_t AddVertex(const float* Position, const float* Normal, const float* Texcoord);
+
+	size_t GetVertexCount() const { return m_Vertices.size() / KEY_COMPONENT_COUNT; }
+
+	// Copies the welded vertices out as separate streams and resets the welder
+	void Release(std::vector<float>& OutPositions, std::vector<float>& OutNormals, std::vector<float>& OutTexcoords);
+
+private:
+
+	struct Slot
+	{
+		uint32_t Hash;
+		uint32_t VertexIndex;
+	};
+
+	void MakeKey(int64_t (&OutKey)[KEY_COMPONENT_COUNT], const float* Position, const float* Normal, const float* Texcoord) const;
+	void MakeKey(int64_t (&OutKey)[KEY_COMPONENT_COUNT], uint32_t VertexIndex) const;
+	static uint32_t HashKey(const int64_t (&Key)[KEY_COMPONENT_COUNT]);
+
+	void Grow();
+
+	float m_InvPositionTolerance;
+	float m_InvNormalTolerance;
+	float m_InvTexcoordTolerance;
+
+	std::vector<Slot> m_Slots;
+	uint32_t m_SlotMask;
+
+	// Welded vertices kept interleaved (position, normal, texcoord) so a probe touches one cache line
+	std::vector<float> m_Vertices;
+};
+
+#endif //__MeshWelder_h__
@@ -0,0 +1,253 @@
+#include "MeshletBuilder.h"
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr uint32_t INVALID_INDEX = 0xffffffffu;
+
+    // Cones wider than this (normals more than ~84 degrees from the axis) are not worth testing
+    constexpr float MIN_CONE_DOT = 0.1f;
+
+    Pandu::Vector3 GetPosition(const float* Positions, size_t PositionStride, uint32_t Vertex)
+    {
+        const float* position = Positions + static_cast<size_t>(Vertex) * PositionStride;
+        return Pandu::Vector3(position[0], position[1], position[2]);
+    }
+
+    void ComputeCone(Meshlet& Out, const uint32_t* Indices, const float* Positions, size_t PositionStride)
+    {
+        std::vector<Pandu::Vector3> normals;
+        normals.reserve(Out.IndexCount / 3);
+
+        Pandu::Vector3 axis(0.0f, 0.0f, 0.0f);
+        for (uint32_t i = 0; i < Out.IndexCount; i += 3)
+        {
+            const Pandu::Vector3 p0 = GetPosition(Positions, PositionStride, Indices[i + 0]);
+            const Pandu::Vector3 p1 = GetPosition(Positions, PositionStride, Indices[i + 1]);
+            const Pandu::Vector3 p2 = GetPosition(Positions, PositionStride, Indices[i + 2]);
+
+            Pandu::Vector3 normal = (p1 - p0).Cross(p2 - p0);
+            if (!normal.Normalize())
+            {
+                normal = Pandu::Vector3(0.0f, 0.0f, 0.0f);
+            }
+
+            normals.push_back(normal);
+            axis += normal;
+        }
+
+        if (!axis.Normalize())
+            return;
+
+        float minDot = 1.0f;
+        for (const Pandu::Vector3& normal : normals)
+        {
+            if (!normal.IsZeroLength())
+                minDot = std::min(minDot, normal.Dot(axis));
+        }
+
+        if (minDot <= MIN_CONE_DOT)
+            return;
+
+        // Apex behind every triangle plane along the axis, a camera on the front side of any triangle is outside the cone
+        const Pandu::Vector3& center = Out.Bounds.GetCenter();
+        float maxT = 0.0f;
+        for (uint32_t i = 0; i < Out.IndexCount; i += 3)
+        {
+            const Pandu::Vector3& normal = normals[i / 3];
+            if (normal.IsZeroLength())
+                continue;
+
+            const Pandu::Vector3 p0 = GetPosition(Positions, PositionStride, Indices[i]);
+            const float t = (center - p0).Dot(normal) / axis.Dot(normal);
+            maxT = std::max(maxT, t);
+        }
+
+        Out.ConeApex = center - axis * maxT;
+        Out.ConeAxis = axis;
+        Out.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+Meshlet::Meshlet()
+    : FirstIndex(0)
+    , IndexCount(0)
+    , Bounds(Pandu::Vector3(0.0f, 0.0f, 0.0f), 0.0f)
+    , ConeApex(0.0f, 0.0f, 0.0f)
+    , ConeAxis(0.0f, 0.0f, 1.0f)
+    , ConeCutoff(1.0f)
+{
+}
+
+bool Meshlet::IsBackFacing(const Pandu::Vector3& CameraPosition) const
+{
+    if (ConeCutoff >= 1.0f)
+        return false;
+
+    Pandu::Vector3 view = ConeApex - CameraPosition;
+    if (!view.Normalize())
+        return false;
+
+    return view.Dot(ConeAxis) >= ConeCutoff;
+}
+
+void MeshletBuilder::Build(uint32_t* Indices, size_t IndexCount, const float* Positions, size_t VertexCount, size_t PositionStride,
+    std::vector<Meshlet>& OutMeshlets, uint32_t MaxVertices, uint32_t MaxTriangles)
+{
+    OutMeshlets.clear();
+
+    const size_t triangleCount = IndexCount / 3;
+    if (triangleCount == 0 || MaxVertices < 3 || MaxTriangles == 0)
+        return;
+
+    // Triangles around every vertex
+    std::vector<uint32_t> offsets(VertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+        offsets[Indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < VertexCount; v++)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+
+    std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            vertexTriangles[fill[Indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    // Triangles not yet placed in a meshlet, per vertex
+    std::vector<uint32_t> liveTriangles(VertexCount);
+    for (size_t v = 0; v < VertexCount; v++)
+    {
+        liveTriangles[v] = offsets[v + 1] - offsets[v];
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(VertexCount, INVALID_INDEX);
+    std::vector<uint32_t> order;
+    order.reserve(triangleCount);
+
+    std::vector<uint32_t> meshletVertices;
+    meshletVertices.reserve(MaxVertices);
+
+    size_t seedCursor = 0;
+    uint32_t meshletTriangles = 0;
+    uint32_t meshletIndex = 0;
+
+    auto CountNewVertices = [&](uint32_t Triangle)
+    {
+        uint32_t count = 0;
+        for (int c = 0; c < 3; c++)
+        {
+            count += vertexMeshlet[Indices[Triangle * 3 + c]] != meshletIndex ? 1 : 0;
+        }
+        return count;
+    };
+
+    auto FlushMeshlet = [&]()
+    {
+        Meshlet meshlet;
+        meshlet.FirstIndex = static_cast<uint32_t>((order.size() - meshletTriangles) * 3);
+        meshlet.IndexCount = meshletTriangles * 3;
+        OutMeshlets.push_back(meshlet);
+
+        meshletVertices.clear();
+        meshletTriangles = 0;
+        meshletIndex++;
+    };
+
+    while (order.size() < triangleCount)
+    {
+        // Best triangle sharing a vertex with the meshlet: fewest new vertices, then the one finishing off the most vertices
+        uint32_t best = INVALID_INDEX;
+        uint32_t bestNewVertices = 4;
+        uint32_t bestLive = 0;
+        for (uint32_t vertex : meshletVertices)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+
+            for (uint32_t i = offsets[vertex]; i < offsets[vertex + 1]; i++)
+            {
+                const uint32_t triangle = vertexTriangles[i];
+                if (emitted[triangle])
+                    continue;
+
+                const uint32_t newVertices = CountNewVertices(triangle);
+                if (meshletVertices.size() + newVertices > MaxVertices)
+                    continue;
+
+                const uint32_t* corners = Indices + static_cast<size_t>(triangle) * 3;
+                const uint32_t live = liveTriangles[corners[0]] + liveTriangles[corners[1]] + liveTriangles[corners[2]];
+                if (newVertices < bestNewVertices || (newVertices == bestNewVertices && live < bestLive))
+                {
+                    best = triangle;
+                    bestNewVertices = newVertices;
+                    bestLive = live;
+                }
+            }
+        }
+
+        if (best == INVALID_INDEX)
+        {
+            // A full meshlet or a finished island, a new meshlet starts at the next triangle in input order
+            if (meshletTriangles > 0)
+            {
+                FlushMeshlet();
+                continue;
+            }
+
+            while (emitted[seedCursor])
+            {
+                seedCursor++;
+            }
+            best = static_cast<uint32_t>(seedCursor);
+        }
+
+        emitted[best] = 1;
+        order.push_back(best);
+        meshletTriangles++;
+
+        for (int c = 0; c < 3; c++)
+        {
+            const uint32_t vertex = Indices[best * 3 + c];
+            liveTriangles[vertex]--;
+            if (vertexMeshlet[vertex] != meshletIndex)
+            {
+                vertexMeshlet[vertex] = meshletIndex;
+                meshletVertices.push_back(vertex);
+            }
+        }
+
+        if (meshletTriangles == MaxTriangles)
+        {
+            FlushMeshlet();
+        }
+    }
+
+    if (meshletTriangles > 0)
+    {
+        FlushMeshlet();
+    }
+
+    std::vector<uint32_t> reordered(triangleCount * 3);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        std::copy(Indices + static_cast<size_t>(order[t]) * 3, Indices + static_cast<size_t>(order[t]) * 3 + 3, reordered.begin() + t * 3);
+    }
+    std::copy(reordered.begin(), reordered.end(), Indices);
+
+    for (Meshlet& meshlet : OutMeshlets)
+    {
+        meshlet.Bounds = MeshBounds::Compute(Positions, PositionStride, Indices + meshlet.FirstIndex, meshlet.IndexCount).Sphere;
+        ComputeCone(meshlet, Indices + meshlet.FirstIndex, Positions, PositionStride);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef __MeshletBuilder_h__
+#define __MeshletBuilder_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <PANDUSphere.h>
+#include <PANDUVector3.h>
+
+// Small connected cluster of triangles, one contiguous index range that can be culled and drawn on its own
+struct Meshlet
+{
+	Meshlet();
+
+	// Every triangle faces away from a camera at CameraPosition, in the space of the meshlet positions
+	bool IsBackFacing(const Pandu::Vector3& CameraPosition) const;
+
+	uint32_t FirstIndex;
+	uint32_t IndexCount;
+
+	Pandu::Sphere Bounds;
+
+	// Normal cone: all triangle normals lie within acos(ConeCutoff) + 90 degrees of ConeAxis seen from ConeApex.
+	// ConeCutoff 1 when the normals spread too far for the cone to cull anything.
+	Pandu::Vector3 ConeApex;
+	Pandu::Vector3 ConeAxis;
+	float ConeCutoff;
+};
+
+class MeshletBuilder
+{
+public:
+
+	// Reorders the triangles of Indices into meshlets of at most MaxVertices unique vertices and MaxTriangles triangles.
+	// Meshlets grow over shared edges from a seed triangle, preferring triangles that add the fewest new vertices,
+	// seeds follow the incoming triangle order so a cache optimized list yields spatially coherent meshlets.
+	// Positions holds PositionStride floats per vertex, x y z first. Meshlet ranges are relative to Indices.
+	static void Build(uint32_t* Indices, size_t IndexCount, const float* Positions, size_t VertexCount, size_t PositionStride,
+		std::vector<Meshlet>& OutMeshlets, uint32_t MaxVertices = MAX_VERTICES, uint32_t MaxTriangles = MAX_TRIANGLES);
+
+	// Sized so a meshlet fits the vertex and primitive limits mesh shading hardware commonly prefers
+	static constexpr uint32_t MAX_VERTICES = 64;
+	static constexpr uint32_t MAX_TRIANGLES = 124;
+};
+
+#endif //__MeshletBuilder_h__
@@ -0,0 +1,174 @@
+#include "NormalGenerator.h"
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Unit face normals and the corner angles that weigh them, one array per component
+    struct FaceData
+    {
+        std::vector<float> NormalX, NormalY, NormalZ;
+        std::vector<float> CornerAngles;
+    };
+
+    float ClampedAcos(float Value)
+    {
+        return std::acos(std::max(-1.0f, std::min(1.0f, Value)));
+    }
+
+    void ComputeFaceBatch(const float* Positions, const uint32_t* PositionIndices, size_t FirstTriangle, size_t EndTriangle, FaceData& Faces)
+    {
+        const size_t count = EndTriangle - FirstTriangle;
+
+        // Edges gathered first, the arithmetic below then runs over plain arrays
+        std::vector<float> edges(count * 12);
+        float* e1x = edges.data() + count * 0;
+        float* e1y = edges.data() + count * 1;
+        float* e1z = edges.data() + count * 2;
+        float* e2x = edges.data() + count * 3;
+        float* e2y = edges.data() + count * 4;
+        float* e2z = edges.data() + count * 5;
+        float* e3x = edges.data() + count * 6;
+        float* e3y = edges.data() + count * 7;
+        float* e3z = edges.data() + count * 8;
+        float* l1 = edges.data() + count * 9;
+        float* l2 = edges.data() + count * 10;
+        float* l3 = edges.data() + count * 11;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t* triangle = PositionIndices + (FirstTriangle + i) * 3;
+            const float* p0 = Positions + static_cast<size_t>(triangle[0]) * 3;
+            const float* p1 = Positions + static_cast<size_t>(triangle[1]) * 3;
+            const float* p2 = Positions + static_cast<size_t>(triangle[2]) * 3;
+
+            e1x[i] = p1[0] - p0[0]; e1y[i] = p1[1] - p0[1]; e1z[i] = p1[2] - p0[2];
+            e2x[i] = p2[0] - p1[0]; e2y[i] = p2[1] - p1[1]; e2z[i] = p2[2] - p1[2];
+            e3x[i] = p0[0] - p2[0]; e3y[i] = p0[1] - p2[1]; e3z[i] = p0[2] - p2[2];
+        }
+
+        float* nx = Faces.NormalX.data() + FirstTriangle;
+        float* ny = Faces.NormalY.data() + FirstTriangle;
+        float* nz = Faces.NormalZ.data() + FirstTriangle;
+        for (size_t i = 0; i < count; i++)
+        {
+            const float x = e1y[i] * e2z[i] - e1z[i] * e2y[i];
+            const float y = e1z[i] * e2x[i] - e1x[i] * e2z[i];
+            const float z = e1x[i] * e2y[i] - e1y[i] * e2x[i];
+            const float length = std::sqrt(x * x + y * y + z * z);
+            const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            nx[i] = x * scale;
+            ny[i] = y * scale;
+            nz[i] = z * scale;
+
+            l1[i] = std::sqrt(e1x[i] * e1x[i] + e1y[i] * e1y[i] + e1z[i] * e1z[i]);
+            l2[i] = std::sqrt(e2x[i] * e2x[i] + e2y[i] * e2y[i] + e2z[i] * e2z[i]);
+            l3[i] = std::sqrt(e3x[i] * e3x[i] + e3y[i] * e3y[i] + e3z[i] * e3z[i]);
+        }
+
+        // Angle at each corner between its outgoing edge and the reversed incoming one
+        float* angles = Faces.CornerAngles.data() + FirstTriangle * 3;
+        for (size_t i = 0; i < count; i++)
+        {
+            const float d0 = -(e1x[i] * e3x[i] + e1y[i] * e3y[i] + e1z[i] * e3z[i]);
+            const float d1 = -(e2x[i] * e1x[i] + e2y[i] * e1y[i] + e2z[i] * e1z[i]);
+            const float d2 = -(e3x[i] * e2x[i] + e3y[i] * e2y[i] + e3z[i] * e2z[i]);
+            const float s0 = l1[i] * l3[i], s1 = l2[i] * l1[i], s2 = l3[i] * l2[i];
+            angles[i * 3 + 0] = s0 > 0.0f ? ClampedAcos(d0 / s0) : 0.0f;
+            angles[i * 3 + 1] = s1 > 0.0f ? ClampedAcos(d1 / s1) : 0.0f;
+            angles[i * 3 + 2] = s2 > 0.0f ? ClampedAcos(d2 / s2) : 0.0f;
+        }
+    }
+}
+
+void NormalGenerator::Generate(const float* Positions, size_t PositionCount, const uint32_t* PositionIndices, size_t CornerCount, float CreaseAngle,
+    float* OutNormals, uint32_t ThreadCount)
+{
+    const size_t triangleCount = CornerCount / 3;
+
+    FaceData faces;
+    faces.NormalX.resize(triangleCount);
+    faces.NormalY.resize(triangleCount);
+    faces.NormalZ.resize(triangleCount);
+    faces.CornerAngles.resize(triangleCount * 3);
+
+    const size_t faceBatchCount = (triangleCount + BATCH_SIZE - 1) / BATCH_SIZE;
+    ParallelUtils::For(faceBatchCount, ThreadCount, [&](size_t Batch)
+    {
+        const size_t firstTriangle = Batch * BATCH_SIZE;
+        ComputeFaceBatch(Positions, PositionIndices, firstTriangle, std::min(firstTriangle + BATCH_SIZE, triangleCount), faces);
+    });
+
+    // Corners around every position
+    std::vector<uint32_t> offsets(PositionCount + 1, 0);
+    for (size_t c = 0; c < triangleCount * 3; c++)
+    {
+        offsets[PositionIndices[c] + 1]++;
+    }
+    for (size_t p = 0; p < PositionCount; p++)
+    {
+        offsets[p + 1] += offsets[p];
+    }
+
+    std::vector<uint32_t> positionCorners(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t c = 0; c < triangleCount * 3; c++)
+        {
+            positionCorners[fill[PositionIndices[c]]++] = static_cast<uint32_t>(c);
+        }
+    }
+
+    const float creaseCos = std::cos(CreaseAngle);
+
+    const size_t positionBatchCount = (PositionCount + BATCH_SIZE - 1) / BATCH_SIZE;
+    ParallelUtils::For(positionBatchCount, ThreadCount, [&](size_t Batch)
+    {
+        const size_t endPosition = std::min((Batch + 1) * BATCH_SIZE, PositionCount);
+        for (size_t p = Batch * BATCH_SIZE; p < endPosition; p++)
+        {
+            for (uint32_t i = offsets[p]; i < offsets[p + 1]; i++)
+            {
+                const uint32_t corner = positionCorners[i];
+                const uint32_t face = corner / 3;
+                const float fx = faces.NormalX[face], fy = faces.NormalY[face], fz = faces.NormalZ[face];
+
+                // Degenerate faces have no direction of their own and take every face around the position
+                const bool degenerate = fx == 0.0f && fy == 0.0f && fz == 0.0f;
+
+                float x = 0.0f, y = 0.0f, z = 0.0f;
+                for (uint32_t j = offsets[p]; j < offsets[p + 1]; j++)
+                {
+                    const uint32_t other = positionCorners[j];
+                    const uint32_t otherFace = other / 3;
+                    const float ox = faces.NormalX[otherFace], oy = faces.NormalY[otherFace], oz = faces.NormalZ[otherFace];
+                    if (!degenerate && fx * ox + fy * oy + fz * oz < creaseCos)
+                        continue;
+
+                    const float weight = faces.CornerAngles[other];
+                    x += ox * weight;
+                    y += oy * weight;
+                    z += oz * weight;
+                }
+
+                const float length = std::sqrt(x * x + y * y + z * z);
+                float* normal = OutNormals + static_cast<size_t>(corner) * 3;
+                if (length > 0.0f)
+                {
+                    normal[0] = x / length;
+                    normal[1] = y / length;
+                    normal[2] = z / length;
+                }
+                else
+                {
+                    normal[0] = 0.0f;
+                    normal[1] = 0.0f;
+                    normal[2] = 1.0f;
+                }
+            }
+        }
+    });
+}
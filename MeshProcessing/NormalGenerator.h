@@ -0,0 +1,23 @@
+#ifndef __NormalGenerator_h__
+#define __NormalGenerator_h__
+
+#include <cstddef>
+#include <cstdint>
+
+// Smooth vertex normals for triangle lists that come without any
+class NormalGenerator
+{
+public:
+
+	// Writes one unit normal per corner, 3 floats each. PositionIndices holds a position index for every corner, 3 per triangle,
+	// Positions holds x y z per position. Every corner gets the angle weighted average of the face normals around its position
+	// that lie within CreaseAngle radians of its own face, so edges sharper than that stay hard.
+	// Corners only smooth with corners referencing the same position index, duplicated positions stay separate.
+	static void Generate(const float* Positions, size_t PositionCount, const uint32_t* PositionIndices, size_t CornerCount, float CreaseAngle,
+		float* OutNormals, uint32_t ThreadCount = 0);
+
+	// Triangles and positions per task, the face pass works on structure of arrays batches the compiler can vectorize
+	static constexpr size_t BATCH_SIZE = 4096;
+};
+
+#endif //__NormalGenerator_h__
@@ -0,0 +1,83 @@
+#ifndef __ParallelUtils_h__
+#define __ParallelUtils_h__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class ParallelUtils
+{
+public:
+
+	// Web builds without pthreads have no worker threads, everything runs inline there
+	static constexpr bool HasThreads()
+	{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+		return false;
+#else
+		return true;
+#endif
+	}
+
+	// 0 means one worker per hardware thread
+	static uint32_t GetWorkerCount(uint32_t RequestedCount)
+	{
+		if (!HasThreads())
+			return 1;
+
+		if (RequestedCount == 0)
+		{
+			RequestedCount = std::thread::hardware_concurrency();
+		}
+
+		return RequestedCount > 0 ? RequestedCount : 1;
+	}
+
+	// Runs Task(TaskIndex) for every index in [0, TaskCount) on up to WorkerCount threads, the calling thread included.
+	// Tasks are handed out dynamically so uneven tasks still balance.
+	template <typename TaskType>
+	static void For(size_t TaskCount, uint32_t WorkerCount, const TaskType& Task)
+	{
+		WorkerCount = GetWorkerCount(WorkerCount);
+		if (WorkerCount > TaskCount)
+		{
+			WorkerCount = static_cast<uint32_t>(TaskCount);
+		}
+
+		if (WorkerCount <= 1)
+		{
+			for (size_t i = 0; i < TaskCount; i++)
+			{
+				Task(i);
+			}
+			return;
+		}
+
+		std::atomic<size_t> NextTask(0);
+		auto Worker = [&]()
+		{
+			for (size_t i = NextTask++; i < TaskCount; i = NextTask++)
+			{
+				Task(i);
+			}
+		};
+
+		std::vector<std::thread> Threads;
+		Threads.reserve(WorkerCount - 1);
+		for (uint32_t i = 1; i < WorkerCount; i++)
+		{
+			Threads.emplace_back(Worker);
+		}
+
+		Worker();
+
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+	}
+};
+
+#endif //__ParallelUtils_h__
@@ -0,0 +1,168 @@
+#include "TangentGenerator.h"
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Unit tangent and bitangent of a triangle, zero when its uvs are degenerate
+    struct TriangleFrame
+    {
+        float Tangent[3];
+        float Bitangent[3];
+    };
+
+    float Normalize(float* Vector)
+    {
+        const float length = std::sqrt(Vector[0] * Vector[0] + Vector[1] * Vector[1] + Vector[2] * Vector[2]);
+        const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        Vector[0] *= scale;
+        Vector[1] *= scale;
+        Vector[2] *= scale;
+        return length;
+    }
+
+    float CornerAngle(const float* Corner, const float* Next, const float* Previous)
+    {
+        float a[3] = { Next[0] - Corner[0], Next[1] - Corner[1], Next[2] - Corner[2] };
+        float b[3] = { Previous[0] - Corner[0], Previous[1] - Corner[1], Previous[2] - Corner[2] };
+        if (Normalize(a) == 0.0f || Normalize(b) == 0.0f)
+            return 0.0f;
+
+        const float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        return std::acos(std::max(-1.0f, std::min(1.0f, d)));
+    }
+
+    void ComputeFrame(const float* Positions, const float* Texcoords, const uint32_t* Triangle, TriangleFrame& Out)
+    {
+        const float* p0 = Positions + static_cast<size_t>(Triangle[0]) * 3;
+        const float* p1 = Positions + static_cast<size_t>(Triangle[1]) * 3;
+        const float* p2 = Positions + static_cast<size_t>(Triangle[2]) * 3;
+        const float* t0 = Texcoords + static_cast<size_t>(Triangle[0]) * 2;
+        const float* t1 = Texcoords + static_cast<size_t>(Triangle[1]) * 2;
+        const float* t2 = Texcoords + static_cast<size_t>(Triangle[2]) * 2;
+
+        const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        const float du1 = t1[0] - t0[0], dv1 = t1[1] - t0[1];
+        const float du2 = t2[0] - t0[0], dv2 = t2[1] - t0[1];
+
+        // The sign of the uv area picks the bitangent direction, its size drops out with the normalization
+        const float area = du1 * dv2 - du2 * dv1;
+        const float sign = area < 0.0f ? -1.0f : 1.0f;
+        for (int c = 0; c < 3; c++)
+        {
+            Out.Tangent[c] = (e1[c] * dv2 - e2[c] * dv1) * sign;
+            Out.Bitangent[c] = (e2[c] * du1 - e1[c] * du2) * sign;
+        }
+
+        if (area == 0.0f || Normalize(Out.Tangent) == 0.0f || Normalize(Out.Bitangent) == 0.0f)
+        {
+            std::fill(Out.Tangent, Out.Tangent + 3, 0.0f);
+            std::fill(Out.Bitangent, Out.Bitangent + 3, 0.0f);
+        }
+    }
+}
+
+void TangentGenerator::Generate(const float* Positions, const float* Normals, const float* Texcoords, size_t VertexCount,
+    const uint32_t* Indices, size_t IndexCount, float* OutTangents, uint32_t ThreadCount)
+{
+    const size_t triangleCount = IndexCount / 3;
+
+    std::vector<TriangleFrame> frames(triangleCount);
+    std::vector<float> cornerAngles(triangleCount * 3);
+
+    const size_t triangleBatchCount = (triangleCount + BATCH_SIZE - 1) / BATCH_SIZE;
+    ParallelUtils::For(triangleBatchCount, ThreadCount, [&](size_t Batch)
+    {
+        const size_t endTriangle = std::min((Batch + 1) * BATCH_SIZE, triangleCount);
+        for (size_t t = Batch * BATCH_SIZE; t < endTriangle; t++)
+        {
+            const uint32_t* triangle = Indices + t * 3;
+            ComputeFrame(Positions, Texcoords, triangle, frames[t]);
+
+            for (int c = 0; c < 3; c++)
+            {
+                cornerAngles[t * 3 + c] = CornerAngle(Positions + static_cast<size_t>(triangle[c]) * 3,
+                    Positions + static_cast<size_t>(triangle[(c + 1) % 3]) * 3, Positions + static_cast<size_t>(triangle[(c + 2) % 3]) * 3);
+            }
+        }
+    });
+
+    // Corners around every vertex, each vertex then gathers its own sums without atomics
+    std::vector<uint32_t> offsets(VertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+        offsets[Indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < VertexCount; v++)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+
+    std::vector<uint32_t> vertexCorners(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            vertexCorners[fill[Indices[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    const size_t vertexBatchCount = (VertexCount + BATCH_SIZE - 1) / BATCH_SIZE;
+    ParallelUtils::For(vertexBatchCount, ThreadCount, [&](size_t Batch)
+    {
+        const size_t endVertex = std::min((Batch + 1) * BATCH_SIZE, VertexCount);
+        for (size_t v = Batch * BATCH_SIZE; v < endVertex; v++)
+        {
+            float tangent[3] = { 0.0f, 0.0f, 0.0f };
+            float bitangent[3] = { 0.0f, 0.0f, 0.0f };
+            for (uint32_t i = offsets[v]; i < offsets[v + 1]; i++)
+            {
+                const uint32_t corner = vertexCorners[i];
+                const TriangleFrame& frame = frames[corner / 3];
+                const float weight = cornerAngles[corner];
+                for (int c = 0; c < 3; c++)
+                {
+                    tangent[c] += frame.Tangent[c] * weight;
+                    bitangent[c] += frame.Bitangent[c] * weight;
+                }
+            }
+
+            // Gram-Schmidt against the vertex normal
+            const float* normal = Normals + v * 3;
+            const float projection = normal[0] * tangent[0] + normal[1] * tangent[1] + normal[2] * tangent[2];
+            for (int c = 0; c < 3; c++)
+            {
+                tangent[c] -= normal[c] * projection;
+            }
+
+            if (Normalize(tangent) == 0.0f)
+            {
+                // Any direction orthogonal to the normal, built from the axis the normal is least aligned with
+                const float axis[3] = { std::fabs(normal[0]) < 0.9f ? 1.0f : 0.0f, std::fabs(normal[0]) < 0.9f ? 0.0f : 1.0f, 0.0f };
+                const float axisProjection = normal[0] * axis[0] + normal[1] * axis[1] + normal[2] * axis[2];
+                for (int c = 0; c < 3; c++)
+                {
+                    tangent[c] = axis[c] - normal[c] * axisProjection;
+                }
+                Normalize(tangent);
+            }
+
+            const float cross[3] =
+            {
+                normal[1] * tangent[2] - normal[2] * tangent[1],
+                normal[2] * tangent[0] - normal[0] * tangent[2],
+                normal[0] * tangent[1] - normal[1] * tangent[0],
+            };
+
+            float* out = OutTangents + v * 4;
+            out[0] = tangent[0];
+            out[1] = tangent[1];
+            out[2] = tangent[2];
+            out[3] = cross[0] * bitangent[0] + cross[1] * bitangent[1] + cross[2] * bitangent[2] < 0.0f ? -1.0f : 1.0f;
+        }
+    });
+}
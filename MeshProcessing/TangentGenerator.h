@@ -0,0 +1,23 @@
+#ifndef __TangentGenerator_h__
+#define __TangentGenerator_h__
+
+#include <cstddef>
+#include <cstdint>
+
+// Per vertex tangent frames for sampling tangent space normal maps
+class TangentGenerator
+{
+public:
+
+	// Writes 4 floats per vertex: the unit tangent along +u, orthogonal to the vertex normal, and the bitangent sign in w,
+	// bitangent = w * cross(normal, tangent). That is the convention of MikkTSpace, which standard bakers use.
+	// Positions and Normals hold 3 floats per vertex, Texcoords 2. Each vertex averages the normalized tangents of its
+	// triangles weighted by the corner angle. Vertices without usable uvs get any tangent orthogonal to the normal.
+	static void Generate(const float* Positions, const float* Normals, const float* Texcoords, size_t VertexCount,
+		const uint32_t* Indices, size_t IndexCount, float* OutTangents, uint32_t ThreadCount = 0);
+
+	// Triangles and vertices per task
+	static constexpr size_t BATCH_SIZE = 4096;
+};
+
+#endif //__TangentGenerator_h__
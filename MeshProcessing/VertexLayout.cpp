@@ -0,0 +1,110 @@
+#include "VertexLayout.h"
+
+VertexLayout::VertexLayout()
+    : m_Attributes()
+    , m_AttributeCount(0)
+    , m_Stride(0)
+{
+
+}
+
+bool VertexLayout::AddAttribute(Semantic AttributeSemantic, Format AttributeFormat, uint32_t ShaderLocation)
+{
+    if (m_AttributeCount >= MAX_ATTRIBUTES)
+    {
+        return false;
+    }
+
+    Attribute& attribute = m_Attributes[m_AttributeCount++];
+    attribute.AttributeSemantic = AttributeSemantic;
+    attribute.AttributeFormat = AttributeFormat;
+    attribute.Offset = static_cast<uint16_t>(m_Stride);
+    attribute.ShaderLocation = ShaderLocation;
+
+    m_Stride += GetFormatSize(AttributeFormat);
+    return true;
+}
+
+int VertexLayout::FindAttribute(Semantic AttributeSemantic) const
+{
+    for (uint32_t i = 0; i < m_AttributeCount; i++)
+    {
+        if (m_Attributes[i].AttributeSemantic == AttributeSemantic)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool VertexLayout::operator == (const VertexLayout& Other) const
+{
+    if (m_AttributeCount != Other.m_AttributeCount || m_Stride != Other.m_Stride)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_AttributeCount; i++)
+    {
+        const Attribute& a = m_Attributes[i];
+        const Attribute& b = Other.m_Attributes[i];
+        if (a.AttributeSemantic != b.AttributeSemantic || a.AttributeFormat != b.AttributeFormat || a.Offset != b.Offset || a.ShaderLocation != b.ShaderLocation)
+            return false;
+    }
+    return true;
+}
+
+uint32_t VertexLayout::GetFormatSize(Format AttributeFormat)
+{
+    switch (AttributeFormat)
+    {
+    case Format::Float32x2: return 2 * sizeof(float);
+    case Format::Float32x3: return 3 * sizeof(float);
+    case Format::Float32x4: return 4 * sizeof(float);
+    case Format::Snorm16x2: return 2 * sizeof(int16_t);
+    case Format::Snorm16x4: return 4 * sizeof(int16_t);
+    case Format::Float16x2: return 2 * sizeof(uint16_t);
+    case Format::Float16x4: return 4 * sizeof(uint16_t);
+    }
+    return 0;
+}
+
+uint32_t VertexLayout::GetFormatComponentCount(Format AttributeFormat)
+{
+    switch (AttributeFormat)
+    {
+    case Format::Float32x2: return 2;
+    case Format::Float32x3: return 3;
+    case Format::Float32x4: return 4;
+    case Format::Snorm16x2: return 2;
+    case Format::Snorm16x4: return 4;
+    case Format::Float16x2: return 2;
+    case Format::Float16x4: return 4;
+    }
+    return 0;
+}
+
+VertexLayout VertexLayout::CreateDefault(bool Tangents)
+{
+    VertexLayout layout;
+    layout.AddAttribute(Semantic::Position, Format::Float32x3, 0);
+    layout.AddAttribute(Semantic::Normal, Format::Float32x3, 1);
+    layout.AddAttribute(Semantic::Color, Format::Float32x3, 2);
+    layout.AddAttribute(Semantic::Texcoord, Format::Float32x2, 3);
+    if (Tangents)
+    {
+        layout.AddAttribute(Semantic::Tangent, Format::Float32x4, TANGENT_LOCATION);
+    }
+    return layout;
+}
+
+VertexLayout VertexLayout::CreateCompact(bool Tangents)
+{
+    VertexLayout layout;
+    layout.AddAttribute(Semantic::Position, Format::Snorm16x4, 0);
+    layout.AddAttribute(Semantic::Normal, Format::Snorm16x2, 1);
+    layout.AddAttribute(Semantic::Texcoord, Format::Float16x2, 3);
+    if (Tangents)
+    {
+        layout.AddAttribute(Semantic::Tangent, Format::Snorm16x4, TANGENT_LOCATION);
+    }
+    return layout;
+}
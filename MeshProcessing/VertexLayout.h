@@ -0,0 +1,80 @@
+#ifndef __VertexLayout_h__
+#define __VertexLayout_h__
+
+#include <cstddef>
+#include <cstdint>
+
+// Describes one interleaved GPU vertex: which attributes it carries, in which format and at which offset.
+// The loader packs vertices with it and the renderer builds its WGPUVertexBufferLayout from the same description,
+// so both always agree. Plain data, it can be hashed and written to cooked files as is.
+class VertexLayout
+{
+public:
+
+	enum class Semantic : uint8_t
+	{
+		Position,
+		Normal,
+		Color,		// No source stream, always filled with white
+		Texcoord,
+		Tangent,	// xyz tangent, w bitangent sign
+	};
+
+	enum class Format : uint8_t
+	{
+		Float32x2,
+		Float32x3,
+		Float32x4,
+		Snorm16x2,	// Signed 16 bit, read as [-1, 1] by the shader
+		Snorm16x4,
+		Float16x2,
+		Float16x4,
+	};
+
+	struct Attribute
+	{
+		Semantic AttributeSemantic;
+		Format AttributeFormat;
+		uint16_t Offset;
+		uint32_t ShaderLocation;
+	};
+
+	static constexpr uint32_t MAX_ATTRIBUTES = 8;
+
+	VertexLayout();
+
+	// Appends the attribute right after the previous one. Returns false when the layout is full.
+	bool AddAttribute(Semantic AttributeSemantic, Format AttributeFormat, uint32_t ShaderLocation);
+
+	uint32_t GetStride() const { return m_Stride; }
+	uint32_t GetAttributeCount() const { return m_AttributeCount; }
+	const Attribute& GetAttribute(uint32_t Index) const { return m_Attributes[Index]; }
+
+	// Index of the first attribute with this semantic, -1 when there is none
+	int FindAttribute(Semantic AttributeSemantic) const;
+
+	bool operator == (const VertexLayout& Other) const;
+	bool operator != (const VertexLayout& Other) const { return !(*this == Other); }
+
+	static uint32_t GetFormatSize(Format AttributeFormat);
+	static uint32_t GetFormatComponentCount(Format AttributeFormat);
+
+	// float3 position, float3 normal, float3 color, float2 uv at shader locations 0-3, what the default pipeline expects.
+	// Tangents adds a float4 tangent at location 4 for normal mapping.
+	static VertexLayout CreateDefault(bool Tangents = false);
+
+	// 16 bytes instead of 44: snorm16x4 position relative to the mesh bounds, octahedral snorm16x2 normal and half float uv
+	// at locations 0, 1 and 3. There is no color, the compact pipeline uses white. Tangents adds a snorm16x4 tangent at location 4.
+	static VertexLayout CreateCompact(bool Tangents = false);
+
+	// Shader location of the optional tangent attribute in both layouts
+	static constexpr uint32_t TANGENT_LOCATION = 4;
+
+private:
+
+	Attribute m_Attributes[MAX_ATTRIBUTES];
+	uint32_t m_AttributeCount;
+	uint32_t m_Stride;
+};
+
+#endif //__VertexLayout_h__
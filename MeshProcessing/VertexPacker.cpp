@@ -0,0 +1,250 @@
+#include "VertexPacker.h"
+#include "ParallelUtils.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    bool IsSnorm(VertexLayout::Format Format)
+    {
+        return Format == VertexLayout::Format::Snorm16x2 || Format == VertexLayout::Format::Snorm16x4;
+    }
+
+    bool IsHalf(VertexLayout::Format Format)
+    {
+        return Format == VertexLayout::Format::Float16x2 || Format == VertexLayout::Format::Float16x4;
+    }
+
+    int16_t FloatToSnorm16(float Value)
+    {
+        const float clamped = Value < -1.0f ? -1.0f : (Value > 1.0f ? 1.0f : Value);
+        const float scaled = clamped * 32767.0f;
+        return static_cast<int16_t>(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+    }
+
+    // Folds the unit sphere onto the [-1, 1] square through an octahedron, the shader undoes it
+    void EncodeOctahedral(float* InOutValue)
+    {
+        const float x = InOutValue[0];
+        const float y = InOutValue[1];
+        const float z = InOutValue[2];
+        const float length = std::fabs(x) + std::fabs(y) + std::fabs(z);
+        if (length == 0.0f)
+        {
+            InOutValue[0] = 0.0f;
+            InOutValue[1] = 0.0f;
+            return;
+        }
+
+        float u = x / length;
+        float v = y / length;
+        if (z < 0.0f)
+        {
+            const float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            const float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = foldedU;
+            v = foldedV;
+        }
+        InOutValue[0] = u;
+        InOutValue[1] = v;
+    }
+
+    void PackAttribute(const VertexLayout::Attribute& Attribute, uint32_t Stride, const float* Source, uint32_t SourceComponentCount, float DefaultValue,
+        const VertexPacker::Quantization& Quantize, size_t FirstVertex, size_t EndVertex, uint8_t* OutVertices)
+    {
+        const uint32_t componentCount = VertexLayout::GetFormatComponentCount(Attribute.AttributeFormat);
+        const uint32_t copyCount = Source ? (componentCount < SourceComponentCount ? componentCount : SourceComponentCount) : 0;
+
+        float padding[4] = { DefaultValue, DefaultValue, DefaultValue, DefaultValue };
+        if (Source == nullptr && Attribute.AttributeSemantic == VertexLayout::Semantic::Normal)
+        {
+            padding[0] = 0.0f; padding[1] = 0.0f; padding[2] = 1.0f;
+        }
+        else if (Source == nullptr && Attribute.AttributeSemantic == VertexLayout::Semantic::Tangent)
+        {
+            padding[0] = 1.0f; padding[1] = 0.0f; padding[2] = 0.0f; padding[3] = 1.0f;
+        }
+
+        const bool snorm = IsSnorm(Attribute.AttributeFormat);
+        const bool half = IsHalf(Attribute.AttributeFormat);
+        const bool quantizePosition = snorm && Attribute.AttributeSemantic == VertexLayout::Semantic::Position;
+        const bool octahedral = Attribute.AttributeSemantic == VertexLayout::Semantic::Normal && componentCount == 2;
+
+        float inverseScale[3];
+        for (int c = 0; c < 3; c++)
+        {
+            inverseScale[c] = 1.0f / Quantize.PositionScale[c];
+        }
+
+        uint8_t* out = OutVertices + FirstVertex * Stride + Attribute.Offset;
+        for (size_t i = FirstVertex; i < EndVertex; i++, out += Stride)
+        {
+            float value[4] = { padding[0], padding[1], padding[2], padding[3] };
+            if (octahedral)
+            {
+                // Needs all three source components even though only two are stored
+                for (uint32_t c = 0; Source && c < 3; c++)
+                {
+                    value[c] = Source[i * SourceComponentCount + c];
+                }
+                EncodeOctahedral(value);
+            }
+            else
+            {
+                for (uint32_t c = 0; c < copyCount; c++)
+                {
+                    value[c] = Source[i * SourceComponentCount + c];
+                }
+            }
+
+            if (quantizePosition)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    value[c] = (value[c] - Quantize.PositionOffset[c]) * inverseScale[c];
+                }
+            }
+
+            // Vertex bytes carry no alignment guarantee beyond the stride, memcpy keeps this well defined
+            if (snorm)
+            {
+                int16_t encoded[4];
+                for (uint32_t c = 0; c < componentCount; c++)
+                {
+                    encoded[c] = FloatToSnorm16(value[c]);
+                }
+                memcpy(out, encoded, componentCount * sizeof(int16_t));
+            }
+            else if (half)
+            {
+                uint16_t encoded[4];
+                for (uint32_t c = 0; c < componentCount; c++)
+                {
+                    encoded[c] = VertexPacker::FloatToHalf(value[c]);
+                }
+                memcpy(out, encoded, componentCount * sizeof(uint16_t));
+            }
+            else
+            {
+                memcpy(out, value, componentCount * sizeof(float));
+            }
+        }
+    }
+}
+
+VertexPacker::Quantization VertexPacker::ComputeQuantization(const VertexLayout& Layout, const Streams& Source, size_t VertexCount)
+{
+    Quantization quantization;
+
+    const int position = Layout.FindAttribute(VertexLayout::Semantic::Position);
+    if (position < 0 || !IsSnorm(Layout.GetAttribute(static_cast<uint32_t>(position)).AttributeFormat) || Source.Positions == nullptr || VertexCount == 0)
+    {
+        return quantization;
+    }
+
+    float minimum[3] = { Source.Positions[0], Source.Positions[1], Source.Positions[2] };
+    float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+    for (size_t i = 1; i < VertexCount; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            const float value = Source.Positions[i * 3 + c];
+            minimum[c] = value < minimum[c] ? value : minimum[c];
+            maximum[c] = value > maximum[c] ? value : maximum[c];
+        }
+    }
+
+    for (int c = 0; c < 3; c++)
+    {
+        const float halfExtent = (maximum[c] - minimum[c]) * 0.5f;
+        quantization.PositionOffset[c] = minimum[c] + halfExtent;
+
+        // A flat axis quantizes to 0 whatever the scale, keep it invertible
+        quantization.PositionScale[c] = halfExtent > 0.0f ? halfExtent : 1.0f;
+    }
+
+    return quantization;
+}
+
+void VertexPacker::Pack(const VertexLayout& Layout, const Streams& Source, const Quantization& Quantize, size_t VertexCount, uint8_t* OutVertices, uint32_t ThreadCount)
+{
+    const uint32_t stride = Layout.GetStride();
+    const size_t batchCount = (VertexCount + PACK_BATCH_SIZE - 1) / PACK_BATCH_SIZE;
+
+    ParallelUtils::For(batchCount, ThreadCount, [&](size_t Batch)
+    {
+        const size_t firstVertex = Batch * PACK_BATCH_SIZE;
+        const size_t endVertex = firstVertex + PACK_BATCH_SIZE < VertexCount ? firstVertex + PACK_BATCH_SIZE : VertexCount;
+
+        for (uint32_t a = 0; a < Layout.GetAttributeCount(); a++)
+        {
+            const VertexLayout::Attribute& attribute = Layout.GetAttribute(a);
+            switch (attribute.AttributeSemantic)
+            {
+            case VertexLayout::Semantic::Position:
+                PackAttribute(attribute, stride, Source.Positions, 3, 0.0f, Quantize, firstVertex, endVertex, OutVertices);
+                break;
+            case VertexLayout::Semantic::Normal:
+                PackAttribute(attribute, stride, Source.Normals, 3, 0.0f, Quantize, firstVertex, endVertex, OutVertices);
+                break;
+            case VertexLayout::Semantic::Color:
+                PackAttribute(attribute, stride, nullptr, 0, 1.0f, Quantize, firstVertex, endVertex, OutVertices);
+                break;
+            case VertexLayout::Semantic::Texcoord:
+                PackAttribute(attribute, stride, Source.Texcoords, 2, 0.0f, Quantize, firstVertex, endVertex, OutVertices);
+                break;
+            case VertexLayout::Semantic::Tangent:
+                PackAttribute(attribute, stride, Source.Tangents, 4, 0.0f, Quantize, firstVertex, endVertex, OutVertices);
+                break;
+            }
+        }
+    });
+}
+
+uint16_t VertexPacker::FloatToHalf(float Value)
+{
+    uint32_t bits;
+    memcpy(&bits, &Value, sizeof(bits));
+
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t magnitude = bits & 0x7fffffffu;
+
+    if (magnitude >= 0x7f800000u)
+    {
+        // Infinity stays infinity, NaN stays a quiet NaN
+        return static_cast<uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x0200u : 0u));
+    }
+
+    if (magnitude >= 0x477ff000u)
+    {
+        // 65520 and above round past the largest half
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+
+    if (magnitude < 0x38800000u)
+    {
+        // Below the smallest normal half, 2^-14
+        if (magnitude < 0x33000000u)
+        {
+            return sign;
+        }
+
+        const uint32_t exponent = magnitude >> 23;
+        const uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+        const uint32_t shift = 126 - exponent;
+        uint32_t result = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1u)))
+            result++;
+        return static_cast<uint16_t>(sign | result);
+    }
+
+    // Rebias the exponent and drop 13 mantissa bits, a carry out of the mantissa correctly bumps the exponent
+    uint32_t result = (magnitude - 0x38000000u) >> 13;
+    const uint32_t remainder = magnitude & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u)))
+        result++;
+    return static_cast<uint16_t>(sign | result);
+}
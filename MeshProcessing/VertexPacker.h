@@ -0,0 +1,58 @@
+#ifndef __VertexPacker_h__
+#define __VertexPacker_h__
+
+#include <cstddef>
+#include <cstdint>
+#include "VertexLayout.h"
+
+// Writes separate attribute streams into interleaved vertices following a VertexLayout
+class VertexPacker
+{
+public:
+
+	struct Streams
+	{
+		Streams()
+			: Positions(nullptr)
+			, Normals(nullptr)
+			, Texcoords(nullptr)
+			, Tangents(nullptr)
+		{
+		}
+
+		const float* Positions;	// 3 floats per vertex
+		const float* Normals;	// 3 floats per vertex, (0, 0, 1) when null
+		const float* Texcoords;	// 2 floats per vertex, (0, 0) when null
+		const float* Tangents;	// 4 floats per vertex, (1, 0, 0, 1) when null
+	};
+
+	// Maps snorm positions back to model space: Position = Stored * PositionScale + PositionOffset
+	struct Quantization
+	{
+		Quantization()
+			: PositionScale{ 1.0f, 1.0f, 1.0f }
+			, PositionOffset{ 0.0f, 0.0f, 0.0f }
+		{
+		}
+
+		float PositionScale[3];
+		float PositionOffset[3];
+	};
+
+	// Center and half extents of the positions when the layout stores them as snorm, identity otherwise
+	static Quantization ComputeQuantization(const VertexLayout& Layout, const Streams& Source, size_t VertexCount);
+
+	// OutVertices must hold VertexCount * Layout.GetStride() bytes.
+	// Components a format has beyond its source stream are written as 0 (1 for color).
+	// Snorm positions are quantized with Quantization, two component normals are octahedral encoded.
+	// Large meshes are split into ranges packed on ThreadCount threads, 0 uses every hardware thread.
+	static void Pack(const VertexLayout& Layout, const Streams& Source, const Quantization& Quantize, size_t VertexCount, uint8_t* OutVertices, uint32_t ThreadCount = 0);
+
+	// Round to nearest even, overflow becomes infinity
+	static uint16_t FloatToHalf(float Value);
+
+	// Vertices per task when packing in parallel
+	static constexpr size_t PACK_BATCH_SIZE = 16 * 1024;
+};
+
+#endif //__VertexPacker_h__
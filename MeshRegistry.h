@@ -0,0 +1,158 @@
+#ifndef __MeshRegistry_h__
+#define __MeshRegistry_h__
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include "ModelLoadQueue.h"
+#include "ObjModelLoader.h"
+
+// Deduplicates meshes on two levels. Requests for a file that is loaded or loading with the same settings get the
+// existing mesh or join the running load, and a finished load whose content matches a mesh that is still alive gets
+// that mesh instead of a new one. MeshType is whatever the renderer builds from a model, its GPU buffers for example,
+// shared through std::shared_ptr and freed with its last user. The registry itself only keeps weak references.
+template <typename MeshType>
+class MeshRegistry
+{
+public:
+
+	typedef std::shared_ptr<MeshType> MeshPtr;
+
+	MeshRegistry() = default;
+
+	MeshRegistry(const MeshRegistry&) = delete;
+	MeshRegistry& operator = (const MeshRegistry&) = delete;
+
+	// Returns the request whose result the caller waits for, a running one when the same load is in flight already.
+	// INVALID_REQUEST when the mesh is alive and in OutMesh. Joining raises the priority of the running request.
+	// Every returned request is either resolved or left again with Cancel.
+	ModelLoadQueue::RequestId Request(ModelLoadQueue& Queue, const std::string& FilePath, const ObjModelLoader::LoadSettings& Settings, float Priority,
+		MeshPtr& OutMesh)
+	{
+		const Key key(FilePath, Settings.GetCacheKey());
+
+		auto loaded = m_LoadedMeshes.find(key);
+		if (loaded != m_LoadedMeshes.end())
+		{
+			OutMesh = loaded->second.lock();
+			if (OutMesh)
+				return ModelLoadQueue::INVALID_REQUEST;
+
+			m_LoadedMeshes.erase(loaded);
+		}
+
+		auto loading = m_Loading.find(key);
+		if (loading != m_Loading.end())
+		{
+			if (Priority > loading->second.Priority && Queue.SetPriority(loading->second.Id, Priority))
+			{
+				loading->second.Priority = Priority;
+			}
+			loading->second.Waiters++;
+			return loading->second.Id;
+		}
+
+		const ModelLoadQueue::RequestId id = Queue.Request(FilePath, Settings, Priority);
+		m_Loading[key] = { id, Priority, 1 };
+		m_LoadingKeys[id] = key;
+		return id;
+	}
+
+	// One caller stops waiting for Id. The load is cancelled once nobody waits for it anymore, so the next Request of the
+	// same file and settings starts a new one. False when Id is not loading here.
+	bool Cancel(ModelLoadQueue& Queue, ModelLoadQueue::RequestId Id)
+	{
+		auto loadingKey = m_LoadingKeys.find(Id);
+		if (loadingKey == m_LoadingKeys.end())
+			return false;
+
+		auto loading = m_Loading.find(loadingKey->second);
+		if (--loading->second.Waiters > 0)
+			return true;
+
+		Queue.Cancel(Id);
+		m_Loading.erase(loading);
+		m_LoadingKeys.erase(loadingKey);
+		return true;
+	}
+
+	// Call with every finished load of a request made here. Returns the mesh of every caller that waits for the request,
+	// an alive mesh with the same content or the one CreateMesh(const ObjModelLoader::ModelData&) builds.
+	// nullptr when the load or CreateMesh failed.
+	template <typename CreateType>
+	MeshPtr Resolve(const ModelLoadQueue::Result& Loaded, CreateType&& CreateMesh)
+	{
+		auto loadingKey = m_LoadingKeys.find(Loaded.Id);
+		if (loadingKey == m_LoadingKeys.end())
+			return nullptr;
+
+		const Key key = loadingKey->second;
+		m_LoadingKeys.erase(loadingKey);
+		m_Loading.erase(key);
+
+		if (!Loaded.Model)
+			return nullptr;
+
+		const ContentKey contentKey(Loaded.Model->contentHash, std::make_pair(Loaded.Model->vertexCount, Loaded.Model->indexCount));
+
+		MeshPtr mesh;
+		auto same = m_ContentMeshes.find(contentKey);
+		if (same != m_ContentMeshes.end())
+		{
+			mesh = same->second.lock();
+		}
+
+		if (!mesh)
+		{
+			mesh = CreateMesh(*Loaded.Model);
+			if (!mesh)
+				return nullptr;
+
+			m_ContentMeshes[contentKey] = mesh;
+		}
+
+		m_LoadedMeshes[key] = mesh;
+		return mesh;
+	}
+
+	// Drops the entries of meshes nobody uses anymore
+	void Prune()
+	{
+		for (auto it = m_LoadedMeshes.begin(); it != m_LoadedMeshes.end(); )
+		{
+			it = it->second.expired() ? m_LoadedMeshes.erase(it) : std::next(it);
+		}
+
+		for (auto it = m_ContentMeshes.begin(); it != m_ContentMeshes.end(); )
+		{
+			it = it->second.expired() ? m_ContentMeshes.erase(it) : std::next(it);
+		}
+	}
+
+private:
+
+	// Source path and settings cache key
+	typedef std::pair<std::string, uint64_t> Key;
+
+	// Content hash, vertex and index count
+	typedef std::pair<uint64_t, std::pair<uint32_t, uint32_t>> ContentKey;
+
+	struct LoadingEntry
+	{
+		ModelLoadQueue::RequestId Id;
+		float Priority;
+
+		// Callers that got Id from Request and neither resolved nor cancelled it yet
+		uint32_t Waiters;
+	};
+
+	std::map<Key, LoadingEntry> m_Loading;
+	std::map<ModelLoadQueue::RequestId, Key> m_LoadingKeys;
+
+	std::map<Key, std::weak_ptr<MeshType>> m_LoadedMeshes;
+	std::map<ContentKey, std::weak_ptr<MeshType>> m_ContentMeshes;
+};
+
+#endif //__MeshRegistry_h__
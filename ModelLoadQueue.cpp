@@ -0,0 +1,284 @@
+#include "ModelLoadQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <ParallelUtils.h>
+
+namespace
+{
+    uint64_t GetModelMemory(const ObjModelLoader::ModelData* Model)
+    {
+        return Model ? static_cast<uint64_t>(Model->vertices.size() + Model->indexData.size()) : 0;
+    }
+}
+
+ModelLoadQueue::ModelLoadQueue(const Settings& InSettings)
+    : m_Settings(InSettings)
+    , m_NextId(INVALID_REQUEST + 1)
+    , m_MemoryInUse(0)
+    , m_Stopping(false)
+{
+#ifndef __EMSCRIPTEN__
+    const uint32_t workerCount = std::max<uint32_t>(1, m_Settings.WorkerCount);
+    m_Workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        m_Workers.emplace_back(&ModelLoadQueue::WorkerMain, this);
+    }
+#endif
+}
+
+ModelLoadQueue::~ModelLoadQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+        m_Waiting.clear();
+    }
+    m_WorkAvailable.notify_all();
+
+    // Web fetches keep their promise alive themselves, their futures can simply go
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+ModelLoadQueue::RequestId ModelLoadQueue::Request(const std::string& FilePath, const ObjModelLoader::LoadSettings& LoadSettings, float Priority)
+{
+    Entry entry;
+    entry.FilePath = FilePath;
+    entry.LoadSettings = LoadSettings;
+    entry.Priority = Priority;
+    entry.Cancelled = false;
+
+    // Every worker parsing on every hardware thread would oversubscribe the machine again
+    if (entry.LoadSettings.ParseThreadCount == 0)
+    {
+        entry.LoadSettings.ParseThreadCount = std::max<uint32_t>(1, ParallelUtils::GetWorkerCount(0) / std::max<uint32_t>(1, m_Settings.WorkerCount));
+    }
+
+    // Unknown sizes, remote files on the web, only count once their model arrives
+    std::error_code error;
+    const std::uintmax_t sourceSize = std::filesystem::file_size(FilePath, error);
+    entry.Memory = error ? 0 : static_cast<uint64_t>(static_cast<double>(sourceSize) * m_Settings.PeakMemoryPerSourceByte);
+
+    // Taken under the lock, another thread's Request may bump m_NextId as soon as it is released
+    RequestId id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        id = m_NextId++;
+        entry.Id = id;
+        m_Waiting.push_back(std::move(entry));
+    }
+    m_WorkAvailable.notify_one();
+
+    return id;
+}
+
+bool ModelLoadQueue::SetPriority(RequestId Id, float Priority)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (Entry& entry : m_Waiting)
+    {
+        if (entry.Id == Id)
+        {
+            // The request that starts next may be another one now, one that fits the budget where the last did not
+            entry.Priority = Priority;
+            m_WorkAvailable.notify_all();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ModelLoadQueue::Cancel(RequestId Id)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto waiting = std::find_if(m_Waiting.begin(), m_Waiting.end(), [Id](const Entry& entry) { return entry.Id == Id; });
+    if (waiting != m_Waiting.end())
+    {
+        // Same as a priority change, the next request to start may be another one now
+        m_Waiting.erase(waiting);
+        m_WorkAvailable.notify_all();
+        return true;
+    }
+
+    for (Entry& entry : m_Running)
+    {
+        if (entry.Id == Id)
+        {
+            entry.Cancelled = true;
+            return true;
+        }
+    }
+
+    auto finished = std::find_if(m_Finished.begin(), m_Finished.end(), [Id](const FinishedEntry& entry) { return entry.LoadResult.Id == Id; });
+    if (finished != m_Finished.end())
+    {
+        m_MemoryInUse -= finished->Memory;
+        m_Finished.erase(finished);
+        m_WorkAvailable.notify_all();
+        return true;
+    }
+
+    return false;
+}
+
+void ModelLoadQueue::CollectFinished(std::vector<Result>& OutResults)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+#ifdef __EMSCRIPTEN__
+    // No workers here, the fetches are started and polled from the caller's thread
+    for (size_t i = 0; i < m_Running.size(); )
+    {
+        if (m_Running[i].Future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            i++;
+            continue;
+        }
+
+        std::unique_ptr<const ObjModelLoader::ModelData> model = m_Running[i].Future.get();
+        Finish(m_Running[i].Id, model);
+    }
+
+    while (m_Running.size() < std::max<uint32_t>(1, m_Settings.WorkerCount))
+    {
+        const int next = FindStartable();
+        if (next < 0)
+            break;
+
+        Entry entry = std::move(m_Waiting[next]);
+        m_Waiting.erase(m_Waiting.begin() + next);
+        m_MemoryInUse += entry.Memory;
+
+        ObjModelLoader loader(entry.FilePath, entry.LoadSettings);
+        entry.Future = loader.Load();
+        m_Running.push_back(std::move(entry));
+    }
+#endif
+
+    for (FinishedEntry& finished : m_Finished)
+    {
+        m_MemoryInUse -= finished.Memory;
+        OutResults.push_back(std::move(finished.LoadResult));
+    }
+
+    if (!m_Finished.empty())
+    {
+        m_Finished.clear();
+        m_WorkAvailable.notify_all();
+    }
+}
+
+ModelLoadQueue::RequestState ModelLoadQueue::GetState(RequestId Id) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto HasId = [Id](const Entry& entry) { return entry.Id == Id; };
+    if (std::any_of(m_Waiting.begin(), m_Waiting.end(), HasId))
+        return RequestState::Waiting;
+
+    // A cancelled load only runs to completion, its result never comes out
+    auto running = std::find_if(m_Running.begin(), m_Running.end(), HasId);
+    if (running != m_Running.end())
+        return running->Cancelled ? RequestState::Unknown : RequestState::Running;
+
+    if (std::any_of(m_Finished.begin(), m_Finished.end(), [Id](const FinishedEntry& entry) { return entry.LoadResult.Id == Id; }))
+        return RequestState::Finished;
+
+    return RequestState::Unknown;
+}
+
+size_t ModelLoadQueue::GetRequestCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Waiting.size() + m_Running.size() + m_Finished.size();
+}
+
+uint64_t ModelLoadQueue::GetMemoryInUse() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_MemoryInUse;
+}
+
+int ModelLoadQueue::FindStartable() const
+{
+    if (m_Waiting.empty())
+        return -1;
+
+    // Ids grow with every request, the lower one is older
+    size_t best = 0;
+    for (size_t i = 1; i < m_Waiting.size(); i++)
+    {
+        const Entry& entry = m_Waiting[i];
+        if (entry.Priority > m_Waiting[best].Priority || (entry.Priority == m_Waiting[best].Priority && entry.Id < m_Waiting[best].Id))
+        {
+            best = i;
+        }
+    }
+
+    // Backpressure: the most important request waits for memory instead of smaller ones overtaking it
+    if (m_MemoryInUse > 0 && m_MemoryInUse + m_Waiting[best].Memory > m_Settings.MemoryBudget)
+        return -1;
+
+    return static_cast<int>(best);
+}
+
+void ModelLoadQueue::Finish(RequestId Id, std::unique_ptr<const ObjModelLoader::ModelData>& Model)
+{
+    auto running = std::find_if(m_Running.begin(), m_Running.end(), [Id](const Entry& entry) { return entry.Id == Id; });
+
+    // The estimate covered the load, from now on only the model itself is held
+    m_MemoryInUse -= running->Memory;
+
+    if (!running->Cancelled && !m_Stopping)
+    {
+        FinishedEntry finished;
+        finished.LoadResult.Id = Id;
+        finished.LoadResult.FilePath = running->FilePath;
+        finished.LoadResult.Model = std::move(Model);
+        finished.Memory = GetModelMemory(finished.LoadResult.Model.get());
+
+        m_MemoryInUse += finished.Memory;
+        m_Finished.push_back(std::move(finished));
+    }
+
+    m_Running.erase(running);
+}
+
+void ModelLoadQueue::WorkerMain()
+{
+#ifndef __EMSCRIPTEN__
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        int next = -1;
+        m_WorkAvailable.wait(lock, [&]() { return m_Stopping || (next = FindStartable()) >= 0; });
+        if (m_Stopping)
+            return;
+
+        m_MemoryInUse += m_Waiting[next].Memory;
+        m_Running.push_back(std::move(m_Waiting[next]));
+        m_Waiting.erase(m_Waiting.begin() + next);
+
+        const RequestId id = m_Running.back().Id;
+        const ObjModelLoader loader(m_Running.back().FilePath, m_Running.back().LoadSettings);
+
+        lock.unlock();
+        std::unique_ptr<const ObjModelLoader::ModelData> model = loader.LoadNow();
+        lock.lock();
+
+        Finish(id, model);
+
+        // Whatever the load held is back in the budget, a cancelled model is freed outside of the lock
+        m_WorkAvailable.notify_all();
+        lock.unlock();
+        model.reset();
+        lock.lock();
+    }
+#endif
+}
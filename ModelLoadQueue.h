@@ -0,0 +1,139 @@
+#ifndef __ModelLoadQueue_h__
+#define __ModelLoadQueue_h__
+
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ObjModelLoader.h"
+
+// Loads models on a fixed set of worker threads. Waiting requests start highest priority first, and only while the
+// estimated memory of the running loads plus the finished models nobody collected yet stays inside the budget.
+// The web build has no workers, there the same limits apply to the fetches started from CollectFinished.
+class ModelLoadQueue
+{
+public:
+
+	typedef uint64_t RequestId;
+	static constexpr RequestId INVALID_REQUEST = 0;
+
+	enum class RequestState
+	{
+		// Never requested, cancelled or collected already
+		Unknown,
+		Waiting,
+		Running,
+
+		// Waits for CollectFinished
+		Finished,
+	};
+
+	struct Settings
+	{
+		Settings()
+			: WorkerCount(2)
+			, MemoryBudget(256ull * 1024 * 1024)
+			, PeakMemoryPerSourceByte(8.0f)
+		{
+		}
+
+		// Loads running at once. Requests that leave LoadSettings::ParseThreadCount at 0 share the hardware threads between the workers.
+		uint32_t WorkerCount;
+
+		// In bytes. A load that alone is over budget still starts once nothing else holds memory.
+		uint64_t MemoryBudget;
+
+		// Peak memory of a load relative to its source file size, the bundled models measure about 6.5
+		float PeakMemoryPerSourceByte;
+	};
+
+	struct Result
+	{
+		RequestId Id;
+		std::string FilePath;
+
+		// nullptr when the load failed
+		std::unique_ptr<const ObjModelLoader::ModelData> Model;
+	};
+
+	explicit ModelLoadQueue(const Settings& InSettings = Settings());
+
+	// Drops the waiting requests and waits for the running loads
+	~ModelLoadQueue();
+
+	ModelLoadQueue(const ModelLoadQueue&) = delete;
+	ModelLoadQueue& operator = (const ModelLoadQueue&) = delete;
+
+	// Higher priorities start first, e.g. the negated distance to the camera. Equal priorities start in request order.
+	RequestId Request(const std::string& FilePath, const ObjModelLoader::LoadSettings& LoadSettings, float Priority = 0.0f);
+
+	// Only reorders waiting requests, false once the load started
+	bool SetPriority(RequestId Id, float Priority);
+
+	// A waiting request is dropped, a running load completes but its model is thrown away.
+	// False when the request is unknown or its result was already collected.
+	bool Cancel(RequestId Id);
+
+	// Moves the finished loads to OutResults in completion order, their memory leaves the budget
+	void CollectFinished(std::vector<Result>& OutResults);
+
+	RequestState GetState(RequestId Id) const;
+
+	// Requests that are waiting, running or finished but not collected yet
+	size_t GetRequestCount() const;
+
+	// Estimates of the running loads plus the size of the uncollected models
+	uint64_t GetMemoryInUse() const;
+
+private:
+
+	struct Entry
+	{
+		RequestId Id;
+		std::string FilePath;
+		ObjModelLoader::LoadSettings LoadSettings;
+		float Priority;
+		uint64_t Memory;
+		bool Cancelled;
+
+#ifdef __EMSCRIPTEN__
+		std::future<std::unique_ptr<const ObjModelLoader::ModelData>> Future;
+#endif
+	};
+
+	struct FinishedEntry
+	{
+		Result LoadResult;
+		uint64_t Memory;
+	};
+
+	// Index of the waiting request that starts next, -1 when none may start now. Callers hold m_Mutex.
+	int FindStartable() const;
+
+	// Takes the running entry out and moves its model out of Model for CollectFinished, a cancelled model stays
+	// in Model for the caller to free. Callers hold m_Mutex.
+	void Finish(RequestId Id, std::unique_ptr<const ObjModelLoader::ModelData>& Model);
+
+	void WorkerMain();
+
+	const Settings m_Settings;
+
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+
+	std::vector<Entry> m_Waiting;
+	std::vector<Entry> m_Running;
+	std::vector<FinishedEntry> m_Finished;
+
+	RequestId m_NextId;
+	uint64_t m_MemoryInUse;
+	bool m_Stopping;
+
+	std::vector<std::thread> m_Workers;
+};
+
+#endif //__ModelLoadQueue_h__
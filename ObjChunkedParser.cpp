@@ -0,0 +1,458 @@
+#include "ObjChunkedParser.h"
+
+// The tinyobj implementation lives in this translation unit so the chunk parser can reuse its
+// number and index parsing, which keeps the parsed values bit-identical to tinyobj::LoadObj
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <ParallelUtils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+
+namespace
+{
+    struct RawFace
+    {
+        uint32_t FirstCorner;
+        uint32_t CornerCount;
+
+        // Element counts inside the chunk when the face was read, relative indices resolve against these
+        int VertexCount;
+        int NormalCount;
+        int TexcoordCount;
+    };
+
+    struct MaterialRecord
+    {
+        // Chunk corner count at the line
+        size_t Corner;
+        bool IsLibrary;
+
+        // The mtllib line after the keyword, or the usemtl name
+        std::string Value;
+    };
+
+    struct ObjChunk
+    {
+        const char* Begin = nullptr;
+        const char* End = nullptr;
+
+        std::vector<float> Vertices;
+        std::vector<float> Normals;
+        std::vector<float> Texcoords;
+
+        std::vector<tinyobj::vertex_index_t> RawCorners;
+        std::vector<RawFace> Faces;
+        size_t TriangleCount = 0;
+
+        // mtllib and usemtl lines in file order, resolved serially once the chunks are parsed
+        std::vector<MaterialRecord> MaterialRecords;
+
+        // Global element counts of all preceding chunks
+        int VertexOffset = 0;
+        int NormalOffset = 0;
+        int TexcoordOffset = 0;
+        size_t CornerOffset = 0;
+
+        bool Supported = true;
+    };
+
+    inline bool IsLineEnd(char c)
+    {
+        return c == '\n' || c == '\r';
+    }
+
+    // Same rules as tinyobj's fixIndex, Count is the number of elements defined before the line
+    inline bool ResolveIndex(int RawIndex, int Count, bool AllowZero, int& OutIndex)
+    {
+        if (RawIndex > 0)
+        {
+            OutIndex = RawIndex - 1;
+            return true;
+        }
+
+        if (RawIndex == 0)
+        {
+            OutIndex = -1;
+            return AllowZero;
+        }
+
+        OutIndex = Count + RawIndex;
+        return OutIndex >= 0;
+    }
+
+    void ParseChunk(ObjChunk& Chunk)
+    {
+        std::string linebuf;
+
+        const char* Cursor = Chunk.Begin;
+        while (Cursor < Chunk.End)
+        {
+            const char* LineEnd = Cursor;
+            while (LineEnd < Chunk.End && !IsLineEnd(*LineEnd))
+            {
+                LineEnd++;
+            }
+
+            linebuf.assign(Cursor, LineEnd);
+            Cursor = LineEnd + 1;
+
+            const char* token = linebuf.c_str();
+            token += strspn(token, " \t");
+
+            if (token[0] == '\0' || token[0] == '#')
+                continue;
+
+            if (token[0] == 'v' && IS_SPACE(token[1]))
+            {
+                token += 2;
+                tinyobj::real_t x, y, z, r, g, b;
+                tinyobj::parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+
+                Chunk.Vertices.push_back(x);
+                Chunk.Vertices.push_back(y);
+                Chunk.Vertices.push_back(z);
+                continue;
+            }
+
+            if (token[0] == 'v' && token[1] == 'n' && IS_SPACE(token[2]))
+            {
+                token += 3;
+                tinyobj::real_t x, y, z;
+                tinyobj::parseReal3(&x, &y, &z, &token);
+
+                Chunk.Normals.push_back(x);
+                Chunk.Normals.push_back(y);
+                Chunk.Normals.push_back(z);
+                continue;
+            }
+
+            if (token[0] == 'v' && token[1] == 't' && IS_SPACE(token[2]))
+            {
+                token += 3;
+                tinyobj::real_t x, y;
+                tinyobj::parseReal2(&x, &y, &token);
+
+                Chunk.Texcoords.push_back(x);
+                Chunk.Texcoords.push_back(y);
+                continue;
+            }
+
+            if (token[0] == 'f' && IS_SPACE(token[1]))
+            {
+                token += 2;
+                token += strspn(token, " \t");
+
+                RawFace Face;
+                Face.FirstCorner = static_cast<uint32_t>(Chunk.RawCorners.size());
+                Face.VertexCount = static_cast<int>(Chunk.Vertices.size() / 3);
+                Face.NormalCount = static_cast<int>(Chunk.Normals.size() / 3);
+                Face.TexcoordCount = static_cast<int>(Chunk.Texcoords.size() / 2);
+
+                while (!IS_NEW_LINE(token[0]) && token[0] != '#')
+                {
+                    Chunk.RawCorners.push_back(tinyobj::parseRawTriple(&token));
+                    token += strspn(token, " \t\r");
+                }
+
+                Face.CornerCount = static_cast<uint32_t>(Chunk.RawCorners.size()) - Face.FirstCorner;
+
+                if (Face.CornerCount > 4)
+                {
+                    // tinyobj ear-clips these, leave it to the serial path
+                    Chunk.Supported = false;
+                    return;
+                }
+
+                // Degenerate faces are kept until stitching, their indices still have to be valid
+                if (Face.CornerCount >= 3)
+                {
+                    Chunk.TriangleCount += Face.CornerCount - 2;
+                }
+
+                Chunk.Faces.push_back(Face);
+                continue;
+            }
+
+            // Records whose parse can fail in tinyobj, the serial path reports those
+            if ((token[0] == 'l' || token[0] == 'p') && IS_SPACE(token[1]))
+            {
+                Chunk.Supported = false;
+                return;
+            }
+
+            if (token[0] == 'v' && token[1] == 'w' && IS_SPACE(token[2]))
+            {
+                Chunk.Supported = false;
+                return;
+            }
+
+            // Matched like tinyobj::LoadObj matches them, usemtl does not need a space after the keyword there
+            if (strncmp(token, "usemtl", 6) == 0)
+            {
+                token += 6;
+                Chunk.MaterialRecords.push_back({ Chunk.TriangleCount * 3, false, tinyobj::parseString(&token) });
+                continue;
+            }
+
+            if (strncmp(token, "mtllib", 6) == 0 && IS_SPACE(token[6]))
+            {
+                Chunk.MaterialRecords.push_back({ Chunk.TriangleCount * 3, true, std::string(token + 7) });
+                continue;
+            }
+
+            // Groups, objects and smoothing groups do not change the corner stream
+        }
+    }
+
+    // Resolves and triangulates the faces of one chunk into OutCorners starting at Chunk.CornerOffset
+    bool StitchChunk(const ObjChunk& Chunk, const tinyobj::attrib_t& Attrib, std::vector<tinyobj::index_t>& OutCorners)
+    {
+        const std::vector<float>& v = Attrib.vertices;
+        const int TotalVertexCount = static_cast<int>(Attrib.vertices.size() / 3);
+        const int TotalNormalCount = static_cast<int>(Attrib.normals.size() / 3);
+        const int TotalTexcoordCount = static_cast<int>(Attrib.texcoords.size() / 2);
+
+        size_t WriteIndex = Chunk.CornerOffset;
+
+        for (const RawFace& Face : Chunk.Faces)
+        {
+            const int VertexCount = Chunk.VertexOffset + Face.VertexCount;
+            const int NormalCount = Chunk.NormalOffset + Face.NormalCount;
+            const int TexcoordCount = Chunk.TexcoordOffset + Face.TexcoordCount;
+
+            tinyobj::index_t Corners[4];
+            for (uint32_t i = 0; i < Face.CornerCount; i++)
+            {
+                const tinyobj::vertex_index_t& Raw = Chunk.RawCorners[Face.FirstCorner + i];
+                tinyobj::index_t& Corner = Corners[i];
+
+                if (!ResolveIndex(Raw.v_idx, VertexCount, false, Corner.vertex_index)
+                    || !ResolveIndex(Raw.vn_idx, NormalCount, true, Corner.normal_index)
+                    || !ResolveIndex(Raw.vt_idx, TexcoordCount, true, Corner.texcoord_index))
+                {
+                    return false;
+                }
+
+                // tinyobj splits quads with the vertices known at that point, so quads may only reference earlier vertices
+                const int VertexLimit = Face.CornerCount == 4 ? VertexCount : TotalVertexCount;
+
+                if (Corner.vertex_index >= VertexLimit
+                    || Corner.normal_index >= TotalNormalCount
+                    || Corner.texcoord_index >= TotalTexcoordCount)
+                {
+                    return false;
+                }
+            }
+
+            if (Face.CornerCount < 3)
+                continue;
+
+            if (Face.CornerCount == 3)
+            {
+                OutCorners[WriteIndex++] = Corners[0];
+                OutCorners[WriteIndex++] = Corners[1];
+                OutCorners[WriteIndex++] = Corners[2];
+                continue;
+            }
+
+            // Split along the shorter diagonal, same arithmetic as tinyobj's exportGroupsToShape
+            const size_t vi0 = size_t(Corners[0].vertex_index);
+            const size_t vi1 = size_t(Corners[1].vertex_index);
+            const size_t vi2 = size_t(Corners[2].vertex_index);
+            const size_t vi3 = size_t(Corners[3].vertex_index);
+
+            tinyobj::real_t e02x = v[vi2 * 3 + 0] - v[vi0 * 3 + 0];
+            tinyobj::real_t e02y = v[vi2 * 3 + 1] - v[vi0 * 3 + 1];
+            tinyobj::real_t e02z = v[vi2 * 3 + 2] - v[vi0 * 3 + 2];
+            tinyobj::real_t e13x = v[vi3 * 3 + 0] - v[vi1 * 3 + 0];
+            tinyobj::real_t e13y = v[vi3 * 3 + 1] - v[vi1 * 3 + 1];
+            tinyobj::real_t e13z = v[vi3 * 3 + 2] - v[vi1 * 3 + 2];
+
+            tinyobj::real_t sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+            tinyobj::real_t sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+            if (sqr02 < sqr13)
+            {
+                OutCorners[WriteIndex++] = Corners[0];
+                OutCorners[WriteIndex++] = Corners[1];
+                OutCorners[WriteIndex++] = Corners[2];
+
+                OutCorners[WriteIndex++] = Corners[0];
+                OutCorners[WriteIndex++] = Corners[2];
+                OutCorners[WriteIndex++] = Corners[3];
+            }
+            else
+            {
+                OutCorners[WriteIndex++] = Corners[0];
+                OutCorners[WriteIndex++] = Corners[1];
+                OutCorners[WriteIndex++] = Corners[3];
+
+                OutCorners[WriteIndex++] = Corners[1];
+                OutCorners[WriteIndex++] = Corners[2];
+                OutCorners[WriteIndex++] = Corners[3];
+            }
+        }
+
+        return true;
+    }
+
+    // Replays the mtllib/usemtl handling of tinyobj::LoadObj: libraries load when their line is reached, a usemtl
+    // only finds the materials loaded before it
+    class MaterialReplay
+    {
+    public:
+
+        MaterialReplay(tinyobj::MaterialReader* Reader, std::vector<tinyobj::material_t>& OutMaterials, std::vector<ObjMaterialRange>& OutRanges)
+            : m_Reader(Reader)
+            , m_Materials(OutMaterials)
+            , m_Ranges(OutRanges)
+            , m_MaterialId(-1)
+        {
+        }
+
+        void Apply(const MaterialRecord& Record, size_t Corner)
+        {
+            if (Record.IsLibrary)
+            {
+                LoadLibrary(Record.Value);
+                return;
+            }
+
+            std::map<std::string, int>::const_iterator it = m_MaterialMap.find(Record.Value);
+            const int MaterialId = it != m_MaterialMap.end() ? it->second : -1;
+            if (MaterialId != m_MaterialId)
+            {
+                m_Ranges.push_back({ Corner, MaterialId });
+                m_MaterialId = MaterialId;
+            }
+        }
+
+    private:
+
+        // First file of the line that is not loaded yet and can be read, like tinyobj
+        void LoadLibrary(const std::string& Line)
+        {
+            if (m_Reader == nullptr)
+                return;
+
+            std::vector<std::string> Filenames;
+            tinyobj::SplitString(Line, ' ', '\\', Filenames);
+
+            for (const std::string& Filename : Filenames)
+            {
+                if (m_LoadedFiles.count(Filename) > 0)
+                    continue;
+
+                std::string Warn, Err;
+                if ((*m_Reader)(Filename.c_str(), &m_Materials, &m_MaterialMap, &Warn, &Err))
+                {
+                    m_LoadedFiles.insert(Filename);
+                    break;
+                }
+            }
+        }
+
+        tinyobj::MaterialReader* m_Reader;
+        std::vector<tinyobj::material_t>& m_Materials;
+        std::vector<ObjMaterialRange>& m_Ranges;
+
+        std::set<std::string> m_LoadedFiles;
+        std::map<std::string, int> m_MaterialMap;
+        int m_MaterialId;
+    };
+}
+
+bool ObjChunkedParser::Parse(const char* Data, size_t Size, uint32_t ThreadCount, tinyobj::MaterialReader* ReadMaterial, tinyobj::attrib_t& OutAttrib,
+    std::vector<tinyobj::index_t>& OutCorners, std::vector<tinyobj::material_t>& OutMaterials, std::vector<ObjMaterialRange>& OutMaterialRanges)
+{
+    // tinyobj strips a UTF-8 BOM from the first line
+    if (Size >= 3 && static_cast<unsigned char>(Data[0]) == 0xEF && static_cast<unsigned char>(Data[1]) == 0xBB && static_cast<unsigned char>(Data[2]) == 0xBF)
+    {
+        Data += 3;
+        Size -= 3;
+    }
+
+    const uint32_t WorkerCount = ParallelUtils::GetWorkerCount(ThreadCount);
+    const size_t ChunkCount = std::max<size_t>(1, std::min<size_t>(WorkerCount, Size / MIN_CHUNK_SIZE));
+
+    // Split on line boundaries
+    std::vector<ObjChunk> Chunks(ChunkCount);
+    const char* const DataEnd = Data + Size;
+    const char* ChunkBegin = Data;
+    for (size_t i = 0; i < ChunkCount; i++)
+    {
+        const char* ChunkEnd = (i + 1 == ChunkCount) ? DataEnd : Data + (Size / ChunkCount) * (i + 1);
+        ChunkEnd = std::max(ChunkEnd, ChunkBegin);
+        while (ChunkEnd < DataEnd && !IsLineEnd(*ChunkEnd))
+        {
+            ChunkEnd++;
+        }
+        ChunkEnd = std::min(ChunkEnd + 1, DataEnd);
+
+        Chunks[i].Begin = ChunkBegin;
+        Chunks[i].End = ChunkEnd;
+        ChunkBegin = ChunkEnd;
+    }
+
+    ParallelUtils::For(ChunkCount, WorkerCount, [&Chunks](size_t ChunkIndex) { ParseChunk(Chunks[ChunkIndex]); });
+
+    // Prefix sums give every chunk its global offsets
+    size_t VertexFloats = 0, NormalFloats = 0, TexcoordFloats = 0, CornerCount = 0;
+    for (ObjChunk& Chunk : Chunks)
+    {
+        if (!Chunk.Supported)
+            return false;
+
+        Chunk.VertexOffset = static_cast<int>(VertexFloats / 3);
+        Chunk.NormalOffset = static_cast<int>(NormalFloats / 3);
+        Chunk.TexcoordOffset = static_cast<int>(TexcoordFloats / 2);
+        Chunk.CornerOffset = CornerCount;
+
+        VertexFloats += Chunk.Vertices.size();
+        NormalFloats += Chunk.Normals.size();
+        TexcoordFloats += Chunk.Texcoords.size();
+        CornerCount += Chunk.TriangleCount * 3;
+    }
+
+    OutAttrib = tinyobj::attrib_t();
+    OutAttrib.vertices.reserve(VertexFloats);
+    OutAttrib.normals.reserve(NormalFloats);
+    OutAttrib.texcoords.reserve(TexcoordFloats);
+
+    for (ObjChunk& Chunk : Chunks)
+    {
+        OutAttrib.vertices.insert(OutAttrib.vertices.end(), Chunk.Vertices.begin(), Chunk.Vertices.end());
+        OutAttrib.normals.insert(OutAttrib.normals.end(), Chunk.Normals.begin(), Chunk.Normals.end());
+        OutAttrib.texcoords.insert(OutAttrib.texcoords.end(), Chunk.Texcoords.begin(), Chunk.Texcoords.end());
+
+        std::vector<float>().swap(Chunk.Vertices);
+        std::vector<float>().swap(Chunk.Normals);
+        std::vector<float>().swap(Chunk.Texcoords);
+    }
+
+    OutCorners.resize(CornerCount);
+
+    OutMaterials.clear();
+    OutMaterialRanges.clear();
+    MaterialReplay Replay(ReadMaterial, OutMaterials, OutMaterialRanges);
+    for (const ObjChunk& Chunk : Chunks)
+    {
+        for (const MaterialRecord& Record : Chunk.MaterialRecords)
+        {
+            Replay.Apply(Record, Chunk.CornerOffset + Record.Corner);
+        }
+    }
+
+    std::vector<char> ChunkValid(ChunkCount, 1);
+    ParallelUtils::For(ChunkCount, WorkerCount, [&](size_t ChunkIndex)
+    {
+        ChunkValid[ChunkIndex] = StitchChunk(Chunks[ChunkIndex], OutAttrib, OutCorners) ? 1 : 0;
+    });
+
+    return std::find(ChunkValid.begin(), ChunkValid.end(), 0) == ChunkValid.end();
+}
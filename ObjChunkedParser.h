@@ -0,0 +1,29 @@
+#ifndef __ObjChunkedParser_h__
+#define __ObjChunkedParser_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ObjMaterialRange.h"
+#include "tiny_obj_loader.h"
+
+// Parses the v/vn/vt/f records of an in-memory .obj on several threads.
+// The buffer is split on line boundaries, every chunk is parsed on its own, then the chunks are stitched
+// back together by offsetting relative indices with the element counts of the preceding chunks.
+// Output matches tinyobj::LoadObj: same attribute values and the same triangulated corners, in file order,
+// OutMaterialRanges gives every corner the material id tinyobj would have assigned to its triangle.
+class ObjChunkedParser
+{
+public:
+
+	// Returns false when the file uses something this parser does not reproduce exactly
+	// (n-gons above quads, lines/points, forward or invalid references, ...). Callers fall back to tinyobj::LoadObj then.
+	// ThreadCount 0 uses every hardware thread. mtllib files are read through ReadMaterial, none are read when it is null.
+	static bool Parse(const char* Data, size_t Size, uint32_t ThreadCount, tinyobj::MaterialReader* ReadMaterial, tinyobj::attrib_t& OutAttrib,
+		std::vector<tinyobj::index_t>& OutCorners, std::vector<tinyobj::material_t>& OutMaterials, std::vector<ObjMaterialRange>& OutMaterialRanges);
+
+	// Chunks smaller than this are not worth a thread
+	static constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+};
+
+#endif //__ObjChunkedParser_h__
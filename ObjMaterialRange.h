@@ -0,0 +1,15 @@
+#ifndef __ObjMaterialRange_h__
+#define __ObjMaterialRange_h__
+
+#include <cstddef>
+
+// Material of the triangulated corners from FirstCorner up to the next range, the parsers start a range wherever
+// usemtl switches to another material. MaterialId indexes the materials tinyobj read from the mtllib files,
+// -1 when usemtl named a material none of them defines, or before the first usemtl.
+struct ObjMaterialRange
+{
+	size_t FirstCorner;
+	int MaterialId;
+};
+
+#endif //__ObjMaterialRange_h__
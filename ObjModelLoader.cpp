@@ -1,5 +1,8 @@
 #include "ObjModelLoader.h"
-#define TINYOBJLOADER_IMPLEMENTATION // add this to exactly 1 of your C++ files
+#include "ObjChunkedParser.h"
+#include "ObjStreamParser.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
 #include "tiny_obj_loader.h"
 
 #ifdef __EMSCRIPTEN__
@@ -8,15 +11,56 @@
 
 #include <iostream>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <PANDUVector3.h>
 #include <PANDUVector2.h>
+#include <PANDUMathConstants.h>
+#include <MeshOptimizer.h>
+#include <MeshSimplifier.h>
+#include <NormalGenerator.h>
+#include <ParallelUtils.h>
+#include <TangentGenerator.h>
+#include <VertexPacker.h>
+
+std::unique_ptr<const ObjModelLoader::ModelData> ReadObjBuffer(const char* Data, size_t Size, const std::string& FilePath, const ObjModelLoader::LoadSettings& Settings,
+    ObjModelLoader::StageTimings* Timings = nullptr);
+
+namespace
+{
+    // Adds the time since the previous lap to one stage, does nothing without timings
+    class StageTimer
+    {
+    public:
+
+        explicit StageTimer(ObjModelLoader::StageTimings* Timings)
+            : m_Timings(Timings)
+            , m_Start(std::chrono::steady_clock::now())
+        {
+        }
+
+        void Lap(double ObjModelLoader::StageTimings::* Stage)
+        {
+            if (!m_Timings)
+                return;
 
-std::unique_ptr<ObjModelLoader::ModelData> ReadObjFile(std::istream& filestream);
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            m_Timings->*Stage += std::chrono::duration<double, std::milli>(now - m_Start).count();
+            m_Start = now;
+        }
 
-ObjModelLoader::ObjModelLoader(const std::string& FilePath)
+    private:
+
+        ObjModelLoader::StageTimings* m_Timings;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+}
+
+ObjModelLoader::ObjModelLoader(const std::string& FilePath, const LoadSettings& Settings)
 	: m_ModelFilePath(FilePath)
+	, m_Settings(Settings)
 {
  
 }
@@ -26,183 +70,722 @@ ObjModelLoader::~ObjModelLoader()
 
 }
 
+uint64_t ObjModelLoader::LoadSettings::GetCacheKey() const
+{
+    // FNV-1a over every setting that changes the produced data
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto HashBytes = [&hash](const void* Data, size_t Size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(Data);
+        for (size_t i = 0; i < Size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    };
+
+    const float tolerances[] = { Weld.PositionTolerance, Weld.NormalTolerance, Weld.TexcoordTolerance };
+    HashBytes(tolerances, sizeof(tolerances));
 
+    const uint8_t flags[] = { OptimizeVertexOrder ? uint8_t(1) : uint8_t(0), Allow16BitIndices ? uint8_t(1) : uint8_t(0), BuildMeshlets ? uint8_t(1) : uint8_t(0) };
+    HashBytes(flags, sizeof(flags));
 
+    for (uint32_t i = 0; i < Layout.GetAttributeCount(); i++)
+    {
+        const VertexLayout::Attribute& attribute = Layout.GetAttribute(i);
+        const uint32_t values[] = { static_cast<uint32_t>(attribute.AttributeSemantic), static_cast<uint32_t>(attribute.AttributeFormat), attribute.Offset, attribute.ShaderLocation };
+        HashBytes(values, sizeof(values));
+    }
 
-std::future<std::unique_ptr<const ObjModelLoader::ModelData>> ObjModelLoader::Load()
-{
-#ifdef __EMSCRIPTEN__
-    auto promise = std::make_shared<std::promise<std::unique_ptr<const ModelData>>>();
-    auto future = promise->get_future();
+    HashBytes(LodTriangleRatios.data(), LodTriangleRatios.size() * sizeof(float));
+    HashBytes(&LodMaxError, sizeof(LodMaxError));
 
-    emscripten_fetch_attr_t attr;
-    emscripten_fetch_attr_init(&attr);
-    strcpy(attr.requestMethod, "GET");
-    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+    const uint8_t generateNormals = GenerateMissingNormals ? uint8_t(1) : uint8_t(0);
+    HashBytes(&generateNormals, sizeof(generateNormals));
+    HashBytes(&NormalCreaseAngle, sizeof(NormalCreaseAngle));
 
-    struct FetchData
+    return hash;
+}
+
+uint64_t ObjModelLoader::ModelData::ComputeContentHash() const
+{
+    // FNV-1a like the cache key, over everything that ends up in the GPU buffers or the draw calls
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto HashBytes = [&hash](const void* Data, size_t Size)
     {
-        std::shared_ptr<std::promise<std::unique_ptr<const ModelData>>> promise;
-        std::string filePath;
+        const unsigned char* bytes = static_cast<const unsigned char*>(Data);
+        for (size_t i = 0; i < Size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
     };
 
-    auto fetchData = new FetchData{ promise, m_ModelFilePath };
-    attr.userData = fetchData;
+    for (uint32_t i = 0; i < layout.GetAttributeCount(); i++)
+    {
+        const VertexLayout::Attribute& attribute = layout.GetAttribute(i);
+        const uint32_t values[] = { static_cast<uint32_t>(attribute.AttributeSemantic), static_cast<uint32_t>(attribute.AttributeFormat), attribute.Offset, attribute.ShaderLocation };
+        HashBytes(values, sizeof(values));
+    }
 
-    const std::string filePath = m_ModelFilePath;
+    HashBytes(&vertexCount, sizeof(vertexCount));
+    HashBytes(vertices.data(), vertices.size());
+    HashBytes(quantization.PositionScale, sizeof(quantization.PositionScale));
+    HashBytes(quantization.PositionOffset, sizeof(quantization.PositionOffset));
 
-    attr.onsuccess = [](emscripten_fetch_t* fetch) {
-        auto* data = static_cast<FetchData*>(fetch->userData);
+    const uint8_t format = static_cast<uint8_t>(indexFormat);
+    HashBytes(&format, sizeof(format));
+    HashBytes(&indexCount, sizeof(indexCount));
+    HashBytes(indexData.data(), indexData.size());
 
-        std::string objContent(fetch->data, fetch->numBytes);
-        std::istringstream objStream(objContent);
+    for (const Submesh& submesh : submeshes)
+    {
+        const uint32_t range[] = { submesh.firstIndex, submesh.indexCount, static_cast<uint32_t>(submesh.materialIndex) };
+        HashBytes(range, sizeof(range));
 
-        if (!objStream)
+        for (const Lod& lod : submesh.lods)
         {
-            std::cerr << "Obj file load failed : " << std::endl;
+            HashBytes(&lod.firstIndex, sizeof(lod.firstIndex));
+            HashBytes(&lod.indexCount, sizeof(lod.indexCount));
+            HashBytes(&lod.error, sizeof(lod.error));
         }
 
-        auto RetVal = ReadObjFile(objStream);
-        data->promise->set_value(std::move(RetVal));
+        // Meshlets pick the draws that survive cone culling, loads with and without them can't share a mesh
+        const uint64_t meshletCount = submesh.meshlets.size();
+        HashBytes(&meshletCount, sizeof(meshletCount));
+        for (const Meshlet& meshlet : submesh.meshlets)
+        {
+            const float cone[] = { meshlet.ConeApex.x, meshlet.ConeApex.y, meshlet.ConeApex.z, meshlet.ConeAxis.x, meshlet.ConeAxis.y, meshlet.ConeAxis.z, meshlet.ConeCutoff };
+            HashBytes(&meshlet.FirstIndex, sizeof(meshlet.FirstIndex));
+            HashBytes(&meshlet.IndexCount, sizeof(meshlet.IndexCount));
+            HashBytes(cone, sizeof(cone));
+        }
+    }
+
+    for (const Material& material : materials)
+    {
+        HashBytes(material.diffuse, sizeof(material.diffuse));
+        HashBytes(&material.opacity, sizeof(material.opacity));
+    }
+
+    return hash;
+}
+
 
-        emscripten_fetch_close(fetch);
-        delete data;
-    };
 
-    attr.onerror = [](emscripten_fetch_t* fetch) {
-        auto* data = static_cast<FetchData*>(fetch->userData);
-        data->promise->set_value(nullptr);
-        emscripten_fetch_close(fetch);
-        delete data;
+
+#ifdef __EMSCRIPTEN__
+namespace
+{
+    struct FetchData
+    {
+        std::shared_ptr<std::promise<std::unique_ptr<const ObjModelLoader::ModelData>>> promise;
+        std::string filePath;
+        ObjModelLoader::LoadSettings settings;
     };
 
-    emscripten_fetch(&attr, m_ModelFilePath.c_str());
+    void FetchObj(FetchData* Data)
+    {
+        emscripten_fetch_attr_t attr;
+        emscripten_fetch_attr_init(&attr);
+        strcpy(attr.requestMethod, "GET");
+        attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+        attr.userData = Data;
+
+        attr.onsuccess = [](emscripten_fetch_t* fetch) {
+            auto* data = static_cast<FetchData*>(fetch->userData);
+
+            auto RetVal = ReadObjBuffer(fetch->data, static_cast<size_t>(fetch->numBytes), data->filePath, data->settings);
+            data->promise->set_value(std::move(RetVal));
+
+            emscripten_fetch_close(fetch);
+            delete data;
+        };
+
+        attr.onerror = [](emscripten_fetch_t* fetch) {
+            auto* data = static_cast<FetchData*>(fetch->userData);
+            data->promise->set_value(nullptr);
+            emscripten_fetch_close(fetch);
+            delete data;
+        };
+
+        emscripten_fetch(&attr, Data->filePath.c_str());
+    }
+
+    // Falls back to the .obj when there is no cooked file for these settings or it can't be read
+    void FetchCooked(FetchData* Data)
+    {
+        emscripten_fetch_attr_t attr;
+        emscripten_fetch_attr_init(&attr);
+        strcpy(attr.requestMethod, "GET");
+        attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+        attr.userData = Data;
+
+        attr.onsuccess = [](emscripten_fetch_t* fetch) {
+            auto* data = static_cast<FetchData*>(fetch->userData);
+
+            // The model views point straight into the fetched bytes, the fetch is closed with the model
+            std::shared_ptr<const void> storage(fetch, [](const void* closed) { emscripten_fetch_close(static_cast<emscripten_fetch_t*>(const_cast<void*>(closed))); });
+            auto RetVal = MeshCache::ReadCooked(std::move(storage), fetch->data, static_cast<size_t>(fetch->numBytes), data->settings.GetCacheKey());
+            if (!RetVal)
+            {
+                FetchObj(data);
+                return;
+            }
+
+            data->promise->set_value(std::move(RetVal));
+            delete data;
+        };
+
+        attr.onerror = [](emscripten_fetch_t* fetch) {
+            auto* data = static_cast<FetchData*>(fetch->userData);
+            emscripten_fetch_close(fetch);
+            FetchObj(data);
+        };
+
+        emscripten_fetch(&attr, MeshCache::GetCookedPath(Data->filePath, Data->settings.GetCacheKey()).c_str());
+    }
+}
+#endif
+
+std::future<std::unique_ptr<const ObjModelLoader::ModelData>> ObjModelLoader::Load()
+{
+#ifdef __EMSCRIPTEN__
+    auto promise = std::make_shared<std::promise<std::unique_ptr<const ModelData>>>();
+    auto future = promise->get_future();
+
+    auto fetchData = new FetchData{ promise, m_ModelFilePath, m_Settings };
+    if (m_Settings.PreferCooked)
+    {
+        FetchCooked(fetchData);
+    }
+    else
+    {
+        FetchObj(fetchData);
+    }
+
     return future;
 
 #else
     // Native async load
-    return std::async(std::launch::async, [filePath = this->m_ModelFilePath]() -> std::unique_ptr<const ModelData> {
-        
+    return std::async(std::launch::async, [filePath = this->m_ModelFilePath, settings = this->m_Settings]() -> std::unique_ptr<const ModelData> {
+        return ObjModelLoader(filePath, settings).LoadNow();
+    });
+#endif
+}
+
+#ifndef __EMSCRIPTEN__
+std::unique_ptr<const ObjModelLoader::ModelData> ObjModelLoader::LoadNow(StageTimings* OutTimings) const
+{
+    if (OutTimings)
+    {
+        *OutTimings = StageTimings();
+    }
+    StageTimer timer(OutTimings);
 
-        std::ifstream ifs(filePath);
-        if (!ifs)
+    if (m_Settings.PreferCooked)
+    {
+        auto cooked = MeshCache::ReadCooked(m_ModelFilePath, m_Settings.GetCacheKey());
+        timer.Lap(&StageTimings::ReadMs);
+        if (cooked)
+        {
+            return cooked;
+        }
+    }
+
+    if (m_Settings.UseMeshCache)
+    {
+        auto cached = MeshCache::Read(m_ModelFilePath, m_Settings.GetCacheKey());
+        timer.Lap(&StageTimings::ReadMs);
+        if (cached)
+        {
+            return cached;
+        }
+    }
+
+    std::unique_ptr<const ModelData> model;
+    {
+        // Both parse paths read straight from the mapped pages, the file is never copied into a stream or string
+        MappedFile file;
+        if (!file.Open(m_ModelFilePath))
         {
             return nullptr;
         }
+        timer.Lap(&StageTimings::ReadMs);
 
-        //tinyobj::MaterialFileReader matReader(".");
+        model = ReadObjBuffer(file.GetData(), file.GetSize(), m_ModelFilePath, m_Settings, OutTimings);
+    }
 
-        return ReadObjFile(ifs);
-    });
-#endif
+    if (model && m_Settings.UseMeshCache && !MeshCache::Write(m_ModelFilePath, m_Settings.GetCacheKey(), *model))
+    {
+        std::cerr << "Could not write mesh cache for " << m_ModelFilePath << std::endl;
+    }
+
+    return model;
 }
+#endif
 
-std::unique_ptr<ObjModelLoader::ModelData> ReadObjFile(std::istream& filestream)
+namespace
 {
-    struct VertexKey
+    // Owned storage behind the views of a loaded ModelData
+    struct ModelBuffers
+    {
+        std::vector<uint8_t> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint16_t> indices16;
+    };
+
+    // Simplifies every submesh into a chain of coarser levels, each level starts from the previous one so the chain costs
+    // about as much as the first level. Level errors add up so every level reports its distance from the full detail surface.
+    // The level indices are appended to Indices.
+    void BuildLods(std::vector<uint32_t>& Indices, std::vector<ObjModelLoader::ModelData::Submesh>& Submeshes, const float* Positions, size_t VertexCount,
+        const ObjModelLoader::LoadSettings& Settings, float ModelRadius)
+    {
+        const float maxError = Settings.LodMaxError * ModelRadius;
+
+        std::vector<std::vector<uint32_t>> levelIndices(Submeshes.size());
+        ParallelUtils::For(Submeshes.size(), Settings.ParseThreadCount, [&](size_t SubmeshIndex)
+        {
+            ObjModelLoader::ModelData::Submesh& submesh = Submeshes[SubmeshIndex];
+            std::vector<uint32_t>& levels = levelIndices[SubmeshIndex];
+
+            std::vector<uint32_t> previous(Indices.begin() + submesh.firstIndex, Indices.begin() + submesh.firstIndex + submesh.indexCount);
+            std::vector<uint32_t> simplified(previous.size());
+            float previousError = 0.0f;
+
+            for (float ratio : Settings.LodTriangleRatios)
+            {
+                const size_t targetIndexCount = static_cast<size_t>(submesh.indexCount / 3 * ratio) * 3;
+                if (targetIndexCount == 0 || targetIndexCount >= previous.size())
+                    continue;
+
+                float levelError = 0.0f;
+                const size_t indexCount = MeshSimplifier::Simplify(simplified.data(), previous.data(), previous.size(), Positions, VertexCount, 3,
+                    targetIndexCount, maxError - previousError, &levelError);
+
+                // A level that keeps more than 90% of the previous one is not worth a draw range, nothing coarser will get under
+                // the error limit either. Multiplied out so tiny submeshes, where a tenth rounds to nothing, still need a real reduction.
+                if (indexCount == 0 || indexCount >= previous.size() || indexCount * 10 > previous.size() * 9)
+                    break;
+
+                ObjModelLoader::ModelData::Lod lod;
+                lod.firstIndex = static_cast<uint32_t>(levels.size());
+                lod.indexCount = static_cast<uint32_t>(indexCount);
+                lod.error = previousError + levelError;
+                submesh.lods.push_back(lod);
+
+                levels.insert(levels.end(), simplified.begin(), simplified.begin() + indexCount);
+                previous.assign(simplified.begin(), simplified.begin() + indexCount);
+                previousError = lod.error;
+            }
+        });
+
+        for (size_t i = 0; i < Submeshes.size(); i++)
+        {
+            const uint32_t levelStart = static_cast<uint32_t>(Indices.size());
+            for (ObjModelLoader::ModelData::Lod& lod : Submeshes[i].lods)
+            {
+                lod.firstIndex += levelStart;
+            }
+            Indices.insert(Indices.end(), levelIndices[i].begin(), levelIndices[i].end());
+        }
+    }
+
+    // Meshlets grow from the cache optimized triangle order, afterwards every meshlet gets its own cache pass
+    // since growing reorders the triangles inside the submesh
+    void BuildSubmeshMeshlets(std::vector<uint32_t>& Indices, std::vector<ObjModelLoader::ModelData::Submesh>& Submeshes, const float* Positions, size_t VertexCount,
+        const ObjModelLoader::LoadSettings& Settings)
+    {
+        ParallelUtils::For(Submeshes.size(), Settings.ParseThreadCount, [&](size_t SubmeshIndex)
+        {
+            ObjModelLoader::ModelData::Submesh& submesh = Submeshes[SubmeshIndex];
+            MeshletBuilder::Build(Indices.data() + submesh.firstIndex, submesh.indexCount, Positions, VertexCount, 3, submesh.meshlets);
+
+            // The cache pass runs on meshlet local vertex numbers so its per vertex state stays meshlet sized
+            std::vector<uint32_t> localVertex(VertexCount, ~0u);
+            std::vector<uint32_t> meshletVertices, localIndices;
+            for (Meshlet& meshlet : submesh.meshlets)
+            {
+                meshlet.FirstIndex += submesh.firstIndex;
+                if (!Settings.OptimizeVertexOrder)
+                    continue;
+
+                uint32_t* meshletIndices = Indices.data() + meshlet.FirstIndex;
+                meshletVertices.clear();
+                localIndices.resize(meshlet.IndexCount);
+                for (uint32_t i = 0; i < meshlet.IndexCount; i++)
+                {
+                    uint32_t& local = localVertex[meshletIndices[i]];
+                    if (local == ~0u)
+                    {
+                        local = static_cast<uint32_t>(meshletVertices.size());
+                        meshletVertices.push_back(meshletIndices[i]);
+                    }
+                    localIndices[i] = local;
+                }
+
+                MeshOptimizer::OptimizeVertexCache(localIndices.data(), localIndices.size(), meshletVertices.size());
+
+                for (uint32_t i = 0; i < meshlet.IndexCount; i++)
+                {
+                    meshletIndices[i] = meshletVertices[localIndices[i]];
+                }
+                for (uint32_t vertex : meshletVertices)
+                {
+                    localVertex[vertex] = ~0u;
+                }
+            }
+        });
+    }
+
+    // Moves the triangles of every material into one contiguous submesh, materials in order of first use and triangles
+    // in file order inside each. Only the materials some triangle uses end up in the model.
+    void GroupByMaterial(std::vector<uint32_t>& indices, const std::vector<tinyobj::material_t>& materials, const std::vector<ObjMaterialRange>& materialRanges,
+        ObjModelLoader::ModelData& model)
     {
-        float px, py, pz;
-        float nx, ny, nz;
-        float u, v;
+        // Corners before the first range have no material
+        std::vector<ObjMaterialRange> ranges;
+        ranges.push_back({ 0, -1 });
+        ranges.insert(ranges.end(), materialRanges.begin(), materialRanges.end());
+
+        // Slot 0 is the group of the triangles without a material
+        std::vector<int32_t> groupOfMaterial(materials.size() + 1, -1);
+        std::vector<int> groupMaterials;
+        std::vector<size_t> groupCornerCounts;
+        for (size_t r = 0; r < ranges.size(); r++)
+        {
+            const size_t begin = ranges[r].FirstCorner;
+            const size_t end = r + 1 < ranges.size() ? ranges[r + 1].FirstCorner : indices.size();
+            if (end <= begin)
+                continue;
 
-        inline bool nearlyEqual(float a, float b, float eps = 1e-8f) const { return std::fabs(a - b) < eps; }
+            int32_t& group = groupOfMaterial[ranges[r].MaterialId + 1];
+            if (group < 0)
+            {
+                group = static_cast<int32_t>(groupMaterials.size());
+                groupMaterials.push_back(ranges[r].MaterialId);
+                groupCornerCounts.push_back(0);
+            }
+            groupCornerCounts[group] += end - begin;
+        }
+
+        std::vector<size_t> groupWrite(groupMaterials.size(), 0);
+        size_t firstIndex = 0;
+        for (size_t g = 0; g < groupMaterials.size(); g++)
+        {
+            ObjModelLoader::ModelData::Submesh submesh;
+            submesh.firstIndex = static_cast<uint32_t>(firstIndex);
+            submesh.indexCount = static_cast<uint32_t>(groupCornerCounts[g]);
 
-        bool isEqualPosition(const VertexKey& o) const { return nearlyEqual(px, o.px) && nearlyEqual(py, o.py) && nearlyEqual(pz, o.pz); }
-        bool isEqualNormal(const VertexKey& o) const { return nearlyEqual(nx, o.nx) && nearlyEqual(ny, o.ny) && nearlyEqual(nz, o.nz); }
-        bool isEqualUv(const VertexKey& o) const { return nearlyEqual(u, o.u) && nearlyEqual(v, o.v); }
+            if (groupMaterials[g] >= 0)
+            {
+                const tinyobj::material_t& source = materials[groupMaterials[g]];
+                ObjModelLoader::ModelData::Material material;
+                material.name = source.name;
+                std::copy(source.diffuse, source.diffuse + 3, material.diffuse);
+                material.opacity = source.dissolve;
+                material.diffuseTexture = source.diffuse_texname;
+
+                submesh.materialIndex = static_cast<int32_t>(model.materials.size());
+                model.materials.push_back(material);
+            }
 
-        bool operator == (const VertexKey& o) const
+            model.submeshes.push_back(submesh);
+            groupWrite[g] = firstIndex;
+            firstIndex += groupCornerCounts[g];
+        }
+
+        // A single group is already contiguous
+        if (groupMaterials.size() < 2)
+            return;
+
+        std::vector<uint32_t> grouped(indices.size());
+        for (size_t r = 0; r < ranges.size(); r++)
         {
-            return isEqualPosition(o) && isEqualNormal(o) && isEqualUv(o);
+            const size_t begin = ranges[r].FirstCorner;
+            const size_t end = r + 1 < ranges.size() ? ranges[r + 1].FirstCorner : indices.size();
+            if (end <= begin)
+                continue;
+
+            size_t& write = groupWrite[groupOfMaterial[ranges[r].MaterialId + 1]];
+            std::copy(indices.begin() + begin, indices.begin() + end, grouped.begin() + write);
+            write += end - begin;
         }
+        indices.swap(grouped);
+    }
 
-        bool compare(const VertexKey& o) const
+    // Packs the welded vertices into the requested layout, the separate streams are dropped once packed.
+    // MaterialRanges assigns the indices to materials, every used material becomes one submesh.
+    std::unique_ptr<const ObjModelLoader::ModelData> FinishModel(MeshWelder& welder, std::vector<uint32_t>&& indices, const std::vector<tinyobj::material_t>& materials,
+        const std::vector<ObjMaterialRange>& materialRanges, const ObjModelLoader::LoadSettings& settings, StageTimer& timer)
+    {
+        auto buffers = std::make_shared<ModelBuffers>();
+        buffers->indices = std::move(indices);
+
+        const size_t vertexCount = welder.GetVertexCount();
+        const size_t fullDetailIndexCount = buffers->indices.size();
+
+        auto model = std::make_unique<ObjModelLoader::ModelData>();
+        GroupByMaterial(buffers->indices, materials, materialRanges, *model);
+
+        VertexPacker::Quantization quantization;
         {
-            if (!nearlyEqual(px, o.px))
-                return px < o.px;
+            std::vector<float> positions, normals, texcoords;
+            welder.Release(positions, normals, texcoords);
 
-            if (!nearlyEqual(py, o.py))
-                return py < o.py;
+            // Every welded vertex is referenced, the mesh bounds can walk the vertices instead of the indices
+            model->bounds = MeshBounds::Compute(positions.data(), 3, vertexCount);
+            for (ObjModelLoader::ModelData::Submesh& submesh : model->submeshes)
+            {
+                submesh.bounds = MeshBounds::Compute(positions.data(), 3, buffers->indices.data() + submesh.firstIndex, submesh.indexCount);
+            }
 
-            if (!nearlyEqual(pz, o.pz))
-                return pz < o.pz;
+            if (!settings.LodTriangleRatios.empty())
+            {
+                BuildLods(buffers->indices, model->submeshes, positions.data(), vertexCount, settings, model->bounds.Sphere.GetRadius());
+            }
 
-            if (!nearlyEqual(nx, o.nx))
-                return nx < o.nx;
+            // Triangles only move inside their submesh, LOD level or meshlet so the ranges stay valid
+            if (settings.OptimizeVertexOrder)
+            {
+                for (const ObjModelLoader::ModelData::Submesh& submesh : model->submeshes)
+                {
+                    MeshOptimizer::OptimizeVertexCache(buffers->indices.data() + submesh.firstIndex, submesh.indexCount, vertexCount);
+                    for (const ObjModelLoader::ModelData::Lod& lod : submesh.lods)
+                    {
+                        MeshOptimizer::OptimizeVertexCache(buffers->indices.data() + lod.firstIndex, lod.indexCount, vertexCount);
+                    }
+                }
+            }
 
-            if (!nearlyEqual(ny, o.ny))
-                return ny < o.ny;
+            if (settings.BuildMeshlets)
+            {
+                BuildSubmeshMeshlets(buffers->indices, model->submeshes, positions.data(), vertexCount, settings);
+            }
 
-            if (!nearlyEqual(nz, o.nz))
-                return nz < o.nz;
+            VertexPacker::Streams streams;
+            streams.Positions = positions.data();
+            streams.Normals = normals.data();
+            streams.Texcoords = texcoords.data();
 
-            if (!nearlyEqual(u, o.u))
-                return u < o.u;
+            std::vector<float> tangents;
+            if (settings.Layout.FindAttribute(VertexLayout::Semantic::Tangent) >= 0)
+            {
+                // LOD levels reuse the vertices, only the full detail triangles shape the tangent frames
+                tangents.resize(vertexCount * 4);
+                TangentGenerator::Generate(positions.data(), normals.data(), texcoords.data(), vertexCount, buffers->indices.data(), fullDetailIndexCount,
+                    tangents.data(), settings.ParseThreadCount);
+                streams.Tangents = tangents.data();
+            }
+            timer.Lap(&ObjModelLoader::StageTimings::PostProcessMs);
+
+            quantization = VertexPacker::ComputeQuantization(settings.Layout, streams, vertexCount);
 
-            return v < o.v;
+            buffers->vertices.resize(vertexCount * settings.Layout.GetStride());
+            VertexPacker::Pack(settings.Layout, streams, quantization, vertexCount, buffers->vertices.data(), settings.ParseThreadCount);
         }
 
-        bool operator < (const VertexKey& o) const
+        if (settings.OptimizeVertexOrder)
         {
-            return compare(o);
+            std::vector<uint32_t> remap;
+            MeshOptimizer::OptimizeVertexFetch(buffers->indices.data(), buffers->indices.size(), vertexCount, remap);
+            MeshOptimizer::RemapVertices(buffers->vertices.data(), vertexCount, settings.Layout.GetStride(), remap);
         }
 
-    };
+        model->vertices = buffers->vertices;
+        model->layout = settings.Layout;
+        model->vertexCount = static_cast<uint32_t>(vertexCount);
+        model->quantization = quantization;
+        model->indexCount = static_cast<uint32_t>(buffers->indices.size());
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
+        if (settings.Allow16BitIndices && vertexCount <= 0x10000)
+        {
+            buffers->indices16.assign(buffers->indices.begin(), buffers->indices.end());
+            std::vector<uint32_t>().swap(buffers->indices);
+
+            model->indexFormat = ObjModelLoader::ModelData::IndexFormat::Uint16;
+            model->indexData = ArrayView<uint8_t>(reinterpret_cast<const uint8_t*>(buffers->indices16.data()), buffers->indices16.size() * sizeof(uint16_t));
+        }
+        else
+        {
+            model->indexFormat = ObjModelLoader::ModelData::IndexFormat::Uint32;
+            model->indexData = ArrayView<uint8_t>(reinterpret_cast<const uint8_t*>(buffers->indices.data()), buffers->indices.size() * sizeof(uint32_t));
+        }
 
-    if (tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &filestream))
+        model->contentHash = model->ComputeContentHash();
+        model->storage = std::move(buffers);
+        timer.Lap(&ObjModelLoader::StageTimings::PackMs);
+        return model;
+    }
+
+    // Smooth normals for every corner of CornerLists, in order, when some corner has no vn reference. Empty when none is missing.
+    // False when a corner references a position the file does not have.
+    bool GenerateMissingNormals(const tinyobj::attrib_t& attrib, const std::vector<const std::vector<tinyobj::index_t>*>& cornerLists,
+        const ObjModelLoader::LoadSettings& settings, std::vector<float>& normals)
     {
-        auto model = std::make_unique<ObjModelLoader::ModelData>();
+        normals.clear();
+        if (!settings.GenerateMissingNormals)
+            return true;
+
+        size_t cornerCount = 0;
+        bool missing = false;
+        for (const std::vector<tinyobj::index_t>* corners : cornerLists)
+        {
+            cornerCount += corners->size();
+            for (const tinyobj::index_t& idx : *corners)
+            {
+                missing = missing || idx.normal_index < 0;
+            }
+        }
 
-        std::map<VertexKey, uint32_t> uniqueVerts;
+        if (!missing)
+            return true;
 
-        for (const auto& shape : shapes)
+        const size_t positionCount = attrib.vertices.size() / 3;
+        std::vector<uint32_t> positionIndices;
+        positionIndices.reserve(cornerCount);
+        for (const std::vector<tinyobj::index_t>* corners : cornerLists)
         {
-            for (const auto& idx : shape.mesh.indices)
+            for (const tinyobj::index_t& idx : *corners)
             {
-                Pandu::Vector3 position(0, 0, 0), normal(0, 0, 1);
-                Pandu::Vector2 uv(0, 0);
+                if (idx.vertex_index < 0 || static_cast<size_t>(idx.vertex_index) >= positionCount)
+                {
+                    std::cerr << "Obj face references position " << idx.vertex_index + 1 << " of " << positionCount << std::endl;
+                    return false;
+                }
+                positionIndices.push_back(static_cast<uint32_t>(idx.vertex_index));
+            }
+        }
 
-                if (idx.vertex_index >= 0) position = { attrib.vertices[3 * idx.vertex_index + 0], attrib.vertices[3 * idx.vertex_index + 1], attrib.vertices[3 * idx.vertex_index + 2] };
-                if (idx.normal_index >= 0)  normal = { attrib.normals[3 * idx.normal_index + 0], attrib.normals[3 * idx.normal_index + 1], attrib.normals[3 * idx.normal_index + 2] };
+        normals.resize(cornerCount * 3);
+        NormalGenerator::Generate(attrib.vertices.data(), attrib.vertices.size() / 3, positionIndices.data(), cornerCount,
+            settings.NormalCreaseAngle * Pandu::kPI / 180.0f, normals.data(), settings.ParseThreadCount);
+        return true;
+    }
 
-                if (idx.texcoord_index >= 0) uv = { attrib.texcoords[2 * idx.texcoord_index + 0], attrib.texcoords[2 * idx.texcoord_index + 1] };
+    // GeneratedNormals, when set, holds a normal for every corner, used by the corners without a vn reference
+    void WeldCorners(std::vector<uint32_t>& indices, MeshWelder& welder, const tinyobj::attrib_t& attrib, const std::vector<tinyobj::index_t>& corners,
+        const float* generatedNormals)
+    {
+        for (size_t i = 0; i < corners.size(); i++)
+        {
+            const tinyobj::index_t& idx = corners[i];
+            Pandu::Vector3 position(0, 0, 0), normal(0, 0, 1);
+            Pandu::Vector2 uv(0, 0);
 
-                VertexKey key{ position.x, position.y, position.z, normal.x, normal.y, normal.z, uv.x, uv.y };
+            if (idx.vertex_index >= 0) position = { attrib.vertices[3 * idx.vertex_index + 0], attrib.vertices[3 * idx.vertex_index + 1], attrib.vertices[3 * idx.vertex_index + 2] };
+            if (idx.normal_index >= 0)  normal = { attrib.normals[3 * idx.normal_index + 0], attrib.normals[3 * idx.normal_index + 1], attrib.normals[3 * idx.normal_index + 2] };
+            else if (generatedNormals) normal = { generatedNormals[3 * i + 0], generatedNormals[3 * i + 1], generatedNormals[3 * i + 2] };
 
-                auto it = uniqueVerts.find(key);
-                if (it == uniqueVerts.end())
-                {
-                    uint32_t newIndex = static_cast<uint32_t>(model->positions.size() / 3);
-                    uniqueVerts[key] = newIndex;
+            if (idx.texcoord_index >= 0) uv = { attrib.texcoords[2 * idx.texcoord_index + 0], attrib.texcoords[2 * idx.texcoord_index + 1] };
+
+            indices.push_back(welder.AddVertex(position.Data(), normal.Data(), uv.Data()));
+        }
+    }
+}
+
+std::unique_ptr<const ObjModelLoader::ModelData> ReadObjBuffer(const char* Data, size_t Size, const std::string& FilePath, const ObjModelLoader::LoadSettings& Settings,
+    ObjModelLoader::StageTimings* Timings)
+{
+    StageTimer timer(Timings);
 
-                    model->positions.push_back(position.x);
-                    model->positions.push_back(position.y);
-                    model->positions.push_back(position.z);
+    // mtllib names are relative to the .obj
+    const size_t separator = FilePath.find_last_of("/\\");
+    tinyobj::MaterialFileReader materialReader(separator != std::string::npos ? FilePath.substr(0, separator + 1) : std::string());
 
-                    model->normals.push_back(normal.x);
-                    model->normals.push_back(normal.y);
-                    model->normals.push_back(normal.z);
+    std::vector<tinyobj::material_t> materials;
+    std::vector<ObjMaterialRange> materialRanges;
+
+    if (Settings.StreamingParse)
+    {
+        // A bit over one welded vertex per 100 bytes of text is typical, the welder grows past that if needed
+        MeshWelder welder(Settings.Weld, Size / 100);
+        std::vector<uint32_t> indices;
 
-                    model->texcoords.push_back(uv.x);
-                    model->texcoords.push_back(uv.y);
+        const bool parsed = ObjStreamParser::Parse(Data, Size, Settings.GenerateMissingNormals, &materialReader, welder, indices, materials, materialRanges);
+        timer.Lap(&ObjModelLoader::StageTimings::ParseMs);
 
-                    model->indices.push_back(newIndex);
-                }
-                else
+        if (parsed)
+        {
+            return FinishModel(welder, std::move(indices), materials, materialRanges, Settings, timer);
+        }
+    }
+
+    if (Settings.ParallelParse)
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::index_t> corners;
+
+        const bool parsed = ObjChunkedParser::Parse(Data, Size, Settings.ParseThreadCount, &materialReader, attrib, corners, materials, materialRanges);
+        timer.Lap(&ObjModelLoader::StageTimings::ParseMs);
+
+        if (parsed)
+        {
+            std::vector<uint32_t> indices;
+            indices.reserve(corners.size());
+
+            std::vector<float> generatedNormals;
+            if (!GenerateMissingNormals(attrib, { &corners }, Settings, generatedNormals))
+                return nullptr;
+
+            MeshWelder welder(Settings.Weld, attrib.vertices.size() / 3);
+            WeldCorners(indices, welder, attrib, corners, generatedNormals.empty() ? nullptr : generatedNormals.data());
+            timer.Lap(&ObjModelLoader::StageTimings::WeldMs);
+
+            return FinishModel(welder, std::move(indices), materials, materialRanges, Settings, timer);
+        }
+    }
+
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::string warn, err;
+    materials.clear();
+
+    const bool loaded = tinyobj::LoadObjFromMemory(&attrib, &shapes, &materials, &warn, &err, std::string_view(Data, Size), &materialReader);
+    timer.Lap(&ObjModelLoader::StageTimings::ParseMs);
+
+    if (loaded)
+    {
+        // Shapes are concatenated, the per triangle material ids become ranges of the joined corners
+        materialRanges.clear();
+        size_t cornerCount = 0;
+        int materialId = -1;
+        for (const auto& shape : shapes)
+        {
+            for (size_t t = 0; t < shape.mesh.material_ids.size(); t++)
+            {
+                if (shape.mesh.material_ids[t] != materialId)
                 {
-                    // Already created
-                    model->indices.push_back(it->second);
+                    materialId = shape.mesh.material_ids[t];
+                    materialRanges.push_back({ cornerCount + t * 3, materialId });
                 }
             }
+            cornerCount += shape.mesh.indices.size();
         }
 
-        return model;
+        std::vector<uint32_t> indices;
+        indices.reserve(cornerCount);
+
+        std::vector<const std::vector<tinyobj::index_t>*> cornerLists;
+        for (const auto& shape : shapes)
+        {
+            cornerLists.push_back(&shape.mesh.indices);
+        }
+        std::vector<float> generatedNormals;
+        if (!GenerateMissingNormals(attrib, cornerLists, Settings, generatedNormals))
+            return nullptr;
+
+        MeshWelder welder(Settings.Weld, attrib.vertices.size() / 3);
+
+        size_t firstCorner = 0;
+        for (const auto& shape : shapes)
+        {
+            WeldCorners(indices, welder, attrib, shape.mesh.indices, generatedNormals.empty() ? nullptr : generatedNormals.data() + firstCorner * 3);
+            firstCorner += shape.mesh.indices.size();
+        }
+        timer.Lap(&ObjModelLoader::StageTimings::WeldMs);
+
+        return FinishModel(welder, std::move(indices), materials, materialRanges, Settings, timer);
     }
 
+    std::cerr << "Obj file load failed : " << err << std::endl;
     return nullptr;
-}
\ No newline at end of file
+}
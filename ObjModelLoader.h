@@ -1,23 +1,237 @@
 #ifndef __ObjModelLoader_h__
 #define __ObjModelLoader_h__
 
+#include <cstdint>
 #include <string>
 #include <future>
 #include <memory>
+#include <vector>
+#include <ArrayView.h>
+#include <MeshBounds.h>
+#include <MeshletBuilder.h>
+#include <MeshWelder.h>
+#include <VertexPacker.h>
 
 class ObjModelLoader
 {
 public:
 
+	// Upload-ready mesh. The views point either into buffers built by the loader or straight into a mapped cooked mesh file,
+	// storage keeps whichever one it is alive.
 	struct ModelData
 	{
-		std::vector<float> positions;
-		std::vector<float> normals;
-		std::vector<float> texcoords;
-		std::vector<unsigned int> indices;
+		enum class IndexFormat : uint8_t
+		{
+			Uint16,
+			Uint32,
+		};
+
+		// Simplified copy of a submesh, drawn with the same vertices
+		struct Lod
+		{
+			Lod()
+				: firstIndex(0)
+				, indexCount(0)
+				, error(0.0f)
+			{
+			}
+
+			uint32_t firstIndex;
+			uint32_t indexCount;
+
+			// How far the surface may be from the full detail one, in model space units
+			float error;
+		};
+
+		// Surface parameters of one material from the .mtl files the model references
+		struct Material
+		{
+			Material()
+				: diffuse{ 1.0f, 1.0f, 1.0f }
+				, opacity(1.0f)
+			{
+			}
+
+			std::string name;
+
+			// Kd and d
+			float diffuse[3];
+			float opacity;
+
+			// map_Kd as written in the .mtl file, relative to it, empty without a texture
+			std::string diffuseTexture;
+		};
+
+		// Contiguous index range with every triangle of one material, in file order
+		struct Submesh
+		{
+			Submesh()
+				: firstIndex(0)
+				, indexCount(0)
+				, materialIndex(-1)
+			{
+			}
+
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			MeshBounds bounds;
+
+			// Into materials, -1 for the triangles without a material the .mtl files define
+			int32_t materialIndex;
+
+			// Coarser levels only, from fine to coarse, stored after every full detail submesh
+			std::vector<Lod> lods;
+
+			// Partition of the full detail range into small clusters for culling below object granularity, ranges are absolute
+			std::vector<Meshlet> meshlets;
+		};
+
+		ModelData()
+			: vertexCount(0)
+			, indexFormat(IndexFormat::Uint32)
+			, indexCount(0)
+			, contentHash(0)
+		{
+		}
+
+		static uint32_t GetIndexSize(IndexFormat Format) { return Format == IndexFormat::Uint16 ? 2 : 4; }
+
+		uint32_t GetIndex(size_t Index) const
+		{
+			if (indexFormat == IndexFormat::Uint16)
+				return reinterpret_cast<const uint16_t*>(indexData.data())[Index];
+			return reinterpret_cast<const uint32_t*>(indexData.data())[Index];
+		}
+
+		// Identifies what is drawn: vertices, indices, submesh, LOD and meshlet ranges and material colors. Models that hash equal
+		// can share their GPU buffers, whatever file and settings they came from. Reads every byte, loads store it in contentHash.
+		uint64_t ComputeContentHash() const;
+
+		// Interleaved vertices in the layout requested through LoadSettings, handed to the vertex buffer as is
+		ArrayView<uint8_t> vertices;
+		VertexLayout layout;
+		uint32_t vertexCount;
+
+		// Undoes the position quantization of compact layouts, identity for float positions
+		VertexPacker::Quantization quantization;
+
+		// indexCount indices, 16 bit whenever every vertex can be addressed with them
+		IndexFormat indexFormat;
+		uint32_t indexCount;
+		ArrayView<uint8_t> indexData;
+
+		// Computed once while loading, visibility and LOD decisions never have to read the vertices back
+		MeshBounds bounds;
+		std::vector<Submesh> submeshes;
+
+		// The materials the submeshes use, in order of first use
+		std::vector<Material> materials;
+
+		// ComputeContentHash of the finished model, taken on the loading thread so the render thread only compares it
+		uint64_t contentHash;
+
+		std::shared_ptr<const void> storage;
+	};
+
+	struct LoadSettings
+	{
+		LoadSettings()
+			: ParallelParse(true)
+#ifdef __EMSCRIPTEN__
+			, StreamingParse(true)
+#else
+			, StreamingParse(false)
+#endif
+			, ParseThreadCount(0)
+			, PreferCooked(true)
+			, UseMeshCache(true)
+			, OptimizeVertexOrder(true)
+			, Allow16BitIndices(true)
+			, BuildMeshlets(true)
+			, GenerateMissingNormals(true)
+			, NormalCreaseAngle(60.0f)
+			, Layout(VertexLayout::CreateDefault())
+			, LodTriangleRatios({ 0.5f, 0.25f, 0.125f })
+			, LodMaxError(0.02f)
+		{
+		}
+
+		MeshWelder::Settings Weld;
+
+		// Parse v/vn/vt/f records on several threads, files the chunked parser can't reproduce exactly fall back to tinyobj
+		bool ParallelParse;
+
+		// Weld corners while tinyobj reads the file instead of keeping every shape and corner around, lowers peak memory.
+		// Single threaded, so it is only the default on the web build. Files it can't handle, or that need generated normals,
+		// go through the other parsers.
+		bool StreamingParse;
+
+		// 0 uses every hardware thread
+		uint32_t ParseThreadCount;
+
+		// Load the file the AssetCooker built for these settings when there is one, and skip parsing altogether
+		bool PreferCooked;
+
+		// Native builds keep a cooked binary copy next to the .obj and map it instead of parsing on later loads
+		bool UseMeshCache;
+
+		// Reorder triangles for post-transform cache reuse and vertices for fetch locality
+		bool OptimizeVertexOrder;
+
+		// Store indices as uint16_t for meshes with at most 65536 vertices
+		bool Allow16BitIndices;
+
+		// Reorder the triangles of every submesh into meshlets with bounding spheres and normal cones
+		bool BuildMeshlets;
+
+		// Corners without a vn reference get angle weighted smooth normals instead of (0, 0, 1)
+		bool GenerateMissingNormals;
+
+		// Faces meeting at a sharper angle than this, in degrees, keep a hard edge between their generated normals
+		float NormalCreaseAngle;
+
+		// Vertex format the loader packs into, has to match the pipeline the model is drawn with
+		VertexLayout Layout;
+
+		// Triangle count of every generated LOD level relative to the full detail submesh, empty builds no LODs
+		std::vector<float> LodTriangleRatios;
+
+		// Simplification stops where the surface would move further than this, relative to the model bounding sphere radius
+		float LodMaxError;
+
+		// Identifies the settings that change the loaded data, cooked files built with other settings are ignored
+		uint64_t GetCacheKey() const;
+	};
+
+	// Milliseconds spent in each stage of one load, for benchmarks
+	struct StageTimings
+	{
+		StageTimings()
+			: ReadMs(0.0)
+			, ParseMs(0.0)
+			, WeldMs(0.0)
+			, PostProcessMs(0.0)
+			, PackMs(0.0)
+		{
+		}
+
+		// Opening and mapping the file, or reading the whole model from the mesh cache
+		double ReadMs;
+
+		// Text to attributes and corners. The streaming parser welds while it parses, its welding counts here.
+		double ParseMs;
+
+		// Generating missing normals and welding the corners into vertices
+		double WeldMs;
+
+		// Material grouping, bounds, LODs, vertex cache order, meshlets and tangents
+		double PostProcessMs;
+
+		// Quantization, vertex packing, fetch order and index narrowing
+		double PackMs;
 	};
 
-	ObjModelLoader(const std::string& FilePath);
+	ObjModelLoader(const std::string& FilePath, const LoadSettings& Settings = LoadSettings());
 	virtual ~ObjModelLoader();
 
 	ObjModelLoader(const ObjModelLoader&) = delete;
@@ -28,9 +242,16 @@ public:
 
 	std::future<std::unique_ptr<const ModelData>> Load();
 
+#ifndef __EMSCRIPTEN__
+	// Loads on the calling thread, the web build can only fetch files asynchronously through Load.
+	// OutTimings, when set, gets the time of every stage.
+	std::unique_ptr<const ModelData> LoadNow(StageTimings* OutTimings = nullptr) const;
+#endif
+
 private:
 
 	const std::string m_ModelFilePath;
+	const LoadSettings m_Settings;
 };
 
 #endif //__ObjModelLoader_h__
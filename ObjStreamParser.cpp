@@ -0,0 +1,262 @@
+#include "ObjStreamParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <streambuf>
+#include <string>
+
+namespace
+{
+    // Reads straight out of the caller's buffer, the file is never copied into a stringstream
+    class MemoryStreamBuffer : public std::streambuf
+    {
+    public:
+
+        MemoryStreamBuffer(const char* Data, size_t Size)
+        {
+            char* begin = const_cast<char*>(Data);
+            setg(begin, begin, begin + Size);
+        }
+
+        // Makes the stream look exhausted, LoadObjWithCallback has no other way to stop early
+        void Stop()
+        {
+            setg(egptr(), egptr(), egptr());
+        }
+    };
+
+    struct StreamState
+    {
+        StreamState(MemoryStreamBuffer& InBuffer, bool InRequireNormals, MeshWelder& InWelder, std::vector<uint32_t>& InIndices,
+            std::vector<tinyobj::material_t>& InMaterials, std::vector<ObjMaterialRange>& InMaterialRanges)
+            : Buffer(InBuffer)
+            , RequireNormals(InRequireNormals)
+            , Welder(InWelder)
+            , Indices(InIndices)
+            , Materials(InMaterials)
+            , MaterialRanges(InMaterialRanges)
+            , MaterialId(-1)
+            , Failed(false)
+        {
+        }
+
+        MemoryStreamBuffer& Buffer;
+        const bool RequireNormals;
+
+        std::vector<float> Vertices;
+        std::vector<float> Normals;
+        std::vector<float> Texcoords;
+
+        MeshWelder& Welder;
+        std::vector<uint32_t>& Indices;
+
+        // Every material read so far and the name lookup tinyobj::LoadObj would have built from them
+        std::vector<tinyobj::material_t>& Materials;
+        std::map<std::string, int> MaterialMap;
+        std::vector<ObjMaterialRange>& MaterialRanges;
+        int MaterialId;
+
+        bool Failed;
+
+        void Fail()
+        {
+            Failed = true;
+            Buffer.Stop();
+        }
+    };
+
+    // Same rules as tinyobj's fixIndex, Count is the number of elements defined before the line
+    inline bool ResolveIndex(int RawIndex, int Count, bool AllowZero, int& OutIndex)
+    {
+        if (RawIndex > 0)
+        {
+            OutIndex = RawIndex - 1;
+            return true;
+        }
+
+        if (RawIndex == 0)
+        {
+            OutIndex = -1;
+            return AllowZero;
+        }
+
+        OutIndex = Count + RawIndex;
+        return OutIndex >= 0;
+    }
+
+    void OnVertex(void* UserData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z, tinyobj::real_t)
+    {
+        std::vector<float>& vertices = static_cast<StreamState*>(UserData)->Vertices;
+        vertices.push_back(x);
+        vertices.push_back(y);
+        vertices.push_back(z);
+    }
+
+    void OnNormal(void* UserData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z)
+    {
+        std::vector<float>& normals = static_cast<StreamState*>(UserData)->Normals;
+        normals.push_back(x);
+        normals.push_back(y);
+        normals.push_back(z);
+    }
+
+    void OnTexcoord(void* UserData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t)
+    {
+        std::vector<float>& texcoords = static_cast<StreamState*>(UserData)->Texcoords;
+        texcoords.push_back(x);
+        texcoords.push_back(y);
+    }
+
+    void OnFace(void* UserData, tinyobj::index_t* RawCorners, int CornerCount)
+    {
+        StreamState& state = *static_cast<StreamState*>(UserData);
+        if (state.Failed)
+            return;
+
+        if (CornerCount > 4)
+        {
+            // tinyobj ear-clips these, leave it to the buffered parsers
+            state.Fail();
+            return;
+        }
+
+        const int vertexCount = static_cast<int>(state.Vertices.size() / 3);
+        const int normalCount = static_cast<int>(state.Normals.size() / 3);
+        const int texcoordCount = static_cast<int>(state.Texcoords.size() / 2);
+
+        // Every index has to be valid even on degenerate faces, tinyobj rejects the file otherwise
+        tinyobj::index_t corners[4];
+        for (int i = 0; i < CornerCount; i++)
+        {
+            tinyobj::index_t& corner = corners[i];
+            if (!ResolveIndex(RawCorners[i].vertex_index, vertexCount, false, corner.vertex_index)
+                || !ResolveIndex(RawCorners[i].normal_index, normalCount, true, corner.normal_index)
+                || !ResolveIndex(RawCorners[i].texcoord_index, texcoordCount, true, corner.texcoord_index))
+            {
+                state.Fail();
+                return;
+            }
+
+            // Only what was read so far is known, forward references go to the buffered parsers
+            if (corner.vertex_index >= vertexCount || corner.normal_index >= normalCount || corner.texcoord_index >= texcoordCount
+                || (state.RequireNormals && corner.normal_index < 0))
+            {
+                state.Fail();
+                return;
+            }
+        }
+
+        if (CornerCount < 3)
+            return;
+
+        // Triangle corners in tinyobj's order, quads split along the shorter diagonal like exportGroupsToShape does
+        int triangles[6] = { 0, 1, 2, 0, 0, 0 };
+        int triangleCornerCount = 3;
+        if (CornerCount == 4)
+        {
+            const float* v = state.Vertices.data();
+            const size_t vi0 = size_t(corners[0].vertex_index);
+            const size_t vi1 = size_t(corners[1].vertex_index);
+            const size_t vi2 = size_t(corners[2].vertex_index);
+            const size_t vi3 = size_t(corners[3].vertex_index);
+
+            tinyobj::real_t e02x = v[vi2 * 3 + 0] - v[vi0 * 3 + 0];
+            tinyobj::real_t e02y = v[vi2 * 3 + 1] - v[vi0 * 3 + 1];
+            tinyobj::real_t e02z = v[vi2 * 3 + 2] - v[vi0 * 3 + 2];
+            tinyobj::real_t e13x = v[vi3 * 3 + 0] - v[vi1 * 3 + 0];
+            tinyobj::real_t e13y = v[vi3 * 3 + 1] - v[vi1 * 3 + 1];
+            tinyobj::real_t e13z = v[vi3 * 3 + 2] - v[vi1 * 3 + 2];
+
+            tinyobj::real_t sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+            tinyobj::real_t sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+            static const int shortDiagonal02[6] = { 0, 1, 2, 0, 2, 3 };
+            static const int shortDiagonal13[6] = { 0, 1, 3, 1, 2, 3 };
+            const int* split = sqr02 < sqr13 ? shortDiagonal02 : shortDiagonal13;
+            std::copy(split, split + 6, triangles);
+            triangleCornerCount = 6;
+        }
+
+        // Welded in the order the corners are emitted, so new vertices are numbered exactly like the buffered parsers number them
+        static const float defaultNormal[3] = { 0.0f, 0.0f, 1.0f };
+        static const float defaultTexcoord[2] = { 0.0f, 0.0f };
+
+        uint32_t welded[4];
+        bool isWelded[4] = { false, false, false, false };
+        for (int i = 0; i < triangleCornerCount; i++)
+        {
+            const int c = triangles[i];
+            if (!isWelded[c])
+            {
+                const tinyobj::index_t& corner = corners[c];
+                const float* position = state.Vertices.data() + 3 * static_cast<size_t>(corner.vertex_index);
+                const float* normal = corner.normal_index >= 0 ? state.Normals.data() + 3 * static_cast<size_t>(corner.normal_index) : defaultNormal;
+                const float* texcoord = corner.texcoord_index >= 0 ? state.Texcoords.data() + 2 * static_cast<size_t>(corner.texcoord_index) : defaultTexcoord;
+
+                welded[c] = state.Welder.AddVertex(position, normal, texcoord);
+                isWelded[c] = true;
+            }
+            state.Indices.push_back(welded[c]);
+        }
+    }
+
+    // Gets every material loaded so far, the map keeps the first material of a name like LoadMtl does
+    void OnMaterialLibrary(void* UserData, const tinyobj::material_t* Materials, int MaterialCount)
+    {
+        StreamState& state = *static_cast<StreamState*>(UserData);
+        state.Materials.assign(Materials, Materials + MaterialCount);
+        state.MaterialMap.clear();
+        for (int i = 0; i < MaterialCount; i++)
+        {
+            state.MaterialMap.insert(std::make_pair(Materials[i].name, i));
+        }
+    }
+
+    // The callback gets the rest of the line, tinyobj::LoadObj only looks up its first word
+    void OnUseMaterial(void* UserData, const char* Line, int)
+    {
+        StreamState& state = *static_cast<StreamState*>(UserData);
+
+        const char* name = Line + strspn(Line, " \t");
+        std::map<std::string, int>::const_iterator it = state.MaterialMap.find(std::string(name, strcspn(name, " \t\r")));
+        const int materialId = it != state.MaterialMap.end() ? it->second : -1;
+
+        if (materialId != state.MaterialId)
+        {
+            state.MaterialRanges.push_back({ state.Indices.size(), materialId });
+            state.MaterialId = materialId;
+        }
+    }
+}
+
+bool ObjStreamParser::Parse(const char* Data, size_t Size, bool RequireNormals, tinyobj::MaterialReader* ReadMaterial, MeshWelder& Welder,
+    std::vector<uint32_t>& OutIndices, std::vector<tinyobj::material_t>& OutMaterials, std::vector<ObjMaterialRange>& OutMaterialRanges)
+{
+    // tinyobj strips a UTF-8 BOM from the first line
+    if (Size >= 3 && static_cast<unsigned char>(Data[0]) == 0xEF && static_cast<unsigned char>(Data[1]) == 0xBB && static_cast<unsigned char>(Data[2]) == 0xBF)
+    {
+        Data += 3;
+        Size -= 3;
+    }
+
+    OutIndices.clear();
+    OutMaterials.clear();
+    OutMaterialRanges.clear();
+
+    MemoryStreamBuffer buffer(Data, Size);
+    std::istream stream(&buffer);
+
+    StreamState state(buffer, RequireNormals, Welder, OutIndices, OutMaterials, OutMaterialRanges);
+
+    tinyobj::callback_t callbacks;
+    callbacks.vertex_cb = OnVertex;
+    callbacks.normal_cb = OnNormal;
+    callbacks.texcoord_cb = OnTexcoord;
+    callbacks.index_cb = OnFace;
+    callbacks.mtllib_cb = OnMaterialLibrary;
+    callbacks.usemtl_cb = OnUseMaterial;
+
+    return tinyobj::LoadObjWithCallback(stream, callbacks, &state, ReadMaterial) && !state.Failed;
+}
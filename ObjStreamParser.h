@@ -0,0 +1,25 @@
+#ifndef __ObjStreamParser_h__
+#define __ObjStreamParser_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <MeshWelder.h>
+#include "ObjMaterialRange.h"
+#include "tiny_obj_loader.h"
+
+// Parses an in-memory .obj through tinyobj::LoadObjWithCallback and welds every corner the moment its face is read.
+// Only the v/vn/vt arrays the faces index into are kept besides the welder, there is no shape or corner list,
+// so peak memory stays close to the final mesh. Triangulation and material ids match tinyobj::LoadObj.
+class ObjStreamParser
+{
+public:
+
+	// Returns false when the file uses something this parser does not reproduce exactly (n-gons above quads,
+	// forward or invalid references, ...) or, with RequireNormals, when a corner has no normal.
+	// Callers fall back to the buffered parsers then. mtllib files are read through ReadMaterial, none are read when it is null.
+	static bool Parse(const char* Data, size_t Size, bool RequireNormals, tinyobj::MaterialReader* ReadMaterial, MeshWelder& Welder,
+		std::vector<uint32_t>& OutIndices, std::vector<tinyobj::material_t>& OutMaterials, std::vector<ObjMaterialRange>& OutMaterialRanges);
+};
+
+#endif //__ObjStreamParser_h__
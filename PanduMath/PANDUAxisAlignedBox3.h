@@ -34,6 +34,37 @@ namespace Pandu
 		inline const Vector3& GetMin() const		{	return m_Min;				}
 		inline const Vector3& GetMax() const		{	return m_Max;				}
 
+		inline Vector3 GetCenter() const			{	return (m_Min + m_Max) * 0.5f;	}
+		inline Vector3 GetHalfExtents() const		{	return (m_Max - m_Min) * 0.5f;	}
+
+		// Inverted, the first Merge sets both corners
+		inline void SetEmpty()
+		{
+			const float maxValue = std::numeric_limits<float>::max();
+			m_Min = Vector3(maxValue, maxValue, maxValue);
+			m_Max = Vector3(-maxValue, -maxValue, -maxValue);
+		}
+
+		inline bool IsEmpty() const
+		{
+			return m_Min.x > m_Max.x || m_Min.y > m_Max.y || m_Min.z > m_Max.z;
+		}
+
+		inline void Merge(const Vector3& _point)
+		{
+			m_Min = Vector3(std::fmin(m_Min.x, _point.x), std::fmin(m_Min.y, _point.y), std::fmin(m_Min.z, _point.z));
+			m_Max = Vector3(std::fmax(m_Max.x, _point.x), std::fmax(m_Max.y, _point.y), std::fmax(m_Max.z, _point.z));
+		}
+
+		inline void Merge(const AxisAlignedBox3& _box)
+		{
+			if (_box.IsEmpty())
+				return;
+
+			Merge(_box.m_Min);
+			Merge(_box.m_Max);
+		}
+
 	};
 }
 
@@ -0,0 +1,183 @@
+#include "PANDUBatch.h"
+#include "PANDUMatrix44.h"
+#include "PANDUSimd.h"
+#include <limits>
+
+namespace
+{
+	using namespace Pandu::Simd;
+
+	// Runs _kernel(x, y, z, outX, outY, outZ) on four vectors per step. The last partial step goes through zero padded
+	// copies so the kernels never read or write past _count.
+	template <typename KernelType>
+	inline void ForEachGroup(const Pandu::ConstVector3SoA& _in, const Pandu::Vector3SoA& _out, size_t _count, KernelType&& _kernel)
+	{
+		size_t i = 0;
+		for (; i + 4 <= _count; i += 4)
+		{
+			Float4 x, y, z;
+			_kernel(Load(_in.x + i), Load(_in.y + i), Load(_in.z + i), x, y, z);
+			Store(_out.x + i, x);
+			Store(_out.y + i, y);
+			Store(_out.z + i, z);
+		}
+
+		if (i == _count)
+			return;
+
+		float inX[4] = {}, inY[4] = {}, inZ[4] = {};
+		for (size_t j = 0; i + j < _count; j++)
+		{
+			inX[j] = _in.x[i + j];
+			inY[j] = _in.y[i + j];
+			inZ[j] = _in.z[i + j];
+		}
+
+		Float4 x, y, z;
+		_kernel(Load(inX), Load(inY), Load(inZ), x, y, z);
+
+		float outX[4], outY[4], outZ[4];
+		Store(outX, x);
+		Store(outY, y);
+		Store(outZ, z);
+		for (size_t j = 0; i + j < _count; j++)
+		{
+			_out.x[i + j] = outX[j];
+			_out.y[i + j] = outY[j];
+			_out.z[i + j] = outZ[j];
+		}
+	}
+
+	// One row of a matrix, every element splatted over the four lanes
+	struct SplatRow
+	{
+		Float4 c0, c1, c2, c3;
+
+		inline SplatRow(const float* _row)
+			: c0(Splat(_row[0]))
+			, c1(Splat(_row[1]))
+			, c2(Splat(_row[2]))
+			, c3(Splat(_row[3]))
+		{
+		}
+
+		inline Float4 Dot3(Float4 _x, Float4 _y, Float4 _z) const
+		{
+			return MulAdd(c0, _x, MulAdd(c1, _y, Mul(c2, _z)));
+		}
+
+		inline Float4 Dot3Plus(Float4 _x, Float4 _y, Float4 _z) const
+		{
+			return MulAdd(c0, _x, MulAdd(c1, _y, MulAdd(c2, _z, c3)));
+		}
+	};
+}
+
+namespace Pandu
+{
+	namespace Batch
+	{
+		void Multiply(const Matrix44* _left, const Matrix44* _right, Matrix44* _out, size_t _count)
+		{
+			for (size_t i = 0; i < _count; i++)
+			{
+				const float (*left)[4] = _left[i].m;
+				const float (*right)[4] = _right[i].m;
+
+				const Float4 r0 = Load(right[0]);
+				const Float4 r1 = Load(right[1]);
+				const Float4 r2 = Load(right[2]);
+				const Float4 r3 = Load(right[3]);
+
+				// Every row is computed before any store, _out may be either input
+				Float4 rows[4];
+				for (int row = 0; row < 4; row++)
+				{
+					Float4 result = Mul(Splat(left[row][0]), r0);
+					result = MulAdd(Splat(left[row][1]), r1, result);
+					result = MulAdd(Splat(left[row][2]), r2, result);
+					rows[row] = MulAdd(Splat(left[row][3]), r3, result);
+				}
+
+				for (int row = 0; row < 4; row++)
+				{
+					Store(_out[i].m[row], rows[row]);
+				}
+			}
+		}
+
+		//-----------------------------------------------------------------------
+
+		void TransformPoints(const Matrix44& _mat, const ConstVector3SoA& _in, const Vector3SoA& _out, size_t _count)
+		{
+			const SplatRow row0(_mat.m[0]);
+			const SplatRow row1(_mat.m[1]);
+			const SplatRow row2(_mat.m[2]);
+
+			// w is exactly one for affine matrices, the divide would not change anything
+			if (_mat.IsAffine(0.0f))
+			{
+				ForEachGroup(_in, _out, _count, [&](Float4 _x, Float4 _y, Float4 _z, Float4& _outX, Float4& _outY, Float4& _outZ)
+				{
+					_outX = row0.Dot3Plus(_x, _y, _z);
+					_outY = row1.Dot3Plus(_x, _y, _z);
+					_outZ = row2.Dot3Plus(_x, _y, _z);
+				});
+				return;
+			}
+
+			const SplatRow row3(_mat.m[3]);
+			const Float4 epsilon = Splat(std::numeric_limits<float>::epsilon());
+			const Float4 one = Splat(1.0f);
+
+			ForEachGroup(_in, _out, _count, [&](Float4 _x, Float4 _y, Float4 _z, Float4& _outX, Float4& _outY, Float4& _outZ)
+			{
+				const Float4 w = row3.Dot3Plus(_x, _y, _z);
+				const Mask4 divide = GreaterThan(w, epsilon);
+				const Float4 invW = Div(one, w);
+
+				// Matrix44 * Vector3 returns the point untouched when w is not positive
+				_outX = Select(divide, Mul(row0.Dot3Plus(_x, _y, _z), invW), _x);
+				_outY = Select(divide, Mul(row1.Dot3Plus(_x, _y, _z), invW), _y);
+				_outZ = Select(divide, Mul(row2.Dot3Plus(_x, _y, _z), invW), _z);
+			});
+		}
+
+		//-----------------------------------------------------------------------
+
+		void TransformDirections(const Matrix44& _mat, const ConstVector3SoA& _in, const Vector3SoA& _out, size_t _count)
+		{
+			const SplatRow row0(_mat.m[0]);
+			const SplatRow row1(_mat.m[1]);
+			const SplatRow row2(_mat.m[2]);
+
+			ForEachGroup(_in, _out, _count, [&](Float4 _x, Float4 _y, Float4 _z, Float4& _outX, Float4& _outY, Float4& _outZ)
+			{
+				_outX = row0.Dot3(_x, _y, _z);
+				_outY = row1.Dot3(_x, _y, _z);
+				_outZ = row2.Dot3(_x, _y, _z);
+			});
+		}
+
+		//-----------------------------------------------------------------------
+
+		void Normalize(const ConstVector3SoA& _in, const Vector3SoA& _out, size_t _count)
+		{
+			// Vector3::Normalize compares the length against epsilon, the squared length against epsilon squared is the same test
+			const float epsilon = std::numeric_limits<float>::epsilon();
+			const Float4 minSqrdLength = Splat(epsilon * epsilon);
+			const Float4 one = Splat(1.0f);
+
+			ForEachGroup(_in, _out, _count, [&](Float4 _x, Float4 _y, Float4 _z, Float4& _outX, Float4& _outY, Float4& _outZ)
+			{
+				const Float4 sqrdLength = MulAdd(_x, _x, MulAdd(_y, _y, Mul(_z, _z)));
+				const Mask4 normalize = GreaterThan(sqrdLength, minSqrdLength);
+				const Float4 invLength = Div(one, Sqrt(sqrdLength));
+
+				_outX = Select(normalize, Mul(_x, invLength), _x);
+				_outY = Select(normalize, Mul(_y, invLength), _y);
+				_outZ = Select(normalize, Mul(_z, invLength), _z);
+			});
+		}
+	}
+}
@@ -0,0 +1,72 @@
+/********************************************************************
+	filename: 	PANDUBatch
+	author:		Parag Moni Boro
+
+	purpose:	Game Engine created for learning
+*********************************************************************/
+
+#ifndef __PANDUBatch_h__
+#define __PANDUBatch_h__
+
+#include <cstddef>
+
+namespace Pandu
+{
+	class Matrix44;
+
+	// N vectors as structure of arrays, vector i is ( x[i], y[i], z[i] )
+	struct Vector3SoA
+	{
+		float* x;
+		float* y;
+		float* z;
+
+		inline Vector3SoA(float* _x, float* _y, float* _z)
+			: x(_x)
+			, y(_y)
+			, z(_z)
+		{
+		}
+	};
+
+	struct ConstVector3SoA
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+
+		inline ConstVector3SoA(const float* _x, const float* _y, const float* _z)
+			: x(_x)
+			, y(_y)
+			, z(_z)
+		{
+		}
+
+		inline ConstVector3SoA(const Vector3SoA& _soa)
+			: x(_soa.x)
+			, y(_soa.y)
+			, z(_soa.z)
+		{
+		}
+	};
+
+	// The Matrix44 and Vector3 operations over N elements at once, four lanes per step on the SIMD backend of PANDUSimd.h.
+	// Nothing is shared between calls, so disjoint ranges of one batch can run on different threads.
+	// Outputs may be the inputs themselves, partial overlaps are not supported.
+	namespace Batch
+	{
+		// _out[i] = _left[i] * _right[i]
+		void Multiply(const Matrix44* _left, const Matrix44* _right, Matrix44* _out, size_t _count);
+
+		// Point i = _mat * point i, with the same divide by w as Matrix44 * Vector3
+		void TransformPoints(const Matrix44& _mat, const ConstVector3SoA& _in, const Vector3SoA& _out, size_t _count);
+
+		// Direction i = the 3x3 part of _mat * direction i, as Matrix44::RotateVec
+		void TransformDirections(const Matrix44& _mat, const ConstVector3SoA& _in, const Vector3SoA& _out, size_t _count);
+
+		// Vector3::Normalize on every vector, vectors too short to normalize are copied unchanged
+		void Normalize(const ConstVector3SoA& _in, const Vector3SoA& _out, size_t _count);
+	}
+}
+
+#endif
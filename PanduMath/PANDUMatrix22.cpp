@@ -1,7 +0,0 @@
-#include "PANDUMatrix22.h"
-
-namespace Pandu
-{
-	const Matrix22 Matrix22::ZERO = Matrix22(0.0f,0.0f,0.0f,0.0f);
-	const Matrix22 Matrix22::IDENTITY = Matrix22(1.0f,0.0f,0.0f,1.0f);
-}
\ No newline at end of file
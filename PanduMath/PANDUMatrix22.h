@@ -11,6 +11,7 @@
 #include "PANDUVector2.h"
 #include <assert.h>
 #include <cstring>
+#include <type_traits>
 
 namespace Pandu
 {
@@ -30,21 +31,16 @@ namespace Pandu
 
     public:
  
-		inline Matrix22(){}
+		Matrix22() = default;
 
 		inline Matrix22(float _radAngle)
 		{
 			SetRotation(_radAngle);
 		}
 
-        inline Matrix22 (const Matrix22& _right)
+        constexpr Matrix22 ( float _v00, float _v01, float _v10, float _v11)
+			: m{ { _v00, _v01 }, { _v10, _v11 } }
 		{
-			memcpy(array,_right.array,4 * sizeof(float));
-		}
-
-        inline Matrix22 ( float _v00, float _v01, float _v10, float _v11)
-		{
-			Set(_v00, _v01, _v10, _v11 );
 		}
 
 		inline void Set(float _v00, float _v01, float _v10, float _v11)
@@ -67,12 +63,6 @@ namespace Pandu
 		}
 
         
-        inline Matrix22& operator = (const Matrix22& _right)
-		{
-			memcpy(array, _right.array, 4 * sizeof(float) );
-			return *this;
-		}
-
         // arithmetic operations
         inline Matrix22 operator + (const Matrix22& _right) const
 		{
@@ -166,6 +156,12 @@ namespace Pandu
         static const Matrix22 ZERO;
         static const Matrix22 IDENTITY;
     };
+
+    inline constexpr Matrix22 Matrix22::ZERO(0.0f, 0.0f, 0.0f, 0.0f);
+    inline constexpr Matrix22 Matrix22::IDENTITY(1.0f, 0.0f, 0.0f, 1.0f);
+
+	static_assert(std::is_trivially_copyable<Matrix22>::value, "Matrix22 is copied with memcpy");
+	static_assert(sizeof(Matrix22) == sizeof(float) * 4 && alignof(Matrix22) == alignof(float), "Matrix22 is 4 packed floats");
 }
 
 #endif
\ No newline at end of file
@@ -1,7 +0,0 @@
-#include "PANDUMatrix33.h"
-
-namespace Pandu
-{
-	const Matrix33 Matrix33::ZERO(0,0,0,0,0,0,0,0,0);
-    const Matrix33 Matrix33::IDENTITY(1,0,0,0,1,0,0,0,1);
-}
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "PANDUVector3.h"
 #include <assert.h>
 #include <cstring>
+#include <type_traits>
 
 namespace Pandu
 {
@@ -24,24 +25,20 @@ namespace Pandu
 			float arr[9];
         };
 
-		inline Matrix33(){}
-        inline Matrix33 (const Matrix33& _right)
-		{
-			memcpy( m, _right.m, 9 * sizeof(float) );
-		}
+		Matrix33() = default;
 
 		inline Matrix33(const Vector3& _xAxis, const Vector3& _yAxis, const Vector3& _zAxis)
 		{
 			this->FromAxes(_xAxis,_yAxis,_zAxis);
 		}
 
-        inline Matrix33(float _fEntry00, float _fEntry01, float _fEntry02,
+        constexpr Matrix33(float _fEntry00, float _fEntry01, float _fEntry02,
                 float _fEntry10, float _fEntry11, float _fEntry12,
                 float _fEntry20, float _fEntry21, float _fEntry22)
+			: m{ { _fEntry00, _fEntry01, _fEntry02 },
+				 { _fEntry10, _fEntry11, _fEntry12 },
+				 { _fEntry20, _fEntry21, _fEntry22 } }
 		{
-			m[0][0] = _fEntry00;		m[0][1] = _fEntry01;		m[0][2] = _fEntry02;
-			m[1][0] = _fEntry10;		m[1][1] = _fEntry11;		m[1][2] = _fEntry12;
-			m[2][0] = _fEntry20;		m[2][1] = _fEntry21;		m[2][2] = _fEntry22;
 		}
 
         inline Vector3 GetColumnVec3(unsigned short _colInd) const
@@ -63,13 +60,6 @@ namespace Pandu
 			SetColumnVec3(2,_zAxis);
 		}
 
-        // assignment and comparison
-        inline Matrix33& operator = (const Matrix33& _right)
-		{
-			memcpy( m, _right.m ,9 * sizeof(float) );
-			return *this;
-		}
-       
         // arithmetic operations
         inline Matrix33 operator + (const Matrix33& _right) const
 		{
@@ -162,6 +152,12 @@ namespace Pandu
         static const Matrix33 IDENTITY;       
 
 	};
+
+	inline constexpr Matrix33 Matrix33::ZERO(0, 0, 0, 0, 0, 0, 0, 0, 0);
+	inline constexpr Matrix33 Matrix33::IDENTITY(1, 0, 0, 0, 1, 0, 0, 0, 1);
+
+	static_assert(std::is_trivially_copyable<Matrix33>::value, "Matrix33 is copied with memcpy");
+	static_assert(sizeof(Matrix33) == sizeof(float) * 9 && alignof(Matrix33) == alignof(float), "Matrix33 is 9 packed floats");
 }
 
 #endif
\ No newline at end of file
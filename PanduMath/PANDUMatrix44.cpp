@@ -1,5 +1,6 @@
 #include "PANDUMatrix44.h"
 #include "PANDUQuaternion.h"
+#include <cmath>
 
 namespace
 {
@@ -14,20 +15,6 @@ namespace
 
 namespace Pandu
 {
-    const Matrix44 Matrix44::ZERO(
-									0, 0, 0, 0,
-									0, 0, 0, 0,
-									0, 0, 0, 0,
-									0, 0, 0, 0 
-								);
-
-    const Matrix44 Matrix44::IDENTITY(
-									1, 0, 0, 0,
-									0, 1, 0, 0,
-									0, 0, 1, 0,
-									0, 0, 0, 1 
-									);
-
     //-----------------------------------------------------------------------
     Matrix44 Matrix44::Adjoint() const
     {
@@ -73,6 +60,7 @@ namespace Pandu
 
 	void Matrix44::Inverse()
 	{
+#if defined(PANDU_SIMD_SCALAR)
 		float m00 = m[0][0],		m01 = m[0][1],		m02 = m[0][2],		m03 = m[0][3];
         float m10 = m[1][0],		m11 = m[1][1],		m12 = m[1][2],		m13 = m[1][3];
         float m20 = m[2][0],		m21 = m[2][1],		m22 = m[2][2],		m23 = m[2][3];
@@ -127,6 +115,167 @@ namespace Pandu
         float d33 = + (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
 
 		Set(d00, d01, d02, d03, d10, d11, d12, d13, d20, d21, d22, d23, d30, d31, d32, d33);
+#else
+		// Block inverse over the four 2x2 quarters, each quarter held row major in one register:
+		// | A B |^-1          1         | |D|A - B(D#C)      |B|C - D(A#B)# |#
+		// | C D |     = -------------- * |                                  |
+		//               |M|             | |C|B - A(D#C)#     |A|D - C(A#B)  |
+		// with X# the adjugate of X and |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		using namespace Simd;
+
+		const Float4 row0 = Load(m[0]);
+		const Float4 row1 = Load(m[1]);
+		const Float4 row2 = Load(m[2]);
+		const Float4 row3 = Load(m[3]);
+
+		const Float4 A = Shuffle<0, 1, 0, 1>(row0, row1);
+		const Float4 B = Shuffle<2, 3, 2, 3>(row0, row1);
+		const Float4 C = Shuffle<0, 1, 0, 1>(row2, row3);
+		const Float4 D = Shuffle<2, 3, 2, 3>(row2, row3);
+
+		// ( |A|, |B|, |C|, |D| )
+		const Float4 detSub = Sub(Mul(Shuffle<0, 2, 0, 2>(row0, row2), Shuffle<1, 3, 1, 3>(row1, row3)),
+								  Mul(Shuffle<1, 3, 1, 3>(row0, row2), Shuffle<0, 2, 0, 2>(row1, row3)));
+		const Float4 detA = Broadcast<0>(detSub);
+		const Float4 detB = Broadcast<1>(detSub);
+		const Float4 detC = Broadcast<2>(detSub);
+		const Float4 detD = Broadcast<3>(detSub);
+
+		// 2x2 products: X * Y, X# * Y and X * Y#
+		auto Mat2Mul = [](Float4 _x, Float4 _y)
+		{
+			return Add(Mul(_x, Swizzle<0, 3, 0, 3>(_y)), Mul(Swizzle<1, 0, 3, 2>(_x), Swizzle<2, 1, 2, 1>(_y)));
+		};
+		auto Mat2AdjMul = [](Float4 _x, Float4 _y)
+		{
+			return Sub(Mul(Swizzle<3, 3, 0, 0>(_x), _y), Mul(Swizzle<1, 1, 2, 2>(_x), Swizzle<2, 3, 0, 1>(_y)));
+		};
+		auto Mat2MulAdj = [](Float4 _x, Float4 _y)
+		{
+			return Sub(Mul(_x, Swizzle<3, 0, 3, 0>(_y)), Mul(Swizzle<1, 0, 3, 2>(_x), Swizzle<2, 1, 2, 1>(_y)));
+		};
+
+		const Float4 D_C = Mat2AdjMul(D, C);
+		const Float4 A_B = Mat2AdjMul(A, B);
+
+		Float4 X_ = Sub(Mul(detD, A), Mat2Mul(B, D_C));
+		Float4 W_ = Sub(Mul(detA, D), Mat2Mul(C, A_B));
+		Float4 Y_ = Sub(Mul(detB, C), Mat2MulAdj(D, A_B));
+		Float4 Z_ = Sub(Mul(detC, B), Mat2MulAdj(A, D_C));
+
+		const Float4 trace = HorizontalSum(Mul(A_B, Swizzle<0, 2, 1, 3>(D_C)));
+		const Float4 detM = Sub(Add(Mul(detA, detD), Mul(detB, detC)), trace);
+
+		// The signs of the adjugate come with the reciprocal
+		const Float4 rDetM = Div(Simd::Set(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		X_ = Mul(X_, rDetM);
+		Y_ = Mul(Y_, rDetM);
+		Z_ = Mul(Z_, rDetM);
+		W_ = Mul(W_, rDetM);
+
+		// Adjugate shuffle and the way back to rows in one step
+		Store(m[0], Shuffle<3, 1, 3, 1>(X_, Y_));
+		Store(m[1], Shuffle<2, 0, 2, 0>(X_, Y_));
+		Store(m[2], Shuffle<3, 1, 3, 1>(Z_, W_));
+		Store(m[3], Shuffle<2, 0, 2, 0>(Z_, W_));
+#endif
+	}
+
+    //-----------------------------------------------------------------------
+
+	bool Matrix44::IsAffine(float _tolerance) const
+	{
+		return std::fabs(m[3][0]) <= _tolerance && std::fabs(m[3][1]) <= _tolerance && std::fabs(m[3][2]) <= _tolerance && std::fabs(m[3][3] - 1.0f) <= _tolerance;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool Matrix44::IsRigid(float _tolerance) const
+	{
+		if(!IsAffine(_tolerance))
+		{
+			return false;
+		}
+
+		for(int i = 0; i < 3; i++)
+		{
+			for(int j = i; j < 3; j++)
+			{
+				const float dot = m[i][0] * m[j][0] + m[i][1] * m[j][1] + m[i][2] * m[j][2];
+				if(std::fabs(dot - (i == j ? 1.0f : 0.0f)) > _tolerance)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	Matrix44 Matrix44::GetAffineInverse() const
+	{
+		Matrix44 mat(*this);
+		mat.AffineInverse();
+		return mat;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void Matrix44::AffineInverse()
+	{
+		assert( IsAffine() );
+
+		const float m00 = m[0][0],		m01 = m[0][1],		m02 = m[0][2];
+		const float m10 = m[1][0],		m11 = m[1][1],		m12 = m[1][2];
+		const float m20 = m[2][0],		m21 = m[2][1],		m22 = m[2][2];
+
+		const float c00 = m11 * m22 - m12 * m21;
+		const float c10 = m12 * m20 - m10 * m22;
+		const float c20 = m10 * m21 - m11 * m20;
+
+		const float invDet = 1.0f / (m00 * c00 + m01 * c10 + m02 * c20);
+
+		const float i00 = c00 * invDet;
+		const float i01 = (m02 * m21 - m01 * m22) * invDet;
+		const float i02 = (m01 * m12 - m02 * m11) * invDet;
+		const float i10 = c10 * invDet;
+		const float i11 = (m00 * m22 - m02 * m20) * invDet;
+		const float i12 = (m02 * m10 - m00 * m12) * invDet;
+		const float i20 = c20 * invDet;
+		const float i21 = (m01 * m20 - m00 * m21) * invDet;
+		const float i22 = (m00 * m11 - m01 * m10) * invDet;
+
+		const float tx = m[0][3],		ty = m[1][3],		tz = m[2][3];
+
+		Set(i00, i01, i02, -(i00 * tx + i01 * ty + i02 * tz),
+			i10, i11, i12, -(i10 * tx + i11 * ty + i12 * tz),
+			i20, i21, i22, -(i20 * tx + i21 * ty + i22 * tz),
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	//-----------------------------------------------------------------------
+
+	Matrix44 Matrix44::GetRigidInverse() const
+	{
+		Matrix44 mat(*this);
+		mat.RigidInverse();
+		return mat;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void Matrix44::RigidInverse()
+	{
+		assert( IsRigid() );
+
+		const float tx = m[0][3],		ty = m[1][3],		tz = m[2][3];
+
+		Set(m[0][0], m[1][0], m[2][0], -(m[0][0] * tx + m[1][0] * ty + m[2][0] * tz),
+			m[0][1], m[1][1], m[2][1], -(m[0][1] * tx + m[1][1] * ty + m[2][1] * tz),
+			m[0][2], m[1][2], m[2][2], -(m[0][2] * tx + m[1][2] * ty + m[2][2] * tz),
+			0.0f, 0.0f, 0.0f, 1.0f);
 	}
 
     //-----------------------------------------------------------------------
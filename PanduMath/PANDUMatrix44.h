@@ -9,12 +9,14 @@
 #define __PANDUMatrix44_h__
 
 #include "PANDUVector3.h"
+#include "PANDUSimd.h"
 #include <assert.h>
+#include <type_traits>
 
 namespace Pandu
 {
 	class Quaternion;
-    class Matrix44
+    class alignas(16) Matrix44
     {
 	public:
 
@@ -24,24 +26,17 @@ namespace Pandu
             float arr[16];
         };
       
-        inline Matrix44()
-        {
-        }
-
-		inline Matrix44(const Matrix44& _mat)
-		{
-			Set(_mat[0][0], _mat[0][1], _mat[0][2], _mat[0][3],
-				_mat[1][0], _mat[1][1], _mat[1][2], _mat[1][3],
-				_mat[2][0], _mat[2][1], _mat[2][2], _mat[2][3],
-				_mat[3][0], _mat[3][1], _mat[3][2], _mat[3][3]);
-		}
+        Matrix44() = default;
 
-        inline Matrix44(float _m00, float _m01, float _m02, float _m03,
+        constexpr Matrix44(float _m00, float _m01, float _m02, float _m03,
 						float _m10, float _m11, float _m12, float _m13,
 						float _m20, float _m21, float _m22, float _m23,
 						float _m30, float _m31, float _m32, float _m33 )
+			: m{ { _m00, _m01, _m02, _m03 },
+				 { _m10, _m11, _m12, _m13 },
+				 { _m20, _m21, _m22, _m23 },
+				 { _m30, _m31, _m32, _m33 } }
         {
-            Set(_m00, _m01, _m02, _m03,_m10, _m11, _m12, _m13,_m20, _m21, _m22, _m23,_m30, _m31, _m32, _m33);
         } 
 
 		inline void Set(float _m00, float _m01, float _m02, float _m03,
@@ -55,15 +50,6 @@ namespace Pandu
             m[3][0] = _m30;			m[3][1] = _m31;			m[3][2] = _m32;			m[3][3] = _m33;
 		}
 
-		inline Matrix44& operator = ( const Matrix44& _mat ) 
-		{
-			Set(_mat[0][0], _mat[0][1], _mat[0][2], _mat[0][3],
-				_mat[1][0], _mat[1][1], _mat[1][2], _mat[1][3],
-				_mat[2][0], _mat[2][1], _mat[2][2], _mat[2][3],
-				_mat[3][0], _mat[3][1], _mat[3][2], _mat[3][3]);
-			return *this;
-		}
-
 		inline float* operator [] ( unsigned short _row )
         {
             assert( _row < 4 );
@@ -81,28 +67,22 @@ namespace Pandu
         {
             Matrix44 result;
 
-            result.m[0][0] = m[0][0] * _right.m[0][0] + m[0][1] * _right.m[1][0] + m[0][2] * _right.m[2][0] + m[0][3] * _right.m[3][0];
-            result.m[0][1] = m[0][0] * _right.m[0][1] + m[0][1] * _right.m[1][1] + m[0][2] * _right.m[2][1] + m[0][3] * _right.m[3][1];
-            result.m[0][2] = m[0][0] * _right.m[0][2] + m[0][1] * _right.m[1][2] + m[0][2] * _right.m[2][2] + m[0][3] * _right.m[3][2];
-            result.m[0][3] = m[0][0] * _right.m[0][3] + m[0][1] * _right.m[1][3] + m[0][2] * _right.m[2][3] + m[0][3] * _right.m[3][3];
-
-            result.m[1][0] = m[1][0] * _right.m[0][0] + m[1][1] * _right.m[1][0] + m[1][2] * _right.m[2][0] + m[1][3] * _right.m[3][0];
-            result.m[1][1] = m[1][0] * _right.m[0][1] + m[1][1] * _right.m[1][1] + m[1][2] * _right.m[2][1] + m[1][3] * _right.m[3][1];
-            result.m[1][2] = m[1][0] * _right.m[0][2] + m[1][1] * _right.m[1][2] + m[1][2] * _right.m[2][2] + m[1][3] * _right.m[3][2];
-            result.m[1][3] = m[1][0] * _right.m[0][3] + m[1][1] * _right.m[1][3] + m[1][2] * _right.m[2][3] + m[1][3] * _right.m[3][3];
-
-            result.m[2][0] = m[2][0] * _right.m[0][0] + m[2][1] * _right.m[1][0] + m[2][2] * _right.m[2][0] + m[2][3] * _right.m[3][0];
-            result.m[2][1] = m[2][0] * _right.m[0][1] + m[2][1] * _right.m[1][1] + m[2][2] * _right.m[2][1] + m[2][3] * _right.m[3][1];
-            result.m[2][2] = m[2][0] * _right.m[0][2] + m[2][1] * _right.m[1][2] + m[2][2] * _right.m[2][2] + m[2][3] * _right.m[3][2];
-            result.m[2][3] = m[2][0] * _right.m[0][3] + m[2][1] * _right.m[1][3] + m[2][2] * _right.m[2][3] + m[2][3] * _right.m[3][3];
-
-            result.m[3][0] = m[3][0] * _right.m[0][0] + m[3][1] * _right.m[1][0] + m[3][2] * _right.m[2][0] + m[3][3] * _right.m[3][0];
-            result.m[3][1] = m[3][0] * _right.m[0][1] + m[3][1] * _right.m[1][1] + m[3][2] * _right.m[2][1] + m[3][3] * _right.m[3][1];
-            result.m[3][2] = m[3][0] * _right.m[0][2] + m[3][1] * _right.m[1][2] + m[3][2] * _right.m[2][2] + m[3][3] * _right.m[3][2];
-            result.m[3][3] = m[3][0] * _right.m[0][3] + m[3][1] * _right.m[1][3] + m[3][2] * _right.m[2][3] + m[3][3] * _right.m[3][3];
+            // Every result row is a combination of the rows of _right, weighted by the row of this matrix
+            const Simd::Float4 r0 = Simd::Load(_right.m[0]);
+            const Simd::Float4 r1 = Simd::Load(_right.m[1]);
+            const Simd::Float4 r2 = Simd::Load(_right.m[2]);
+            const Simd::Float4 r3 = Simd::Load(_right.m[3]);
+
+            for (int i = 0; i < 4; i++)
+            {
+                Simd::Float4 row = Simd::Mul(Simd::Splat(m[i][0]), r0);
+                row = Simd::MulAdd(Simd::Splat(m[i][1]), r1, row);
+                row = Simd::MulAdd(Simd::Splat(m[i][2]), r2, row);
+                row = Simd::MulAdd(Simd::Splat(m[i][3]), r3, row);
+                Simd::Store(result.m[i], row);
+            }
 
             return result;
-  
         }
 
         inline Vector3 operator * ( const Vector3& _right ) const
@@ -191,18 +171,22 @@ namespace Pandu
 
         inline Matrix44 GetTranspose() const
         {
-            return Matrix44(m[0][0], m[1][0], m[2][0], m[3][0],
-                           m[0][1], m[1][1], m[2][1], m[3][1],
-                           m[0][2], m[1][2], m[2][2], m[3][2],
-                           m[0][3], m[1][3], m[2][3], m[3][3]);
+            Matrix44 result(*this);
+            result.Transpose();
+            return result;
         }
 
 		inline void Transpose()
         {
-            Set(	m[0][0], m[1][0], m[2][0], m[3][0],
-					m[0][1], m[1][1], m[2][1], m[3][1],
-                    m[0][2], m[1][2], m[2][2], m[3][2],
-                    m[0][3], m[1][3], m[2][3], m[3][3]);
+			Simd::Float4 r0 = Simd::Load(m[0]);
+			Simd::Float4 r1 = Simd::Load(m[1]);
+			Simd::Float4 r2 = Simd::Load(m[2]);
+			Simd::Float4 r3 = Simd::Load(m[3]);
+			Simd::Transpose(r0, r1, r2, r3);
+			Simd::Store(m[0], r0);
+			Simd::Store(m[1], r1);
+			Simd::Store(m[2], r2);
+			Simd::Store(m[3], r3);
         }
 
         inline void SetTranslate( const Vector3& _trans )
@@ -259,6 +243,19 @@ namespace Pandu
 		float Determinant() const;
 		Matrix44 GetInverse() const;
 		void Inverse();
+
+		// Last row is ( 0, 0, 0, 1 ), a 3x3 part and a translation
+		bool IsAffine(float _tolerance = 1e-6f) const;
+		// Affine with orthonormal rows in the 3x3 part, rotation and translation only
+		bool IsRigid(float _tolerance = 1e-4f) const;
+
+		// Inverse of the 3x3 part and the translation moved back through it, asserts IsAffine() in debug builds
+		Matrix44 GetAffineInverse() const;
+		void AffineInverse();
+
+		// Transposed 3x3 part and the translation moved back through it, asserts IsRigid() in debug builds
+		Matrix44 GetRigidInverse() const;
+		void RigidInverse();
 			
 		void MakeTransform(const Vector3& _position, const Quaternion& _orientation);
         void MakeInverseTransform(const Vector3& _position, const Quaternion& _orientation);
@@ -266,5 +263,24 @@ namespace Pandu
 		static const Matrix44 ZERO;
 		static const Matrix44 IDENTITY;
 	};
+
+	inline constexpr Matrix44 Matrix44::ZERO(
+									0, 0, 0, 0,
+									0, 0, 0, 0,
+									0, 0, 0, 0,
+									0, 0, 0, 0
+								);
+
+	inline constexpr Matrix44 Matrix44::IDENTITY(
+									1, 0, 0, 0,
+									0, 1, 0, 0,
+									0, 0, 1, 0,
+									0, 0, 0, 1
+								);
+
+	// Rows load straight into SIMD registers and the whole matrix goes into GPU buffers as is, see Utils::GetWebGPUMatrix
+	static_assert(std::is_trivially_copyable<Matrix44>::value, "Matrix44 is copied with memcpy");
+	static_assert(sizeof(Matrix44) == sizeof(float) * 16 && alignof(Matrix44) == 16, "Matrix44 is 16 packed floats on a 16 byte boundary");
 }
+
 #endif
@@ -4,9 +4,6 @@
 
 namespace Pandu
 {
-    const Quaternion Quaternion::ZERO(0.0,0.0,0.0,0.0);
-    const Quaternion Quaternion::IDENTITY(1.0,0.0,0.0,0.0);
-
 	//-----------------------------------------------------------------------
     Vector3 Quaternion::operator * (const Vector3& _right) const
     {
@@ -12,12 +12,13 @@
 #include "PANDUMatrix33.h"
 #include <assert.h>
 #include <cmath>
+#include <type_traits>
 
 namespace Pandu 
 {
 	class Matrix44;
 
-    class Quaternion
+    class alignas(16) Quaternion
     {
 	public:
 
@@ -25,11 +26,9 @@ namespace Pandu
 
     public:
 
-		inline Quaternion()
-		{
-		}
+		Quaternion() = default;
 
-        inline Quaternion (float _W , float _X , float _Y , float _Z )
+        constexpr Quaternion (float _W , float _X , float _Y , float _Z )
 			: w(_W)
 			, x(_X)
 			, y(_Y)
@@ -47,15 +46,6 @@ namespace Pandu
 			this->FromRotationMatrix(_rotMat);
 		}
 
-		inline Quaternion& operator = (const Quaternion& _right)
-		{
-			w = _right.w;
-			x = _right.x;
-			y = _right.y;
-			z = _right.z;
-			return *this;
-		}
-
 		inline void Set(float _W , float _X , float _Y , float _Z)
 		{
 			w = _W;
@@ -166,6 +156,12 @@ namespace Pandu
         static const Quaternion ZERO;
         static const Quaternion IDENTITY;
     };
+
+    inline constexpr Quaternion Quaternion::ZERO(0.0f, 0.0f, 0.0f, 0.0f);
+    inline constexpr Quaternion Quaternion::IDENTITY(1.0f, 0.0f, 0.0f, 0.0f);
+
+	static_assert(std::is_trivially_copyable<Quaternion>::value, "Quaternion is copied with memcpy");
+	static_assert(sizeof(Quaternion) == sizeof(float) * 4 && alignof(Quaternion) == 16, "Quaternion is 4 packed floats on a 16 byte boundary");
 }
 
 #endif
\ No newline at end of file
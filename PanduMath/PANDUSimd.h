@@ -0,0 +1,202 @@
+/********************************************************************
+	filename: 	PANDUSimd
+	author:		Parag Moni Boro
+
+	purpose:	Game Engine created for learning
+*********************************************************************/
+
+#ifndef __PANDUSimd_h__
+#define __PANDUSimd_h__
+
+// Four float lanes on whatever vector unit the target has, picked at compile time:
+// SSE on x86 (FMA when the target has it), NEON on ARM, simd128 on wasm built with -msimd128, plain floats otherwise.
+// Define PANDU_SIMD_DISABLE to force the plain float version.
+#if defined(PANDU_SIMD_DISABLE)
+#define PANDU_SIMD_SCALAR 1
+#include <cmath>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PANDU_SIMD_SSE 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define PANDU_SIMD_NEON 1
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#define PANDU_SIMD_WASM 1
+#include <wasm_simd128.h>
+#else
+#define PANDU_SIMD_SCALAR 1
+#include <cmath>
+#endif
+
+namespace Pandu
+{
+	namespace Simd
+	{
+#if defined(PANDU_SIMD_SSE)
+		typedef __m128 Float4;
+		typedef __m128 Mask4;
+
+		inline Float4 Load(const float* _src) { return _mm_loadu_ps(_src); }
+		inline void Store(float* _dst, Float4 _v) { _mm_storeu_ps(_dst, _v); }
+		inline Float4 Set(float _x, float _y, float _z, float _w) { return _mm_setr_ps(_x, _y, _z, _w); }
+		inline Float4 Splat(float _v) { return _mm_set1_ps(_v); }
+		inline Float4 Add(Float4 _a, Float4 _b) { return _mm_add_ps(_a, _b); }
+		inline Float4 Sub(Float4 _a, Float4 _b) { return _mm_sub_ps(_a, _b); }
+		inline Float4 Mul(Float4 _a, Float4 _b) { return _mm_mul_ps(_a, _b); }
+		inline Float4 Div(Float4 _a, Float4 _b) { return _mm_div_ps(_a, _b); }
+		inline Float4 Sqrt(Float4 _v) { return _mm_sqrt_ps(_v); }
+		inline float GetX(Float4 _v) { return _mm_cvtss_f32(_v); }
+
+		// Lanes where _mask is set come from _a, the others from _b
+		inline Mask4 GreaterThan(Float4 _a, Float4 _b) { return _mm_cmpgt_ps(_a, _b); }
+		inline Float4 Select(Mask4 _mask, Float4 _a, Float4 _b) { return _mm_or_ps(_mm_and_ps(_mask, _a), _mm_andnot_ps(_mask, _b)); }
+
+		// _a * _b + _c
+#if defined(__FMA__)
+		inline Float4 MulAdd(Float4 _a, Float4 _b, Float4 _c) { return _mm_fmadd_ps(_a, _b, _c); }
+#else
+		inline Float4 MulAdd(Float4 _a, Float4 _b, Float4 _c) { return _mm_add_ps(_mm_mul_ps(_a, _b), _c); }
+#endif
+
+		// ( _a[A0], _a[A1], _b[B0], _b[B1] )
+		template <int A0, int A1, int B0, int B1>
+		inline Float4 Shuffle(Float4 _a, Float4 _b) { return _mm_shuffle_ps(_a, _b, _MM_SHUFFLE(B1, B0, A1, A0)); }
+
+#elif defined(PANDU_SIMD_NEON)
+		typedef float32x4_t Float4;
+		typedef uint32x4_t Mask4;
+
+		inline Float4 Load(const float* _src) { return vld1q_f32(_src); }
+		inline void Store(float* _dst, Float4 _v) { vst1q_f32(_dst, _v); }
+		inline Float4 Set(float _x, float _y, float _z, float _w) { const float v[4] = { _x, _y, _z, _w }; return vld1q_f32(v); }
+		inline Float4 Splat(float _v) { return vdupq_n_f32(_v); }
+		inline Float4 Add(Float4 _a, Float4 _b) { return vaddq_f32(_a, _b); }
+		inline Float4 Sub(Float4 _a, Float4 _b) { return vsubq_f32(_a, _b); }
+		inline Float4 Mul(Float4 _a, Float4 _b) { return vmulq_f32(_a, _b); }
+		inline float GetX(Float4 _v) { return vgetq_lane_f32(_v, 0); }
+
+		inline Mask4 GreaterThan(Float4 _a, Float4 _b) { return vcgtq_f32(_a, _b); }
+		inline Float4 Select(Mask4 _mask, Float4 _a, Float4 _b) { return vbslq_f32(_mask, _a, _b); }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+		inline Float4 Div(Float4 _a, Float4 _b) { return vdivq_f32(_a, _b); }
+		inline Float4 Sqrt(Float4 _v) { return vsqrtq_f32(_v); }
+		inline Float4 MulAdd(Float4 _a, Float4 _b, Float4 _c) { return vfmaq_f32(_c, _a, _b); }
+#else
+		inline Float4 Div(Float4 _a, Float4 _b)
+		{
+			// Two Newton-Raphson steps on the reciprocal estimate, ARMv7 has no vector divide
+			Float4 r = vrecpeq_f32(_b);
+			r = vmulq_f32(vrecpsq_f32(_b, r), r);
+			r = vmulq_f32(vrecpsq_f32(_b, r), r);
+			return vmulq_f32(_a, r);
+		}
+		inline Float4 Sqrt(Float4 _v)
+		{
+			// _v times its refined reciprocal square root, zero lanes stay zero
+			Float4 r = vrsqrteq_f32(_v);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, r), r), r);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, r), r), r);
+			return vbslq_f32(vceqq_f32(_v, vdupq_n_f32(0.0f)), _v, vmulq_f32(_v, r));
+		}
+		inline Float4 MulAdd(Float4 _a, Float4 _b, Float4 _c) { return vmlaq_f32(_c, _a, _b); }
+#endif
+
+		// ( _a[A0], _a[A1], _b[B0], _b[B1] ), lane moves compile to single ins instructions
+		template <int A0, int A1, int B0, int B1>
+		inline Float4 Shuffle(Float4 _a, Float4 _b)
+		{
+			Float4 r = vmovq_n_f32(vgetq_lane_f32(_a, A0));
+			r = vsetq_lane_f32(vgetq_lane_f32(_a, A1), r, 1);
+			r = vsetq_lane_f32(vgetq_lane_f32(_b, B0), r, 2);
+			return vsetq_lane_f32(vgetq_lane_f32(_b, B1), r, 3);
+		}
+
+#elif defined(PANDU_SIMD_WASM)
+		typedef v128_t Float4;
+		typedef v128_t Mask4;
+
+		inline Float4 Load(const float* _src) { return wasm_v128_load(_src); }
+		inline void Store(float* _dst, Float4 _v) { wasm_v128_store(_dst, _v); }
+		inline Float4 Set(float _x, float _y, float _z, float _w) { return wasm_f32x4_make(_x, _y, _z, _w); }
+		inline Float4 Splat(float _v) { return wasm_f32x4_splat(_v); }
+		inline Float4 Add(Float4 _a, Float4 _b) { return wasm_f32x4_add(_a, _b); }
+		inline Float4 Sub(Float4 _a, Float4 _b) { return wasm_f32x4_sub(_a, _b); }
+		inline Float4 Mul(Float4 _a, Float4 _b) { return wasm_f32x4_mul(_a, _b); }
+		inline Float4 Div(Float4 _a, Float4 _b) { return wasm_f32x4_div(_a, _b); }
+		inline Float4 MulAdd(Float4 _a, Float4 _b, Float4 _c) { return wasm_f32x4_add(wasm_f32x4_mul(_a, _b), _c); }
+		inline Float4 Sqrt(Float4 _v) { return wasm_f32x4_sqrt(_v); }
+		inline float GetX(Float4 _v) { return wasm_f32x4_extract_lane(_v, 0); }
+
+		inline Mask4 GreaterThan(Float4 _a, Float4 _b) { return wasm_f32x4_gt(_a, _b); }
+		inline Float4 Select(Mask4 _mask, Float4 _a, Float4 _b) { return wasm_v128_bitselect(_a, _b, _mask); }
+
+		// ( _a[A0], _a[A1], _b[B0], _b[B1] )
+		template <int A0, int A1, int B0, int B1>
+		inline Float4 Shuffle(Float4 _a, Float4 _b) { return wasm_i32x4_shuffle(_a, _b, A0, A1, B0 + 4, B1 + 4); }
+
+#else
+		struct Float4
+		{
+			float v[4];
+		};
+
+		struct Mask4
+		{
+			bool v[4];
+		};
+
+		inline Float4 Load(const float* _src) { return { { _src[0], _src[1], _src[2], _src[3] } }; }
+		inline void Store(float* _dst, Float4 _v) { _dst[0] = _v.v[0]; _dst[1] = _v.v[1]; _dst[2] = _v.v[2]; _dst[3] = _v.v[3]; }
+		inline Float4 Set(float _x, float _y, float _z, float _w) { return { { _x, _y, _z, _w } }; }
+		inline Float4 Splat(float _v) { return { { _v, _v, _v, _v } }; }
+		inline Float4 Add(Float4 _a, Float4 _b) { return { { _a.v[0] + _b.v[0], _a.v[1] + _b.v[1], _a.v[2] + _b.v[2], _a.v[3] + _b.v[3] } }; }
+		inline Float4 Sub(Float4 _a, Float4 _b) { return { { _a.v[0] - _b.v[0], _a.v[1] - _b.v[1], _a.v[2] - _b.v[2], _a.v[3] - _b.v[3] } }; }
+		inline Float4 Mul(Float4 _a, Float4 _b) { return { { _a.v[0] * _b.v[0], _a.v[1] * _b.v[1], _a.v[2] * _b.v[2], _a.v[3] * _b.v[3] } }; }
+		inline Float4 Div(Float4 _a, Float4 _b) { return { { _a.v[0] / _b.v[0], _a.v[1] / _b.v[1], _a.v[2] / _b.v[2], _a.v[3] / _b.v[3] } }; }
+		inline Float4 MulAdd(Float4 _a, Float4 _b, Float4 _c) { return Add(Mul(_a, _b), _c); }
+		inline Float4 Sqrt(Float4 _v) { return { { std::sqrt(_v.v[0]), std::sqrt(_v.v[1]), std::sqrt(_v.v[2]), std::sqrt(_v.v[3]) } }; }
+		inline float GetX(Float4 _v) { return _v.v[0]; }
+
+		inline Mask4 GreaterThan(Float4 _a, Float4 _b) { return { { _a.v[0] > _b.v[0], _a.v[1] > _b.v[1], _a.v[2] > _b.v[2], _a.v[3] > _b.v[3] } }; }
+		inline Float4 Select(Mask4 _mask, Float4 _a, Float4 _b)
+		{
+			return { { _mask.v[0] ? _a.v[0] : _b.v[0], _mask.v[1] ? _a.v[1] : _b.v[1], _mask.v[2] ? _a.v[2] : _b.v[2], _mask.v[3] ? _a.v[3] : _b.v[3] } };
+		}
+
+		template <int A0, int A1, int B0, int B1>
+		inline Float4 Shuffle(Float4 _a, Float4 _b) { return { { _a.v[A0], _a.v[A1], _b.v[B0], _b.v[B1] } }; }
+#endif
+
+		// ( _v[I0], _v[I1], _v[I2], _v[I3] )
+		template <int I0, int I1, int I2, int I3>
+		inline Float4 Swizzle(Float4 _v) { return Shuffle<I0, I1, I2, I3>(_v, _v); }
+
+		// Every lane holds _v[I]
+		template <int I>
+		inline Float4 Broadcast(Float4 _v) { return Shuffle<I, I, I, I>(_v, _v); }
+
+		// Every lane holds the sum of the four lanes of _v
+		inline Float4 HorizontalSum(Float4 _v)
+		{
+			_v = Add(_v, Swizzle<2, 3, 0, 1>(_v));
+			return Add(_v, Swizzle<1, 0, 3, 2>(_v));
+		}
+
+		// In place 4x4 transpose of four rows
+		inline void Transpose(Float4& _r0, Float4& _r1, Float4& _r2, Float4& _r3)
+		{
+			const Float4 t0 = Shuffle<0, 1, 0, 1>(_r0, _r1);
+			const Float4 t1 = Shuffle<2, 3, 2, 3>(_r0, _r1);
+			const Float4 t2 = Shuffle<0, 1, 0, 1>(_r2, _r3);
+			const Float4 t3 = Shuffle<2, 3, 2, 3>(_r2, _r3);
+
+			_r0 = Shuffle<0, 2, 0, 2>(t0, t2);
+			_r1 = Shuffle<1, 3, 1, 3>(t0, t2);
+			_r2 = Shuffle<0, 2, 0, 2>(t1, t3);
+			_r3 = Shuffle<1, 3, 1, 3>(t1, t3);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,59 @@
+/********************************************************************
+	filename: 	PANDUSphere
+	author:		Parag Moni Boro
+
+	purpose:	Game Engine created for learning
+*********************************************************************/
+
+#ifndef __PANDUSphere_h__
+#define __PANDUSphere_h__
+
+#include "PANDUVector3.h"
+
+namespace Pandu
+{
+	class Sphere
+	{
+	private:
+
+		Vector3 m_Center;
+		float m_Radius;
+
+	public:
+
+		inline Sphere(){}
+
+		inline Sphere(const Vector3& _center, float _radius)
+			: m_Center(_center)
+			, m_Radius(_radius)
+		{
+		}
+
+		inline ~Sphere(){}
+
+		inline const Vector3& GetCenter() const		{	return m_Center;			}
+		inline float GetRadius() const				{	return m_Radius;			}
+
+		inline bool Contains(const Vector3& _point) const
+		{
+			return (_point - m_Center).SqrdLength() <= m_Radius * m_Radius;
+		}
+
+		// Grows to the smallest sphere holding both the current one and _point
+		inline void Merge(const Vector3& _point)
+		{
+			const Vector3 toPoint = _point - m_Center;
+			const float sqrdDistance = toPoint.SqrdLength();
+			if (sqrdDistance <= m_Radius * m_Radius)
+				return;
+
+			const float distance = std::sqrt(sqrdDistance);
+			const float newRadius = (m_Radius + distance) * 0.5f;
+			m_Center += toPoint * ((newRadius - m_Radius) / distance);
+			m_Radius = newRadius;
+		}
+
+	};
+}
+
+#endif
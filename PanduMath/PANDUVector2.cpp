@@ -1,11 +0,0 @@
-#include "PANDUVector2.h"
-
-namespace Pandu
-{
-	const Vector2 Vector2::UNIT_X = Vector2(1.0f , 0.0f);
-	const Vector2 Vector2::UNIT_Y = Vector2(0.0f , 1.0f);
-	const Vector2 NEGATIVE_UNIT_X = Vector2(-1.0f , 0.0f);
-	const Vector2 NEGATIVE_UNIT_Y = Vector2(0.0f , -1.0f);
-	const Vector2 Vector2::ZERO = Vector2(0.0f , 0.0f);
-	const Vector2 Vector2::UNIT = Vector2(1.0f , 1.0f);
-};
\ No newline at end of file
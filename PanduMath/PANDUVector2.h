@@ -10,6 +10,7 @@
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
 
 namespace Pandu
 {
@@ -21,32 +22,17 @@ namespace Pandu
 
 	public:
 
-		inline Vector2()
-		{
-		}
+		Vector2() = default;
 		
-		inline Vector2(float _x, float _y)
+		constexpr Vector2(float _x, float _y)
 			: x(_x)
 			, y(_y)
 		{
 		}
 		
-		inline Vector2(const Vector2& _src)
-			: x(_src.x)
-			, y(_src.y)
-		{
-		}
-
 		float* Data() { return &x; }
 		const float* Data() const { return &x; }
 
-		inline Vector2& operator = ( const Vector2& _right )
-		{
-			x = _right.x;
-			y = _right.y;
-			return *this;
-		}
-		
 		inline const Vector2& operator + () const
 		{
 			return *this;
@@ -189,6 +175,16 @@ namespace Pandu
 		static const Vector2 ZERO;
 		static const Vector2 UNIT;
 	};
+
+	inline constexpr Vector2 Vector2::UNIT_X(1.0f, 0.0f);
+	inline constexpr Vector2 Vector2::UNIT_Y(0.0f, 1.0f);
+	inline constexpr Vector2 Vector2::NEGATIVE_UNIT_X(-1.0f, 0.0f);
+	inline constexpr Vector2 Vector2::NEGATIVE_UNIT_Y(0.0f, -1.0f);
+	inline constexpr Vector2 Vector2::ZERO(0.0f, 0.0f);
+	inline constexpr Vector2 Vector2::UNIT(1.0f, 1.0f);
+
+	static_assert(std::is_trivially_copyable<Vector2>::value, "Vector2 is copied with memcpy");
+	static_assert(sizeof(Vector2) == sizeof(float) * 2 && alignof(Vector2) == alignof(float), "Vector2 is 2 packed floats");
 }
 
 #endif
\ No newline at end of file
@@ -1,13 +0,0 @@
-#include "PANDUVector3.h"
-
-namespace Pandu
-{
-	const Vector3 Vector3::UNIT_X = Vector3(1.0f , 0.0f, 0.0f);
-	const Vector3 Vector3::UNIT_Y = Vector3(0.0f , 1.0f, 0.0f);
-	const Vector3 Vector3::UNIT_Z = Vector3(0.0f , 0.0f, 1.0f);
-	const Vector3 NEGATIVE_UNIT_X = Vector3(-1.0f , 0.0f, 0.0f);
-	const Vector3 NEGATIVE_UNIT_Y = Vector3(0.0f , -1.0f, 0.0f);
-	const Vector3 NEGATIVE_UNIT_Z = Vector3(0.0f , 0.0f, -1.0f);
-	const Vector3 Vector3::ZERO = Vector3(0.0f , 0.0f, 0.0f);
-	const Vector3 Vector3::UNIT = Vector3(1.0f , 1.0f, 1.0f);
-};
\ No newline at end of file
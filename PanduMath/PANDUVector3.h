@@ -10,6 +10,7 @@
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
 #include "PANDUMathConstants.h"
 
 namespace Pandu
@@ -22,35 +23,18 @@ namespace Pandu
 
 	public:
 
-		inline Vector3()
-		{
-		}
+		Vector3() = default;
 		
-		inline Vector3(float _x, float _y, float _z)
+		constexpr Vector3(float _x, float _y, float _z)
 			: x(_x)
 			, y(_y)
 			, z(_z)
 		{
 		}
 		
-		inline Vector3(const Vector3& _src)
-			: x(_src.x)
-			, y(_src.y)
-			, z(_src.z)
-		{
-		}
-
 		float* Data() { return &x; }
 		const float* Data() const { return &x; }
 
-		inline Vector3& operator = ( const Vector3& _right )
-		{
-			x = _right.x;
-			y = _right.y;
-			z = _right.z;
-			return *this;
-		}
-		
 		inline const Vector3& operator + () const
 		{
 			return *this;
@@ -216,6 +200,19 @@ namespace Pandu
 		static const Vector3 ZERO;
 		static const Vector3 UNIT;
 	};
+
+	inline constexpr Vector3 Vector3::UNIT_X(1.0f, 0.0f, 0.0f);
+	inline constexpr Vector3 Vector3::UNIT_Y(0.0f, 1.0f, 0.0f);
+	inline constexpr Vector3 Vector3::UNIT_Z(0.0f, 0.0f, 1.0f);
+	inline constexpr Vector3 Vector3::NEGATIVE_UNIT_X(-1.0f, 0.0f, 0.0f);
+	inline constexpr Vector3 Vector3::NEGATIVE_UNIT_Y(0.0f, -1.0f, 0.0f);
+	inline constexpr Vector3 Vector3::NEGATIVE_UNIT_Z(0.0f, 0.0f, -1.0f);
+	inline constexpr Vector3 Vector3::ZERO(0.0f, 0.0f, 0.0f);
+	inline constexpr Vector3 Vector3::UNIT(1.0f, 1.0f, 1.0f);
+
+	// Packed, positions and bounds are read and written as float triples
+	static_assert(std::is_trivially_copyable<Vector3>::value, "Vector3 is copied with memcpy");
+	static_assert(sizeof(Vector3) == sizeof(float) * 3 && alignof(Vector3) == alignof(float), "Vector3 is 3 packed floats");
 }
 
 #endif
\ No newline at end of file
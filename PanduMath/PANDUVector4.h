@@ -10,12 +10,13 @@
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
 #include "PANDUVector3.h"
 #include "PANDUMathConstants.h"
 
 namespace Pandu
 {
-	class Vector4
+	class alignas(16) Vector4
 	{
 	public:
 
@@ -23,11 +24,9 @@ namespace Pandu
 
 	public:
 
-		inline Vector4()
-		{
-		}
+		Vector4() = default;
 
-		inline Vector4(float _x, float _y, float _z, float _w)
+		constexpr Vector4(float _x, float _y, float _z, float _w)
 			: x(_x)
 			, y(_y)
 			, z(_z)
@@ -35,15 +34,7 @@ namespace Pandu
 		{
 		}
 
-		inline Vector4(const Vector4& _src)
-			: x(_src.x)
-			, y(_src.y)
-			, z(_src.z)
-			, w(_src.w)
-		{
-		}
-
-		inline explicit Vector4(const Vector3& _src)
+		constexpr explicit Vector4(const Vector3& _src)
 			: x(_src.x)
 			, y(_src.y)
 			, z(_src.z)
@@ -54,15 +45,6 @@ namespace Pandu
 		float* Data() { return &x; }
 		const float* Data() const { return &x; }
 
-		inline Vector4& operator = ( const Vector4& _right )
-		{
-			x = _right.x;
-			y = _right.y;
-			z = _right.z;
-			w = _right.w;
-			return *this;
-		}
-
 		inline const Vector4& operator + () const
 		{
 			return *this;
@@ -227,6 +209,21 @@ namespace Pandu
 		static const Vector4 ZERO;
 		static const Vector4 UNIT;
 	};
+
+	inline constexpr Vector4 Vector4::UNIT_X(1.0f, 0.0f, 0.0f, 0.0f);
+	inline constexpr Vector4 Vector4::UNIT_Y(0.0f, 1.0f, 0.0f, 0.0f);
+	inline constexpr Vector4 Vector4::UNIT_Z(0.0f, 0.0f, 1.0f, 0.0f);
+	inline constexpr Vector4 Vector4::UNIT_W(0.0f, 0.0f, 0.0f, 1.0f);
+	inline constexpr Vector4 Vector4::NEGATIVE_UNIT_X(-1.0f, 0.0f, 0.0f, 0.0f);
+	inline constexpr Vector4 Vector4::NEGATIVE_UNIT_Y(0.0f, -1.0f, 0.0f, 0.0f);
+	inline constexpr Vector4 Vector4::NEGATIVE_UNIT_Z(0.0f, 0.0f, -1.0f, 0.0f);
+	inline constexpr Vector4 Vector4::NEGATIVE_UNIT_W(0.0f, 0.0f, 0.0f, -1.0f);
+	inline constexpr Vector4 Vector4::ZERO(0.0f, 0.0f, 0.0f, 0.0f);
+	inline constexpr Vector4 Vector4::UNIT(1.0f, 1.0f, 1.0f, 1.0f);
+
+	// One vec4 of a GPU buffer, on the same 16 byte boundary
+	static_assert(std::is_trivially_copyable<Vector4>::value, "Vector4 is copied with memcpy");
+	static_assert(sizeof(Vector4) == sizeof(float) * 4 && alignof(Vector4) == 16, "Vector4 is 4 packed floats on a 16 byte boundary");
 }
 
 #endif //__PANDUVector4_h__
\ No newline at end of file
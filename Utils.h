@@ -1,7 +1,9 @@
 #ifndef __Utils_h__
 #define __Utils_h__
 
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <PANDUMatrix44.h>
 
 class Utils
@@ -80,11 +82,11 @@ public:
 		return ProjectionMatrix;
 	}
 
+	// Pandu::Matrix44 rows go up as they are. WGSL reads them as the columns of a column major matrix, the transpose,
+	// so the shaders multiply row vectors from the left, v * M, which is the same math as M * v here.
 	static void GetWebGPUMatrix(std::array<float, 16>& OutWebGPUMatrix, const Pandu::Matrix44& Matrix)
 	{
-		const Pandu::Matrix44 Transpose = Matrix.GetTranspose();
-
-		std::copy(&Transpose.m[0][0], (&Transpose.m[0][0]) + 16, OutWebGPUMatrix.begin());
+		std::memcpy(OutWebGPUMatrix.data(), Matrix.arr, sizeof(float) * 16);
 	}
 
 };
@@ -66,6 +66,7 @@ THE SOFTWARE.
 
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tinyobj {
@@ -636,6 +637,15 @@ namespace tinyobj {
         MaterialReader* readMatFn = NULL, bool triangulate = true,
         bool default_vcols_fallback = true);
 
+    /// Loads object from text that is already in memory (e.g. a memory mapped
+    /// file). Same as the std::istream version, but lines are read straight
+    /// out of `objText`, which must stay alive until this returns.
+    bool LoadObjFromMemory(attrib_t* attrib, std::vector<shape_t>* shapes,
+        std::vector<material_t>* materials, std::string* warn,
+        std::string* err, std::string_view objText,
+        MaterialReader* readMatFn = NULL, bool triangulate = true,
+        bool default_vcols_fallback = true);
+
     /// Loads materials into std::map
     void LoadMtl(std::map<std::string, int>* material_map,
         std::vector<material_t>* materials, std::istream* inStream,
@@ -910,6 +920,7 @@ namespace tinyobj {
     //  - s >= s_end.
     //  - parse failure.
     //
+#ifndef TINYOBJLOADER_USE_FAST_PARSE
     static bool tryParseDouble(const char* s, const char* s_end, double* result) {
         if (s >= s_end) {
             return false;
@@ -1049,26 +1060,418 @@ namespace tinyobj {
     fail:
         return false;
     }
+#endif
+
+#ifdef TINYOBJLOADER_USE_FAST_PARSE
+    // Locale free, correctly rounded number parsing (TINYOBJLOADER_USE_FAST_PARSE).
+    // tryParseReal accepts exactly the strings tryParseDouble accepts but rounds
+    // straight to real_t. Up to 19 significant digits with a decimal exponent
+    // within +-22 take Clinger's fast path, a single exact double operation.
+    // Anything else, and the rare double to float conversion that double
+    // rounding could get wrong, is settled with exact big integer comparisons.
+    namespace fastparse {
+
+        static const double kPow10[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        // Significant digits used by the exact comparison. Halfway points
+        // between doubles have fewer, so the dropped digits only need a sticky
+        // bit.
+        static const int kMaxExactDigits = 800;
+
+        // Unsigned arbitrary precision integer, little endian 32 bit limbs.
+        class big_uint {
+        public:
+            explicit big_uint(uint64_t value) {
+                while (value) {
+                    limbs_.push_back(static_cast<uint32_t>(value));
+                    value >>= 32;
+                }
+            }
+
+            void mul_add(uint32_t mul, uint32_t add) {
+                uint64_t carry = add;
+                for (size_t i = 0; i < limbs_.size(); i++) {
+                    const uint64_t v = static_cast<uint64_t>(limbs_[i]) * mul + carry;
+                    limbs_[i] = static_cast<uint32_t>(v);
+                    carry = v >> 32;
+                }
+                if (carry) limbs_.push_back(static_cast<uint32_t>(carry));
+            }
+
+            void mul_pow10(int n) {
+                for (; n >= 9; n -= 9) mul_add(1000000000u, 0);
+                if (n > 0) mul_add(static_cast<uint32_t>(kPow10[n]), 0);
+            }
+
+            void shift_left(int bits) {
+                if (limbs_.empty() || bits <= 0) return;
+                const int rest = bits % 32;
+                if (rest) {
+                    uint32_t carry = 0;
+                    for (size_t i = 0; i < limbs_.size(); i++) {
+                        const uint32_t v = limbs_[i];
+                        limbs_[i] = (v << rest) | carry;
+                        carry = v >> (32 - rest);
+                    }
+                    if (carry) limbs_.push_back(carry);
+                }
+                limbs_.insert(limbs_.begin(), static_cast<size_t>(bits / 32), 0u);
+            }
+
+            // -1, 0 or 1 as this is less than, equal to or greater than other
+            int compare(const big_uint& other) const {
+                if (limbs_.size() != other.limbs_.size())
+                    return limbs_.size() < other.limbs_.size() ? -1 : 1;
+                for (size_t i = limbs_.size(); i-- > 0;) {
+                    if (limbs_[i] != other.limbs_[i])
+                        return limbs_[i] < other.limbs_[i] ? -1 : 1;
+                }
+                return 0;
+            }
+
+        private:
+            std::vector<uint32_t> limbs_;
+        };
+
+        // Mantissa text of a parsed number, value = digits * 10^exponent with
+        // the '.' skipped.
+        struct decimal_t {
+            const char* begin;
+            const char* end;
+            int exponent;
+        };
+
+        // First 19 significant digits of a longer mantissa, value ~=
+        // mantissa * 10^exp10, truncated tells whether a nonzero digit was cut.
+        static void leading_digits(const decimal_t& dec, uint64_t* mantissa, int* exp10, bool* truncated) {
+            uint64_t m = 0;
+            int kept = 0;
+            int e = 0;
+            bool fraction = false;
+            bool cut = false;
+            for (const char* p = dec.begin; p != dec.end; p++) {
+                if (*p == '.') {
+                    fraction = true;
+                    continue;
+                }
+                const int d = *p - '0';
+                if (kept < 19) {
+                    if (kept > 0 || d != 0) {
+                        m = m * 10 + static_cast<uint64_t>(d);
+                        kept++;
+                    }
+                    if (fraction) e--;
+                }
+                else {
+                    if (!fraction) e++;
+                    cut = cut || d != 0;
+                }
+            }
+            (*mantissa) = m;
+            (*exp10) = e;
+            (*truncated) = cut;
+        }
+
+        // Compares the decimal with num * 2^exp2.
+        static int compare_decimal(const decimal_t& dec, uint64_t num, int exp2) {
+            big_uint a(0);
+            int digits = 0;
+            int exponent = dec.exponent;
+            bool sticky = false;
+            for (const char* p = dec.begin; p != dec.end; p++) {
+                if (*p == '.') continue;
+                const uint32_t d = static_cast<uint32_t>(*p - '0');
+                if (digits < kMaxExactDigits) {
+                    a.mul_add(10, d);
+                    if (digits > 0 || d != 0) digits++;
+                }
+                else {
+                    exponent++;
+                    sticky = sticky || d != 0;
+                }
+            }
+            if (sticky) {
+                // Strictly between the kept digits and the next value up
+                a.mul_add(10, 1);
+                exponent--;
+            }
+
+            big_uint b(num);
+            if (exponent >= 0) a.mul_pow10(exponent);
+            else b.mul_pow10(-exponent);
+            if (exp2 >= 0) b.shift_left(exp2);
+            else a.shift_left(-exp2);
+            return a.compare(b);
+        }
+
+        // Splits a non negative finite value into mantissa * 2^exp2, with the
+        // exponent of its ulp (denormals included).
+        template <typename T>
+        static void decompose(T value, uint64_t* mantissa, int* exp2) {
+            const int digits = std::numeric_limits<T>::digits;
+            const int min_exp2 = std::numeric_limits<T>::min_exponent - digits;
+            int e = min_exp2;
+            if (value != T(0)) {
+                std::frexp(value, &e);
+                e = (e - digits > min_exp2) ? e - digits : min_exp2;
+            }
+            (*mantissa) = static_cast<uint64_t>(std::ldexp(value, -e));
+            (*exp2) = e;
+        }
+
+        // Moves the candidate, which has to be within a few ulps, to the value
+        // nearest to the decimal, ties to even.
+        template <typename T>
+        static T round_exact(const decimal_t& dec, T candidate) {
+            const T inf = std::numeric_limits<T>::infinity();
+            const int digits = std::numeric_limits<T>::digits;
+            const int min_exp2 = std::numeric_limits<T>::min_exponent - digits;
+            if (candidate == inf) candidate = (std::numeric_limits<T>::max)();
+
+            uint64_t m;
+            int e;
+            while (candidate != T(0)) {
+                // Halfway to the next value down, which has half the ulp when
+                // the candidate starts a binade
+                decompose(candidate, &m, &e);
+                const bool binade_start = m == (uint64_t(1) << (digits - 1)) && e > min_exp2;
+                const int cmp = binade_start ? compare_decimal(dec, 4 * m - 1, e - 2)
+                    : compare_decimal(dec, 2 * m - 1, e - 1);
+                if (cmp > 0 || (cmp == 0 && (m & 1) == 0)) break;
+                candidate = std::nextafter(candidate, T(0));
+            }
+
+            while (candidate != inf) {
+                decompose(candidate, &m, &e);
+                const int cmp = compare_decimal(dec, 2 * m + 1, e - 1);
+                if (cmp < 0 || (cmp == 0 && (m & 1) == 0)) break;
+                candidate = std::nextafter(candidate, inf);
+            }
+            return candidate;
+        }
+
+        // A correctly rounded double only converts to the correctly rounded
+        // float when it did not land exactly halfway between two floats, that
+        // is on a double whose 29 bits below the float mantissa read 100...0.
+        // Only called for doubles in the normal float range.
+        static inline bool is_rounded(double value, float) {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return (bits & 0x1FFFFFFFull) != 0x10000000ull;
+        }
+
+        static inline bool is_rounded(double, double) { return true; }
+
+        static const float kPow10f[] = {
+            1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+        static inline float exact_op(uint64_t m, int64_t q, float) {
+            return q < 0 ? static_cast<float>(m) / kPow10f[-q] : static_cast<float>(m) * kPow10f[q];
+        }
+        static inline double exact_op(uint64_t m, int64_t q, double) {
+            return q < 0 ? static_cast<double>(m) / kPow10[-q] : static_cast<double>(m) * kPow10[q];
+        }
+
+    }  // namespace fastparse
+
+    static bool tryParseReal(const char* s, const char* s_end, real_t* result) {
+        if (s >= s_end) {
+            return false;
+        }
+
+        const char* curr = s;
+        bool negative = false;
+        bool leading_decimal_dots = false;
+
+        if (*curr == '+' || *curr == '-') {
+            negative = (*curr == '-');
+            curr++;
+            if ((curr != s_end) && (*curr == '.')) {
+                leading_decimal_dots = true;
+            }
+        }
+        else if (IS_DIGIT(*curr)) {
+        }
+        else if (*curr == '.') {
+            leading_decimal_dots = true;
+        }
+        else {
+            return false;
+        }
+
+        // Accumulated without branches on the digit values, numbers with more
+        // than 19 digits are rescanned below.
+        fastparse::decimal_t dec;
+        dec.begin = curr;
+        uint64_t mantissa = 0;
+
+        if (!leading_decimal_dots) {
+            const char* int_begin = curr;
+            for (; curr != s_end && IS_DIGIT(*curr); curr++) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*curr - '0');
+            }
+            if (curr == int_begin) return false;
+        }
+
+        int frac_digits = 0;
+        bool has_dot = false;
+        if (curr != s_end && *curr == '.') {
+            has_dot = true;
+            curr++;
+            const char* frac_begin = curr;
+            for (; curr != s_end && IS_DIGIT(*curr); curr++) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*curr - '0');
+            }
+            frac_digits = static_cast<int>(curr - frac_begin);
+        }
+        dec.end = curr;
+        const int digit_count = static_cast<int>(dec.end - dec.begin) - (has_dot ? 1 : 0);
+
+        int64_t exponent = 0;
+        if (curr != s_end && (*curr == 'e' || *curr == 'E')) {
+            curr++;
+            bool exp_negative = false;
+            if (curr != s_end && (*curr == '+' || *curr == '-')) {
+                exp_negative = (*curr == '-');
+                curr++;
+            }
+            else if (curr == s_end || !IS_DIGIT(*curr)) {
+                // Empty E is not allowed.
+                return false;
+            }
+
+            const char* exp_begin = curr;
+            for (; curr != s_end && IS_DIGIT(*curr); curr++) {
+                if (exponent > (2147483647 / 10)) {
+                    // Integer overflow
+                    return false;
+                }
+                exponent = exponent * 10 + (*curr - '0');
+            }
+            if (curr == exp_begin) return false;
+            if (exp_negative) exponent = -exponent;
+        }
+
+        // value ~= mantissa * 10^q, exact unless truncated
+        int64_t q = exponent - frac_digits;
+        bool truncated = false;
+        if (digit_count > 19) {
+            int exp10 = 0;
+            fastparse::leading_digits(dec, &mantissa, &exp10, &truncated);
+            q = exponent + exp10;
+        }
+
+        real_t value = real_t(0);
+        if (mantissa != 0) {
+            dec.exponent = static_cast<int>(exponent - frac_digits);
+
+            if (!truncated && mantissa <= (uint64_t(1) << 24) && q >= -10 && q <= 10) {
+                value = fastparse::exact_op(mantissa, q, value);
+            }
+            else if (!truncated && mantissa <= (uint64_t(1) << 53) && q >= -22 && q <= 22) {
+                const double d = fastparse::exact_op(mantissa, q, 0.0);
+                value = static_cast<real_t>(d);
+                if (!fastparse::is_rounded(d, value)) {
+                    value = fastparse::round_exact(dec, value);
+                }
+            }
+            else {
+                int kept = 0;
+                for (uint64_t m = mantissa; m != 0; m /= 10) kept++;
+
+                if (q + kept - 1 > std::numeric_limits<real_t>::max_exponent10) {
+                    value = std::numeric_limits<real_t>::infinity();
+                }
+                else if (q + kept < std::numeric_limits<real_t>::min_exponent10 - std::numeric_limits<real_t>::max_digits10 - 1) {
+                    value = real_t(0);
+                }
+                else {
+                    // Two factors keep the estimate out of the double denormal range
+                    const double half = static_cast<double>(q / 2);
+                    const double estimate = static_cast<double>(mantissa) * std::pow(10.0, half) * std::pow(10.0, static_cast<double>(q) - half);
+                    value = fastparse::round_exact(dec, static_cast<real_t>(estimate));
+                }
+            }
+        }
+
+        (*result) = negative ? -value : value;
+        return true;
+    }
+#endif
+
+    // atoi for the face indices, locale free with TINYOBJLOADER_USE_FAST_PARSE
+    static inline int parseIndexValue(const char* s) {
+#ifdef TINYOBJLOADER_USE_FAST_PARSE
+        while (*s == ' ' || (*s >= '\t' && *s <= '\r')) s++;
+        bool negative = false;
+        if (*s == '+' || *s == '-') {
+            negative = (*s == '-');
+            s++;
+        }
+        unsigned int value = 0;
+        for (; IS_DIGIT(*s); s++) {
+            value = value * 10u + static_cast<unsigned int>(*s - '0');
+        }
+        return static_cast<int>(negative ? 0u - value : value);
+#else
+        return atoi(s);
+#endif
+    }
+
+    // strspn(s, " \t") and strcspn(s, reject) without the library calls,
+    // which build a lookup table every time
+#ifdef TINYOBJLOADER_USE_FAST_PARSE
+    static inline size_t skipBlanks(const char* s) {
+        const char* p = s;
+        while (*p == ' ' || *p == '\t') p++;
+        return static_cast<size_t>(p - s);
+    }
+
+    // Length up to the next ' ', '\t', '\r', NUL or, with slash set, '/'
+    static inline size_t fieldLength(const char* s, bool slash) {
+        const char* p = s;
+        while (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\0' && !(slash && *p == '/')) p++;
+        return static_cast<size_t>(p - s);
+    }
+#else
+    static inline size_t skipBlanks(const char* s) { return strspn(s, " \t"); }
+
+    static inline size_t fieldLength(const char* s, bool slash) {
+        return strcspn(s, slash ? "/ \t\r" : " \t\r");
+    }
+#endif
 
     static inline real_t parseReal(const char** token, double default_value = 0.0) {
-        (*token) += strspn((*token), " \t");
-        const char* end = (*token) + strcspn((*token), " \t\r");
+        (*token) += skipBlanks((*token));
+        const char* end = (*token) + fieldLength((*token), false);
+#ifdef TINYOBJLOADER_USE_FAST_PARSE
+        real_t f = static_cast<real_t>(default_value);
+        tryParseReal((*token), end, &f);
+#else
         double val = default_value;
         tryParseDouble((*token), end, &val);
         real_t f = static_cast<real_t>(val);
+#endif
         (*token) = end;
         return f;
     }
 
     static inline bool parseReal(const char** token, real_t* out) {
-        (*token) += strspn((*token), " \t");
-        const char* end = (*token) + strcspn((*token), " \t\r");
+        (*token) += skipBlanks((*token));
+        const char* end = (*token) + fieldLength((*token), false);
+#ifdef TINYOBJLOADER_USE_FAST_PARSE
+        bool ret = tryParseReal((*token), end, out);
+#else
         double val;
         bool ret = tryParseDouble((*token), end, &val);
         if (ret) {
             real_t f = static_cast<real_t>(val);
             (*out) = f;
         }
+#endif
         (*token) = end;
         return ret;
     }
@@ -1223,11 +1626,11 @@ namespace tinyobj {
 
         vertex_index_t vi(-1);
 
-        if (!fixIndex(atoi((*token)), vsize, &vi.v_idx, false, context)) {
+        if (!fixIndex(parseIndexValue((*token)), vsize, &vi.v_idx, false, context)) {
             return false;
         }
 
-        (*token) += strcspn((*token), "/ \t\r");
+        (*token) += fieldLength((*token), true);
         if ((*token)[0] != '/') {
             (*ret) = vi;
             return true;
@@ -1237,20 +1640,20 @@ namespace tinyobj {
         // i//k
         if ((*token)[0] == '/') {
             (*token)++;
-            if (!fixIndex(atoi((*token)), vnsize, &vi.vn_idx, true, context)) {
+            if (!fixIndex(parseIndexValue((*token)), vnsize, &vi.vn_idx, true, context)) {
                 return false;
             }
-            (*token) += strcspn((*token), "/ \t\r");
+            (*token) += fieldLength((*token), true);
             (*ret) = vi;
             return true;
         }
 
         // i/j/k or i/j
-        if (!fixIndex(atoi((*token)), vtsize, &vi.vt_idx, true, context)) {
+        if (!fixIndex(parseIndexValue((*token)), vtsize, &vi.vt_idx, true, context)) {
             return false;
         }
 
-        (*token) += strcspn((*token), "/ \t\r");
+        (*token) += fieldLength((*token), true);
         if ((*token)[0] != '/') {
             (*ret) = vi;
             return true;
@@ -1258,10 +1661,10 @@ namespace tinyobj {
 
         // i/j/k
         (*token)++;  // skip '/'
-        if (!fixIndex(atoi((*token)), vnsize, &vi.vn_idx, true, context)) {
+        if (!fixIndex(parseIndexValue((*token)), vnsize, &vi.vn_idx, true, context)) {
             return false;
         }
-        (*token) += strcspn((*token), "/ \t\r");
+        (*token) += fieldLength((*token), true);
 
         (*ret) = vi;
 
@@ -1272,8 +1675,8 @@ namespace tinyobj {
     static vertex_index_t parseRawTriple(const char** token) {
         vertex_index_t vi(static_cast<int>(0));  // 0 is an invalid index in OBJ
 
-        vi.v_idx = atoi((*token));
-        (*token) += strcspn((*token), "/ \t\r");
+        vi.v_idx = parseIndexValue((*token));
+        (*token) += fieldLength((*token), true);
         if ((*token)[0] != '/') {
             return vi;
         }
@@ -1282,22 +1685,22 @@ namespace tinyobj {
         // i//k
         if ((*token)[0] == '/') {
             (*token)++;
-            vi.vn_idx = atoi((*token));
-            (*token) += strcspn((*token), "/ \t\r");
+            vi.vn_idx = parseIndexValue((*token));
+            (*token) += fieldLength((*token), true);
             return vi;
         }
 
         // i/j/k or i/j
-        vi.vt_idx = atoi((*token));
-        (*token) += strcspn((*token), "/ \t\r");
+        vi.vt_idx = parseIndexValue((*token));
+        (*token) += fieldLength((*token), true);
         if ((*token)[0] != '/') {
             return vi;
         }
 
         // i/j/k
         (*token)++;  // skip '/'
-        vi.vn_idx = atoi((*token));
-        (*token) += strcspn((*token), "/ \t\r");
+        vi.vn_idx = parseIndexValue((*token));
+        (*token) += fieldLength((*token), true);
         return vi;
     }
 
@@ -2643,10 +3046,58 @@ namespace tinyobj {
             triangulate, default_vcols_fallback);
     }
 
-    bool LoadObj(attrib_t* attrib, std::vector<shape_t>* shapes,
+    // Line sources for LoadObjLines. ReadLine returns false once the input is
+    // exhausted and otherwise fills `linebuf` with the next line, without its
+    // '\n', '\r' or "\r\n" terminator.
+    class StreamLineReader {
+    public:
+        explicit StreamLineReader(std::istream& is) : is_(is) {}
+
+        bool ReadLine(std::string& linebuf) {
+            if (is_.peek() == -1) return false;
+            safeGetline(is_, linebuf);
+            return true;
+        }
+
+    private:
+        std::istream& is_;
+    };
+
+    // Walks a buffer that stays alive for the whole parse (e.g. a memory mapped
+    // file). Only the current line is copied, into the reused `linebuf`.
+    class MemoryLineReader {
+    public:
+        explicit MemoryLineReader(std::string_view text) : text_(text), pos_(0) {}
+
+        bool ReadLine(std::string& linebuf) {
+            if (pos_ >= text_.size()) return false;
+
+            const char* data = text_.data();
+            const size_t size = text_.size();
+            size_t end = pos_;
+            while (end < size && data[end] != '\n' && data[end] != '\r') end++;
+
+            linebuf.assign(data + pos_, end - pos_);
+
+            if (end < size) {
+                // "\r\n" ends a single line, same as safeGetline
+                if (data[end] == '\r' && end + 1 < size && data[end + 1] == '\n') end++;
+                end++;
+            }
+            pos_ = end;
+            return true;
+        }
+
+    private:
+        std::string_view text_;
+        size_t pos_;
+    };
+
+    template <typename LineReader>
+    static bool LoadObjLines(attrib_t* attrib, std::vector<shape_t>* shapes,
         std::vector<material_t>* materials, std::string* warn,
-        std::string* err, std::istream* inStream,
-        MaterialReader* readMatFn /*= NULL*/, bool triangulate,
+        std::string* err, LineReader& lineReader,
+        MaterialReader* readMatFn, bool triangulate,
         bool default_vcols_fallback) {
         std::stringstream errss;
 
@@ -2679,9 +3130,7 @@ namespace tinyobj {
 
         size_t line_num = 0;
         std::string linebuf;
-        while (inStream->peek() != -1) {
-            safeGetline(*inStream, linebuf);
-
+        while (lineReader.ReadLine(linebuf)) {
             line_num++;
 
             // Trim newline '\r\n' or '\n'
@@ -3224,6 +3673,26 @@ namespace tinyobj {
         return true;
     }
 
+    bool LoadObj(attrib_t* attrib, std::vector<shape_t>* shapes,
+        std::vector<material_t>* materials, std::string* warn,
+        std::string* err, std::istream* inStream,
+        MaterialReader* readMatFn /*= NULL*/, bool triangulate,
+        bool default_vcols_fallback) {
+        StreamLineReader lineReader(*inStream);
+        return LoadObjLines(attrib, shapes, materials, warn, err, lineReader,
+            readMatFn, triangulate, default_vcols_fallback);
+    }
+
+    bool LoadObjFromMemory(attrib_t* attrib, std::vector<shape_t>* shapes,
+        std::vector<material_t>* materials, std::string* warn,
+        std::string* err, std::string_view objText,
+        MaterialReader* readMatFn /*= NULL*/, bool triangulate,
+        bool default_vcols_fallback) {
+        MemoryLineReader lineReader(objText);
+        return LoadObjLines(attrib, shapes, materials, warn, err, lineReader,
+            readMatFn, triangulate, default_vcols_fallback);
+    }
+
     bool LoadObjWithCallback(std::istream& inStream, const callback_t& callback,
         void* user_data /*= NULL*/,
         MaterialReader* readMatFn /*= NULL*/,